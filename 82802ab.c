@@ -26,6 +26,7 @@
  *  - Order number: 290658-004
  */
 
+#include <string.h>
 #include "flash.h"
 #include "chipdrivers.h"
 
@@ -40,11 +41,36 @@ void print_status_82802ab(uint8_t status)
 	msg_cdbg("%s", status & 0x2 ? "WP|TBL#|WP#,ABORT:" : "UNLOCK:");
 }
 
+/* Key for the probe cache, see probe_jedec_common(). */
+struct probe_82802ab_key {
+	chipaddr bios;
+	unsigned int size;
+	int shifted;
+};
+
 int probe_82802ab(struct flashctx *flash)
 {
 	chipaddr bios = flash->virtual_memory;
+	struct probe_82802ab_key key;
+	uint8_t ids[4];
 	uint8_t id1, id2, flashcontent1, flashcontent2;
 	int shifted = (flash->chip->feature_bits & FEATURE_ADDR_SHIFTED) != 0;
+	int ret;
+
+	memset(&key, 0, sizeof(key));
+	key.bios = bios;
+	key.size = flash->chip->total_size;
+	key.shifted = shifted;
+	if (probe_cache_lookup("82802ab", &key, sizeof(key), ids, sizeof(ids), &ret)) {
+		id1 = ids[0];
+		id2 = ids[1];
+		flashcontent1 = ids[2];
+		flashcontent2 = ids[3];
+		/* Leave the ID mode other probes may have entered since. */
+		chip_writeb(flash, 0xFF, bios);
+		programmer_delay(10);
+		goto compare;
+	}
 
 	/* Reset to get a clean state */
 	chip_writeb(flash, 0xFF, bios);
@@ -62,11 +88,6 @@ int probe_82802ab(struct flashctx *flash)
 
 	programmer_delay(10);
 
-	msg_cdbg("%s: id1 0x%02x, id2 0x%02x", __func__, id1, id2);
-
-	if (!oddparity(id1))
-		msg_cdbg(", id1 parity violation");
-
 	/*
 	 * Read the product ID location again. We should now see normal
 	 * flash contents.
@@ -74,6 +95,18 @@ int probe_82802ab(struct flashctx *flash)
 	flashcontent1 = chip_readb(flash, bios + (0x00 << shifted));
 	flashcontent2 = chip_readb(flash, bios + (0x01 << shifted));
 
+	ids[0] = id1;
+	ids[1] = id2;
+	ids[2] = flashcontent1;
+	ids[3] = flashcontent2;
+	probe_cache_store("82802ab", &key, sizeof(key), ids, sizeof(ids), 0);
+
+compare:
+	msg_cdbg("%s: id1 0x%02x, id2 0x%02x", __func__, id1, id2);
+
+	if (!oddparity(id1))
+		msg_cdbg(", id1 parity violation");
+
 	if (id1 == flashcontent1)
 		msg_cdbg(", id1 is normal flash content");
 	if (id2 == flashcontent2)
@@ -107,6 +140,15 @@ uint8_t wait_82802ab(struct flashctx *flash)
 	return status;
 }
 
+/* Returns nonzero if the status register reports that the last block erase
+ * failed, or that VPP was too low for it. The error bits stay set until the
+ * next clear status command.
+ */
+int erase_failed_82802ab(struct flashctx *flash)
+{
+	return wait_82802ab(flash) & 0x28;
+}
+
 int unlock_82802ab(struct flashctx *flash)
 {
 	int i;
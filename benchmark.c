@@ -0,0 +1,307 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Throughput benchmark for read, erase and write.
+ *
+ * Every pass runs over the same address range and reports its throughput
+ * together with the bus traffic counted in struct bus_stats. Erase and write
+ * passes destroy the contents of the range, which are saved first and written
+ * back at the end.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash.h"
+#include "programmer.h"
+
+#define BENCH_DEFAULT_CHUNKS	"256,4096,65536"
+#define BENCH_MAX_CHUNKS	16
+
+struct bench_pass {
+	uint64_t start_us;
+	struct bus_stats stats;
+};
+
+static void bench_start(struct bench_pass *pass)
+{
+	pass->stats = bus_stats;
+	pass->start_us = timestamp_usecs();
+}
+
+static void bench_report(const struct bench_pass *pass, const char *name,
+			 unsigned int chunk, unsigned int len)
+{
+	uint64_t us = timestamp_usecs() - pass->start_us;
+
+	if (!us)
+		us = 1;
+	/* Bytes per microsecond are MB/s. */
+	msg_ginfo("%-8s %8u %10u %10lu %10.3f %10llu %10llu %12llu %10llu\n", name, chunk,
+		  len / 1024, (unsigned long)(us / 1000), (double)len / us,
+		  bus_stats.commands - pass->stats.commands,
+		  bus_stats.calls - pass->stats.calls,
+		  bus_stats.bytes - pass->stats.bytes,
+		  (bus_stats.delay_us - pass->stats.delay_us) / 1000);
+}
+
+static int parse_chunks(const char *list, unsigned int *chunks)
+{
+	const char *p = list;
+	char *end;
+	int n = 0;
+
+	while (*p) {
+		if (n == BENCH_MAX_CHUNKS) {
+			msg_gerr("Too many benchmark chunk sizes.\n");
+			return -1;
+		}
+		chunks[n] = strtoul(p, &end, 0);
+		if (end == p || !chunks[n] || (*end && *end != ',')) {
+			msg_gerr("Invalid benchmark chunk size list \"%s\".\n", list);
+			return -1;
+		}
+		n++;
+		p = *end ? end + 1 : end;
+	}
+	return n;
+}
+
+static int parse_range(const char *range, unsigned int size, unsigned int *start,
+		       unsigned int *end)
+{
+	char *p;
+
+	*start = 0;
+	*end = size - 1;
+	if (!range)
+		return 0;
+	*start = strtoul(range, &p, 0);
+	if (*p != ':')
+		goto fail;
+	*end = strtoul(p + 1, &p, 0);
+	if (*p || *start > *end || *end >= size)
+		goto fail;
+	return 0;
+fail:
+	msg_gerr("Invalid benchmark range \"%s\", expected <start>:<end> inside the chip.\n",
+		 range);
+	return 1;
+}
+
+/* Returns the usable erase function with the most blocks or -1. */
+static int bench_finest_eraser(const struct flashctx *flash)
+{
+	unsigned int count, best_count = 0;
+	int i, k, best = -1;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS; k++) {
+		if (check_block_eraser(flash, k, 0))
+			continue;
+		count = 0;
+		for (i = 0; i < NUM_ERASEREGIONS; i++)
+			count += flash->chip->block_erasers[k].eraseblocks[i].count;
+		if (count > best_count) {
+			best_count = count;
+			best = k;
+		}
+	}
+	return best;
+}
+
+/* Erase the blocks of erase function @k inside [start, start + len - 1].
+ * Returns the number of erased bytes or -1 on failure. @blocksize is set to
+ * the size of the first erased block.
+ */
+static int bench_erase(struct flashctx *flash, int k, unsigned int start,
+		       unsigned int len, unsigned int *blocksize)
+{
+	const struct block_eraser *eraser = &flash->chip->block_erasers[k];
+	unsigned int addr = 0, blocklen, done = 0;
+	int i, j;
+
+	*blocksize = 0;
+	for (i = 0; i < NUM_ERASEREGIONS; i++) {
+		blocklen = eraser->eraseblocks[i].size;
+		for (j = 0; j < eraser->eraseblocks[i].count; j++, addr += blocklen) {
+			if (addr < start || addr + blocklen > start + len)
+				continue;
+			if (!*blocksize)
+				*blocksize = blocklen;
+			if (eraser->block_erase(flash, addr, blocklen))
+				return -1;
+			done += blocklen;
+		}
+	}
+	return done;
+}
+
+/* Align [start, end] to the blocks of erase function @k. */
+static void bench_align(const struct flashctx *flash, int k, unsigned int *start,
+			unsigned int *end)
+{
+	const struct block_eraser *eraser = &flash->chip->block_erasers[k];
+	unsigned int addr = 0, blocklen;
+	int i, j;
+
+	for (i = 0; i < NUM_ERASEREGIONS; i++) {
+		blocklen = eraser->eraseblocks[i].size;
+		for (j = 0; j < eraser->eraseblocks[i].count; j++, addr += blocklen) {
+			if (*start >= addr && *start < addr + blocklen)
+				*start = addr;
+			if (*end >= addr && *end < addr + blocklen)
+				*end = addr + blocklen - 1;
+		}
+	}
+}
+
+static int bench_rw(struct flashctx *flash, uint8_t *buf, unsigned int start,
+		    unsigned int len, unsigned int chunk, int write)
+{
+	unsigned int off, n;
+	int ret;
+
+	for (off = 0; off < len; off += n) {
+		n = min(chunk, len - off);
+		if (write)
+			ret = flash->chip->write(flash, buf + off, start + off, n);
+		else
+			ret = flash->chip->read(flash, buf + off, start + off, n);
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+int benchmark_flash(struct flashctx *flash, int force, const char *chunklist,
+		    const char *range)
+{
+	unsigned int size = flash->chip->total_size * 1024;
+	unsigned int chunks[BENCH_MAX_CHUNKS];
+	unsigned int start, end, len, blocksize;
+	uint8_t *backup = NULL, *buf = NULL;
+	struct bench_pass pass;
+	uint32_t seed = 0x12345678;
+	unsigned int n;
+	int nchunks, i, k, kf, done, destructive = 1, ret = 0;
+
+	nchunks = parse_chunks(chunklist ? chunklist : BENCH_DEFAULT_CHUNKS, chunks);
+	if (nchunks < 0 || parse_range(range, size, &start, &end))
+		return 1;
+
+	kf = bench_finest_eraser(flash);
+	if (kf < 0 || !flash->chip->write || !programmer_may_write) {
+		msg_ginfo("Can't erase or write this chip, running read passes only.\n");
+		destructive = 0;
+	}
+	if (chip_safety_check(flash, force, 1, destructive, destructive, 0)) {
+		msg_cerr("Aborting.\n");
+		return 1;
+	}
+	if (prepare_flash_access(flash)) {
+		finish_flash_access(flash);
+		return 1;
+	}
+	/* Erase passes need whole blocks. */
+	if (destructive)
+		bench_align(flash, kf, &start, &end);
+	len = end - start + 1;
+
+	backup = malloc(len);
+	buf = malloc(len);
+	if (!backup || !buf) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	msg_ginfo("Benchmarking 0x%06x-0x%06x (%u kB) of %s %s.\n", start, end,
+		  len / 1024, flash->chip->vendor, flash->chip->name);
+	if (flash->chip->read(flash, backup, start, len)) {
+		msg_gerr("Read operation failed!\n");
+		ret = 1;
+		goto out;
+	}
+
+	msg_ginfo("%-8s %8s %10s %10s %10s %10s %10s %12s %10s\n", "pass", "chunk", "kB",
+		  "ms", "MB/s", "commands", "calls", "bus bytes", "delay ms");
+	for (i = 0; i < nchunks; i++) {
+		bench_start(&pass);
+		if (bench_rw(flash, buf, start, len, chunks[i], 0)) {
+			msg_gerr("Read operation failed!\n");
+			ret = 1;
+			goto out;
+		}
+		bench_report(&pass, "read", chunks[i], len);
+	}
+	if (!destructive)
+		goto out;
+
+	/* From here on, the original contents have to be restored. */
+	for (k = 0; k < NUM_ERASEFUNCTIONS; k++) {
+		if (check_block_eraser(flash, k, 0))
+			continue;
+		bench_start(&pass);
+		done = bench_erase(flash, k, start, len, &blocksize);
+		if (done < 0) {
+			msg_gerr("Erase function %i failed!\n", k);
+			ret = 1;
+			goto restore;
+		}
+		/* Blocks larger than the range, e.g. chip erase, are skipped. */
+		if (done)
+			bench_report(&pass, "erase", blocksize, done);
+	}
+
+	/* Pseudo-random data avoids shortcuts for erased bytes. */
+	for (n = 0; n < len; n++) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		buf[n] = seed;
+	}
+	for (i = 0; i < nchunks; i++) {
+		if (bench_erase(flash, kf, start, len, &blocksize) < 0) {
+			msg_gerr("Erase function %i failed!\n", kf);
+			ret = 1;
+			goto restore;
+		}
+		bench_start(&pass);
+		if (bench_rw(flash, buf, start, len, chunks[i], 1)) {
+			msg_gerr("Write operation failed!\n");
+			ret = 1;
+			goto restore;
+		}
+		bench_report(&pass, "write", chunks[i], len);
+	}
+
+restore:
+	msg_ginfo("Restoring original contents... ");
+	if (bench_erase(flash, kf, start, len, &blocksize) < 0 ||
+	    flash->chip->write(flash, backup, start, len) ||
+	    verify_range(flash, backup, start, len)) {
+		msg_ginfo("FAILED.\n");
+		emergency_help_message();
+		ret = 1;
+	} else {
+		msg_ginfo("done.\n");
+	}
+out:
+	finish_flash_access(flash);
+	free(backup);
+	free(buf);
+	return ret;
+}
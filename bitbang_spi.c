@@ -67,6 +67,7 @@ static const struct spi_programmer spi_programmer_bitbang = {
 	.type		= SPI_CONTROLLER_BITBANG,
 	.max_data_read	= MAX_DATA_READ_UNLIMITED,
 	.max_data_write	= MAX_DATA_WRITE_UNLIMITED,
+	.io_modes	= SPI_IO_4BA,
 	.command	= bitbang_spi_send_command,
 	.multicommand	= default_spi_send_multicommand,
 	.read		= default_spi_read,
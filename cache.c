@@ -0,0 +1,450 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Opt-in on-disk cache of flash chip contents.
+ *
+ * The cache holds the last known image of a chip together with a hash of
+ * every block, keyed by the programmer (including its parameters) and the chip.
+ * Before the cached image is used instead of reading the chip, a sample of
+ * blocks is read back and compared with the stored hashes. The same spot check
+ * is applied to an old image supplied by the user.
+ *
+ * The IDs of the chip found on a programmer are kept as well, the next run
+ * probes for them before walking the whole chip table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash.h"
+#include "programmer.h"
+
+#define CACHE_MAGIC		"FRCACHE1"
+#define CACHE_BLOCKSIZE		4096
+/* Blocks checked against the chip: a fixed number plus a fraction of all. */
+#define CACHE_SPOTCHECKS	8
+#define CACHE_SPOTCHECK_RATIO	64
+
+static char *cache_dir = NULL;
+static char *old_image = NULL;
+
+int cache_set_dir(const char *dir)
+{
+	free(cache_dir);
+	cache_dir = strdup(dir);
+	if (!cache_dir) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+	return 0;
+}
+
+/* Returns 1 if chip contents are cached. */
+int cache_active(void)
+{
+	return cache_dir != NULL;
+}
+
+int cache_set_old_image(const char *filename)
+{
+	free(old_image);
+	old_image = strdup(filename);
+	if (!old_image) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+	return 0;
+}
+
+/* 64 bit FNV-1a, good enough to notice changed blocks and corrupt files. */
+uint64_t cache_hash(const uint8_t *buf, unsigned int len)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	unsigned int i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= buf[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/* Returns a malloc'ed path for the cache file of @kind and @key or NULL if
+ * caching is disabled. The key itself is stored in the file and compared on
+ * load, its hash only has to spread the files.
+ */
+char *cache_file_name(const char *kind, const char *key)
+{
+	uint64_t hash;
+	char *name;
+	size_t len;
+
+	if (!cache_dir)
+		return NULL;
+	len = strlen(cache_dir) + strlen(kind) + 16 + 3;
+	name = malloc(len);
+	if (!name) {
+		msg_gerr("Out of memory!\n");
+		return NULL;
+	}
+	hash = cache_hash((const uint8_t *)key, strlen(key));
+	snprintf(name, len, "%s/%s-%08lx%08lx", cache_dir, kind,
+		 (unsigned long)(hash >> 32), (unsigned long)(hash & 0xffffffff));
+	return name;
+}
+
+static char *image_cache_key(struct flashctx *flash)
+{
+	const char *pgm = programmer_id();
+	char *key;
+	size_t len;
+
+	len = strlen(pgm) + strlen(flash->chip->vendor) + strlen(flash->chip->name) + 32;
+	key = malloc(len);
+	if (!key) {
+		msg_gerr("Out of memory!\n");
+		return NULL;
+	}
+	snprintf(key, len, "%s|%s|%s|%u", pgm, flash->chip->vendor, flash->chip->name,
+		 flash->chip->total_size);
+	return key;
+}
+
+static void put_le32(uint8_t *buf, uint32_t val)
+{
+	buf[0] = val & 0xff;
+	buf[1] = (val >> 8) & 0xff;
+	buf[2] = (val >> 16) & 0xff;
+	buf[3] = (val >> 24) & 0xff;
+}
+
+static uint32_t get_le32(const uint8_t *buf)
+{
+	return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static void put_le64(uint8_t *buf, uint64_t val)
+{
+	put_le32(buf, val & 0xffffffff);
+	put_le32(buf + 4, val >> 32);
+}
+
+static uint64_t get_le64(const uint8_t *buf)
+{
+	return get_le32(buf) | ((uint64_t)get_le32(buf + 4) << 32);
+}
+
+static unsigned int cache_blocks(unsigned int size)
+{
+	return (size + CACHE_BLOCKSIZE - 1) / CACHE_BLOCKSIZE;
+}
+
+/* Hash block @i of @image, the last block may be short. */
+static uint64_t block_hash(const uint8_t *image, unsigned int size, unsigned int i)
+{
+	unsigned int start = i * CACHE_BLOCKSIZE;
+
+	return cache_hash(image + start, min(CACHE_BLOCKSIZE, size - start));
+}
+
+/* Read a sample of blocks from the chip, always including the first and the
+ * last one, and compare them with @hashes. Returns 0 if all of them match.
+ */
+static int spot_check(struct flashctx *flash, const uint64_t *hashes, unsigned int size)
+{
+	unsigned int nblocks = cache_blocks(size);
+	unsigned int count = min(nblocks, CACHE_SPOTCHECKS + nblocks / CACHE_SPOTCHECK_RATIO);
+	uint32_t seed = (uint32_t)timestamp_usecs() | 1;
+	unsigned int i, n, start, len;
+	uint8_t *buf;
+	int ret = 0;
+
+	buf = malloc(CACHE_BLOCKSIZE);
+	if (!buf) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+	for (n = 0; n < count && !ret; n++) {
+		if (n == 0) {
+			i = 0;
+		} else if (n == 1) {
+			i = nblocks - 1;
+		} else {
+			/* xorshift32 */
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			i = seed % nblocks;
+		}
+		start = i * CACHE_BLOCKSIZE;
+		len = min(CACHE_BLOCKSIZE, size - start);
+		if (flash->chip->read(flash, buf, start, len)) {
+			ret = 1;
+			break;
+		}
+		if (cache_hash(buf, len) != hashes[i]) {
+			msg_cdbg("Block 0x%06x-0x%06x differs. ", start, start + len - 1);
+			ret = 1;
+		}
+	}
+	if (!ret)
+		msg_cdbg("%u of %u blocks match. ", count, nblocks);
+	free(buf);
+	return ret;
+}
+
+static uint64_t *hash_image(const uint8_t *image, unsigned int size)
+{
+	unsigned int i, nblocks = cache_blocks(size);
+	uint64_t *hashes = malloc(nblocks * sizeof(uint64_t));
+
+	if (!hashes) {
+		msg_gerr("Out of memory!\n");
+		return NULL;
+	}
+	for (i = 0; i < nblocks; i++)
+		hashes[i] = block_hash(image, size, i);
+	return hashes;
+}
+
+/* Load the cache file @name for @key into @buf. Returns 0 on success. */
+static int load_cache_file(const char *name, const char *key, uint8_t *buf,
+			   uint64_t *hashes, unsigned int size)
+{
+	unsigned int i, nblocks = cache_blocks(size);
+	uint8_t header[20];
+	uint8_t entry[8];
+	char *filekey = NULL;
+	uint32_t keylen;
+	FILE *f;
+	int ret = 1;
+
+	f = fopen(name, "rb");
+	if (!f)
+		return 1;
+	if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+	    memcmp(header, CACHE_MAGIC, 8) || get_le32(header + 8) != size ||
+	    get_le32(header + 12) != CACHE_BLOCKSIZE)
+		goto out;
+	keylen = get_le32(header + 16);
+	if (keylen != strlen(key))
+		goto out;
+	filekey = malloc(keylen);
+	if (!filekey || fread(filekey, 1, keylen, f) != keylen || memcmp(filekey, key, keylen))
+		goto out;
+	for (i = 0; i < nblocks; i++) {
+		if (fread(entry, 1, sizeof(entry), f) != sizeof(entry))
+			goto out;
+		hashes[i] = get_le64(entry);
+	}
+	if (fread(buf, 1, size, f) != size)
+		goto out;
+	/* Catch corrupted or truncated files. */
+	for (i = 0; i < nblocks; i++) {
+		if (block_hash(buf, size, i) != hashes[i])
+			goto out;
+	}
+	ret = 0;
+out:
+	free(filekey);
+	fclose(f);
+	return ret;
+}
+
+/* Fill @buf with the contents of the chip from an explicitly given old image or
+ * from the cache, if either passes the spot check. Returns 0 if @buf can be
+ * trusted, 1 if the chip has to be read.
+ */
+int cache_load_image(struct flashctx *flash, uint8_t *buf)
+{
+	unsigned int size = flash->chip->total_size * 1024;
+	uint64_t *hashes = NULL;
+	char *key = NULL, *name = NULL;
+	int ret = 1;
+
+	if (old_image) {
+		msg_cinfo("Checking old image %s against the flash chip... ", old_image);
+		if (read_buf_from_file(buf, size, old_image))
+			return 1;
+		hashes = hash_image(buf, size);
+		if (!hashes)
+			return 1;
+		ret = spot_check(flash, hashes, size);
+		msg_cinfo("%s.\n", ret ? "mismatch, ignoring it" : "OK");
+		free(hashes);
+		return ret;
+	}
+
+	if (!cache_dir)
+		return 1;
+	key = image_cache_key(flash);
+	if (!key)
+		return 1;
+	name = cache_file_name("image", key);
+	hashes = malloc(cache_blocks(size) * sizeof(uint64_t));
+	if (!name || !hashes) {
+		msg_gerr("Out of memory!\n");
+		goto out;
+	}
+	if (load_cache_file(name, key, buf, hashes, size)) {
+		msg_cdbg("No usable cached image in %s.\n", name);
+		goto out;
+	}
+	msg_cinfo("Checking cached image against the flash chip... ");
+	ret = spot_check(flash, hashes, size);
+	msg_cinfo("%s.\n", ret ? "stale, ignoring it" : "OK");
+out:
+	free(hashes);
+	free(name);
+	free(key);
+	return ret;
+}
+
+/* Remember @buf as the current contents of the chip. */
+void cache_store_image(struct flashctx *flash, const uint8_t *buf)
+{
+	unsigned int i, size = flash->chip->total_size * 1024;
+	unsigned int nblocks = cache_blocks(size);
+	char *key, *name = NULL, *tmpname = NULL;
+	uint8_t header[20];
+	uint8_t entry[8];
+	FILE *f;
+	int ok;
+
+	if (!cache_dir)
+		return;
+	key = image_cache_key(flash);
+	if (!key)
+		return;
+	name = cache_file_name("image", key);
+	if (!name)
+		goto out;
+	tmpname = malloc(strlen(name) + 5);
+	if (!tmpname) {
+		msg_gerr("Out of memory!\n");
+		goto out;
+	}
+	sprintf(tmpname, "%s.tmp", name);
+	f = fopen(tmpname, "wb");
+	if (!f) {
+		msg_gdbg("Can't create cache file %s.\n", tmpname);
+		goto out;
+	}
+	memcpy(header, CACHE_MAGIC, 8);
+	put_le32(header + 8, size);
+	put_le32(header + 12, CACHE_BLOCKSIZE);
+	put_le32(header + 16, strlen(key));
+	ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+	ok = ok && fwrite(key, 1, strlen(key), f) == strlen(key);
+	for (i = 0; ok && i < nblocks; i++) {
+		put_le64(entry, block_hash(buf, size, i));
+		ok = fwrite(entry, 1, sizeof(entry), f) == sizeof(entry);
+	}
+	ok = ok && fwrite(buf, 1, size, f) == size;
+	ok = !fclose(f) && ok;
+	/* Replace the old file only with a complete new one. */
+	if (!ok || rename(tmpname, name)) {
+		msg_gdbg("Can't write cache file %s.\n", name);
+		remove(tmpname);
+		goto out;
+	}
+	msg_gdbg("Cached flash chip contents in %s.\n", name);
+out:
+	free(tmpname);
+	free(name);
+	free(key);
+}
+
+/* Forget the cached contents, e.g. after a failed write. */
+void cache_drop_image(struct flashctx *flash)
+{
+	char *key, *name;
+
+	if (!cache_dir)
+		return;
+	key = image_cache_key(flash);
+	if (!key)
+		return;
+	name = cache_file_name("image", key);
+	if (name)
+		remove(name);
+	free(name);
+	free(key);
+}
+
+/* The last chip file holds the key and the programmer index and IDs of the
+ * chip, as text.
+ */
+int cache_load_last_chip(int *pgm_index, uint32_t *manufacture_id, uint32_t *model_id)
+{
+	const char *key = programmer_id();
+	char *name, *line = NULL;
+	unsigned int manuf, model;
+	size_t len = strlen(key) + 2;
+	FILE *f;
+	int ret = 1;
+
+	name = cache_file_name("lastchip", key);
+	if (!name)
+		return 1;
+	f = fopen(name, "r");
+	free(name);
+	if (!f)
+		return 1;
+	line = malloc(len);
+	if (!line) {
+		msg_gerr("Out of memory!\n");
+		goto out;
+	}
+	if (!fgets(line, len, f) || strlen(line) != len - 1 || strncmp(line, key, len - 2) ||
+	    line[len - 2] != '\n')
+		goto out;
+	if (fscanf(f, "%i %x %x", pgm_index, &manuf, &model) != 3)
+		goto out;
+	*manufacture_id = manuf;
+	*model_id = model;
+	ret = 0;
+out:
+	free(line);
+	fclose(f);
+	return ret;
+}
+
+/* Remember @chip as the only chip found on registered programmer @pgm_index. */
+void cache_store_last_chip(int pgm_index, const struct flashchip *chip)
+{
+	const char *key = programmer_id();
+	char *name;
+	FILE *f;
+
+	name = cache_file_name("lastchip", key);
+	if (!name)
+		return;
+	f = fopen(name, "w");
+	if (!f) {
+		msg_gdbg("Can't write cache file %s.\n", name);
+		free(name);
+		return;
+	}
+	fprintf(f, "%s\n%i %08x %08x\n", key, pgm_index, chip->manufacture_id, chip->model_id);
+	if (fclose(f)) {
+		msg_gdbg("Can't write cache file %s.\n", name);
+		remove(name);
+	}
+	free(name);
+}
@@ -36,11 +36,20 @@ int spi_chip_read(struct flashctx *flash, uint8_t *buf, unsigned int start, int
 int probe_spi_rdid(struct flashctx *flash);
 int probe_spi_rdid4(struct flashctx *flash);
 int probe_spi_rems(struct flashctx *flash);
+int probe_spi_rdid_ids(struct flashctx *flash, uint32_t *id1, uint32_t *id2);
+int probe_spi_rdid4_ids(struct flashctx *flash, uint32_t *id1, uint32_t *id2);
+int probe_spi_rems_ids(struct flashctx *flash, uint32_t *id1, uint32_t *id2);
 int probe_spi_res1(struct flashctx *flash);
 int probe_spi_res2(struct flashctx *flash);
 int probe_spi_at25f(struct flashctx *flash);
 int spi_write_enable(struct flashctx *flash);
 int spi_write_disable(struct flashctx *flash);
+void spi_poll_wip(struct flashctx *flash, uint8_t opcode, unsigned int len);
+void spi_poll_batched(struct flashctx *flash, uint8_t opcode, unsigned int len, unsigned int us,
+		      int gave_up);
+unsigned int spi_poll_expected(struct flashctx *flash, uint8_t opcode, unsigned int len);
+unsigned int spi_poll_timeout(struct flashctx *flash, uint8_t opcode, unsigned int len);
+void spi_poll_print_stats(void);
 int spi_block_erase_20(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
 int spi_block_erase_50(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
 int spi_block_erase_52(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
@@ -50,13 +59,21 @@ int spi_block_erase_d8(struct flashctx *flash, unsigned int addr, unsigned int b
 int spi_block_erase_60(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
 int spi_block_erase_62(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
 int spi_block_erase_c7(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
+int spi_block_erase_21(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
+int spi_block_erase_5c(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
+int spi_block_erase_dc(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
 erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode);
+uint64_t spi_erase_cost(const struct flashctx *flash, erasefunc_t *block_erase, unsigned int len);
+uint64_t spi_write_cost(const struct flashctx *flash, const uint8_t *have, const uint8_t *want,
+			unsigned int start, unsigned int len);
 int spi_chip_write_1(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 int spi_byte_program(struct flashctx *flash, unsigned int addr, uint8_t databyte);
 int spi_nbyte_program(struct flashctx *flash, unsigned int addr, uint8_t *bytes, unsigned int len);
 int spi_nbyte_read(struct flashctx *flash, unsigned int addr, uint8_t *bytes, unsigned int len);
 int spi_read_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len, unsigned int chunksize);
 int spi_write_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len, unsigned int chunksize);
+int spi_prepare_4ba(struct flashctx *flash);
+int spi_finish_4ba(struct flashctx *flash);
 
 /* spi25_statusreg.c */
 uint8_t spi_read_status_register(struct flashctx *flash);
@@ -92,6 +109,7 @@ int spi_prettyprint_status_register_sst25vf040b(struct flashctx *flash);
 
 /* sfdp.c */
 int probe_spi_sfdp(struct flashctx *flash);
+unsigned int sfdp_typical_us(const struct sfdp_params *p, uint8_t opcode, unsigned int len);
 
 /* opaque.c */
 int probe_opaque(struct flashctx *flash);
@@ -101,6 +119,7 @@ int erase_opaque(struct flashctx *flash, unsigned int blockaddr, unsigned int bl
 
 /* 82802ab.c */
 uint8_t wait_82802ab(struct flashctx *flash);
+int erase_failed_82802ab(struct flashctx *flash);
 int probe_82802ab(struct flashctx *flash);
 int erase_block_82802ab(struct flashctx *flash, unsigned int page, unsigned int pagesize);
 int write_82802ab(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
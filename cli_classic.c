@@ -31,6 +31,19 @@
 #include "flashchips.h"
 #include "programmer.h"
 
+/* Values for long options which don't have a short option. */
+enum {
+	OPTION_ERASE_VERIFY = 0x0100,
+	OPTION_VERIFY_ALL,
+	OPTION_CACHE_DIR,
+	OPTION_OLD_IMAGE,
+	OPTION_LOW_MEMORY,
+	OPTION_BENCHMARK,
+	OPTION_BENCHMARK_CHUNKS,
+	OPTION_BENCHMARK_RANGE,
+	OPTION_SERVE,
+};
+
 static void cli_classic_usage(const char *name)
 {
 	printf("Please note that the command line interface for flashrom has changed between\n"
@@ -42,12 +55,19 @@ static void cli_classic_usage(const char *name)
 #endif
 	       "-p <programmername>[:<parameters>] [-c <chipname>]\n"
 	       "[-E|(-r|-w|-v) <file>] [-l <layoutfile> [-i <imagename>]...] [-n] [-f]]\n"
-	       "[-V[V[V]]] [-o <logfile>]\n\n", name);
+	       "[-V[V[V]]] [-o <logfile>] [--erase-verify <policy>]\n"
+	       "[--verify-all] [--cache-dir <dir>] [--old-image <file>] [--low-memory]\n"
+	       "[--benchmark [--benchmark-chunks <sizes>] [--benchmark-range <start>:<end>]]\n"
+#if CONFIG_SERPROG == 1
+	       "[--serve serprog:port=<port>[,ip=<addr>]|serprog:pty]\n"
+#endif
+	       "\n",
+	       name);
 
 	printf(" -h | --help                        print this help text\n"
 	       " -R | --version                     print version (release)\n"
-	       " -r | --read <file>                 read flash and save to <file>\n"
-	       " -w | --write <file>                write <file> to flash\n"
+	       " -r | --read <file>                 read flash and save to <file> (- is stdout)\n"
+	       " -w | --write <file>                write <file> (- is stdin) to flash\n"
 	       " -v | --verify <file>               verify flash against <file>\n"
 	       " -E | --erase                       erase flash memory\n"
 	       " -V | --verbose                     more verbose output\n"
@@ -57,6 +77,21 @@ static void cli_classic_usage(const char *name)
 	       " -l | --layout <layoutfile>         read ROM layout from <layoutfile>\n"
 	       " -i | --image <name>                only flash image <name> from flash layout\n"
 	       " -o | --output <logfile>            log output to <logfile>\n"
+	       "      --erase-verify <policy>       check erased blocks: full, deferred or status\n"
+	       "      --verify-all                  verify all of the chip after writing, not\n"
+	       "                                    only the changed blocks\n"
+	       "      --cache-dir <dir>             cache chip contents in <dir> to skip reading\n"
+	       "                                    the chip on the next write\n"
+	       "      --old-image <file>            assume the chip contains <file> if a sample\n"
+	       "                                    of blocks matches\n"
+	       "      --low-memory                  write and verify one erase block at a time\n"
+	       "      --benchmark                   measure read, erase and write throughput\n"
+	       "      --benchmark-chunks <sizes>    comma separated read/write sizes to measure\n"
+	       "      --benchmark-range <start>:<end> address range to use for the benchmark\n"
+#if CONFIG_SERPROG == 1
+	       "      --serve serprog:port=<port>   make the programmer available to flashrom\n"
+	       "                                    -p serprog on another host (or serprog:pty)\n"
+#endif
 	       " -L | --list-supported              print supported devices\n"
 #if CONFIG_PRINT_WIKI == 1
 	       " -z | --list-supported-wiki         print supported devices in wiki syntax\n"
@@ -67,7 +102,11 @@ static void cli_classic_usage(const char *name)
 #if CONFIG_PRINT_WIKI == 1
 	         "-z, "
 #endif
-	         "-E, -r, -w, -v or no operation.\n"
+	         "-E, -r, -w, -v, --benchmark, "
+#if CONFIG_SERPROG == 1
+	         "--serve "
+#endif
+	         "or no operation.\n"
 	       "If no operation is specified, flashrom will only probe for flash chips.\n");
 }
 
@@ -84,7 +123,7 @@ static int check_filename(char *filename, char *type)
 		return 1;
 	}
 	/* Not an error, but maybe the user intended to specify a CLI option instead of a file name. */
-	if (filename[0] == '-')
+	if (filename[0] == '-' && strcmp(filename, "-"))
 		fprintf(stderr, "Warning: Supplied %s file name starts with -\n", type);
 	return 0;
 }
@@ -99,10 +138,12 @@ int main(int argc, char *argv[])
 	const char *name;
 	int namelen, opt, i, j;
 	int startchip = -1, chipcount = 0, option_index = 0, force = 0;
+	int last_chip_found = 0;
+	uint32_t manufacture_id, model_id;
 #if CONFIG_PRINT_WIKI == 1
 	int list_supported_wiki = 0;
 #endif
-	int read_it = 0, write_it = 0, erase_it = 0, verify_it = 0;
+	int read_it = 0, write_it = 0, erase_it = 0, verify_it = 0, benchmark_it = 0;
 	int dont_verify_it = 0, list_supported = 0, operation_specified = 0;
 	enum programmer prog = PROGRAMMER_INVALID;
 	int ret = 0;
@@ -125,6 +166,15 @@ int main(int argc, char *argv[])
 		{"help",		0, NULL, 'h'},
 		{"version",		0, NULL, 'R'},
 		{"output",		1, NULL, 'o'},
+		{"erase-verify",	1, NULL, OPTION_ERASE_VERIFY},
+		{"verify-all",		0, NULL, OPTION_VERIFY_ALL},
+		{"cache-dir",		1, NULL, OPTION_CACHE_DIR},
+		{"old-image",		1, NULL, OPTION_OLD_IMAGE},
+		{"low-memory",		0, NULL, OPTION_LOW_MEMORY},
+		{"benchmark",		0, NULL, OPTION_BENCHMARK},
+		{"benchmark-chunks",	1, NULL, OPTION_BENCHMARK_CHUNKS},
+		{"benchmark-range",	1, NULL, OPTION_BENCHMARK_RANGE},
+		{"serve",		1, NULL, OPTION_SERVE},
 		{NULL,			0, NULL, 0},
 	};
 
@@ -135,9 +185,9 @@ int main(int argc, char *argv[])
 #endif /* !STANDALONE */
 	char *tempstr = NULL;
 	char *pparam = NULL;
-
-	print_version();
-	print_banner();
+	char *bench_chunks = NULL;
+	char *bench_range = NULL;
+	char *serve_spec = NULL;
 
 	if (selfcheck())
 		exit(1);
@@ -291,12 +341,13 @@ int main(int argc, char *argv[])
 			}
 			break;
 		case 'R':
-			/* print_version() is always called during startup. */
 			if (++operation_specified > 1) {
 				fprintf(stderr, "More than one operation "
 					"specified. Aborting.\n");
 				cli_classic_abort_usage();
 			}
+			print_version();
+			print_banner();
 			exit(0);
 			break;
 		case 'h':
@@ -305,6 +356,8 @@ int main(int argc, char *argv[])
 					"specified. Aborting.\n");
 				cli_classic_abort_usage();
 			}
+			print_version();
+			print_banner();
 			cli_classic_usage(argv[0]);
 			exit(0);
 			break;
@@ -320,6 +373,63 @@ int main(int argc, char *argv[])
 			}
 #endif /* STANDALONE */
 			break;
+		case OPTION_VERIFY_ALL:
+			verify_all = 1;
+			break;
+		case OPTION_ERASE_VERIFY:
+			if (!strcmp(optarg, "full")) {
+				erase_verify_policy = ERASE_VERIFY_FULL;
+			} else if (!strcmp(optarg, "deferred")) {
+				erase_verify_policy = ERASE_VERIFY_DEFERRED;
+			} else if (!strcmp(optarg, "status")) {
+				erase_verify_policy = ERASE_VERIFY_STATUS;
+			} else {
+				fprintf(stderr, "Error: Unknown erase verification "
+					"policy \"%s\". Aborting.\n", optarg);
+				cli_classic_abort_usage();
+			}
+			break;
+		case OPTION_CACHE_DIR:
+			if (cache_set_dir(optarg))
+				exit(1);
+			break;
+		case OPTION_OLD_IMAGE:
+			if (cache_set_old_image(optarg))
+				exit(1);
+			break;
+		case OPTION_LOW_MEMORY:
+			low_memory = 1;
+			break;
+		case OPTION_BENCHMARK:
+			if (++operation_specified > 1) {
+				fprintf(stderr, "More than one operation "
+					"specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			benchmark_it = 1;
+			break;
+		case OPTION_BENCHMARK_CHUNKS:
+			free(bench_chunks);
+			bench_chunks = strdup(optarg);
+			break;
+		case OPTION_BENCHMARK_RANGE:
+			free(bench_range);
+			bench_range = strdup(optarg);
+			break;
+		case OPTION_SERVE:
+#if CONFIG_SERPROG == 1
+			if (++operation_specified > 1) {
+				fprintf(stderr, "More than one operation "
+					"specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			free(serve_spec);
+			serve_spec = strdup(optarg);
+#else
+			fprintf(stderr, "Error: serprog support was not compiled in.\n");
+			cli_classic_abort_usage();
+#endif
+			break;
 		default:
 			cli_classic_abort_usage();
 			break;
@@ -331,6 +441,14 @@ int main(int argc, char *argv[])
 		cli_classic_abort_usage();
 	}
 
+	/* Reading to stdout (-r -) needs a clean stdout. Nothing but usage
+	 * errors is printed before this point.
+	 */
+	if (read_it && filename && !strcmp(filename, "-"))
+		print_to_stderr();
+	print_version();
+	print_banner();
+
 	if ((read_it | write_it | verify_it) && check_filename(filename, "image")) {
 		cli_classic_abort_usage();
 	}
@@ -423,7 +541,27 @@ int main(int argc, char *argv[])
 	msg_pdbg("The following protocols are supported: %s.\n", tempstr);
 	free(tempstr);
 
-	for (j = 0; j < registered_programmer_count; j++) {
+#if CONFIG_SERPROG == 1
+	/* The client probes for the chip on its own. */
+	if (serve_spec) {
+		ret = serve_serprog(serve_spec);
+		goto out_shutdown;
+	}
+#endif
+
+	/* Try the chip found alone by the last run first. With more than one
+	 * registered programmer, e.g. SPI and LPC controllers, a second chip
+	 * could appear behind another one, so all of them are probed.
+	 */
+	if (!chip_to_probe && registered_programmer_count == 1 &&
+	    !cache_load_last_chip(&j, &manufacture_id, &model_id) && j == 0 &&
+	    probe_flash_by_id(&registered_programmers[j], manufacture_id, model_id, &flashes[0]) != -1) {
+		msg_cdbg("Skipped probing for other chips, the same chip was found last time.\n");
+		last_chip_found = 1;
+		chipcount = 1;
+	}
+
+	for (j = 0; j < registered_programmer_count && !last_chip_found; j++) {
 		startchip = 0;
 		while (chipcount < ARRAY_SIZE(flashes)) {
 			startchip = probe_flash(&registered_programmers[j], startchip, &flashes[chipcount], 0);
@@ -433,6 +571,8 @@ int main(int argc, char *argv[])
 			startchip++;
 		}
 	}
+	if (chipcount == 1 && !chip_to_probe && !last_chip_found && registered_programmer_count == 1)
+		cache_store_last_chip(flashes[0].pgm - registered_programmers, flashes[0].chip);
 
 	if (chipcount > 1) {
 		msg_cinfo("Multiple flash chips were detected: \"%s\"", flashes[0].chip->name);
@@ -480,7 +620,7 @@ int main(int argc, char *argv[])
 			}
 			msg_cinfo("Please note that forced reads most likely contain garbage.\n");
 			ret = read_flash_to_file(&flashes[0], filename);
-			free(flashes[0].chip);
+			free_chip_copy(flashes[0].chip);
 			goto out_shutdown;
 		}
 		ret = 1;
@@ -504,6 +644,11 @@ int main(int argc, char *argv[])
 		goto out_shutdown;
 	}
 
+	if (benchmark_it) {
+		ret = benchmark_flash(fill_flash, force, bench_chunks, bench_range);
+		goto out_shutdown;
+	}
+
 	if (!(read_it | write_it | verify_it | erase_it)) {
 		msg_ginfo("No operations were specified.\n");
 		goto out_shutdown;
@@ -526,11 +671,14 @@ out_shutdown:
 	programmer_shutdown();
 out:
 	for (i = 0; i < chipcount; i++)
-		free(flashes[i].chip);
+		free_chip_copy(flashes[i].chip);
 
 	free(filename);
 	free(layoutfile);
 	free(pparam);
+	free(bench_chunks);
+	free(bench_range);
+	free(serve_spec);
 	/* clean up global variables */
 	free((char *)chip_to_probe); /* Silence! Freeing is not modifying contents. */
 	chip_to_probe = NULL;
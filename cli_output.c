@@ -25,6 +25,14 @@
 #include <errno.h>
 #include "flash.h"
 
+/* Set if stdout carries data, e.g. an image read with -r -. */
+static int all_to_stderr = 0;
+
+void print_to_stderr(void)
+{
+	all_to_stderr = 1;
+}
+
 #ifndef STANDALONE
 static FILE *logfile = NULL;
 
@@ -74,7 +82,7 @@ int print(enum msglevel level, const char *fmt, ...)
 	int ret = 0;
 	FILE *output_type = stdout;
 
-	if (level == MSG_ERROR)
+	if (level == MSG_ERROR || all_to_stderr)
 		output_type = stderr;
 
 	if (level <= verbose_screen) {
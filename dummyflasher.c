@@ -47,6 +47,8 @@ enum emu_chip {
 	EMULATE_SST_SST25VF040_REMS,
 	EMULATE_SST_SST25VF032B,
 	EMULATE_MACRONIX_MX25L6436,
+	EMULATE_MACRONIX_MX25L25635F,
+	EMULATE_MACRONIX_MX66L51235F,
 };
 static enum emu_chip emu_chip = EMULATE_NONE;
 static char *emu_persistent_image = NULL;
@@ -59,6 +61,11 @@ static unsigned int emu_jedec_be_52_size = 0;
 static unsigned int emu_jedec_be_d8_size = 0;
 static unsigned int emu_jedec_ce_60_size = 0;
 static unsigned int emu_jedec_ce_c7_size = 0;
+/* FEATURE_* bits of the read opcodes beyond JEDEC_READ */
+static unsigned int emu_read_features = 0;
+/* FEATURE_4BA_* bits, chips above 16 MiB need at least one of them */
+static unsigned int emu_4ba_features = 0;
+static int emu_4ba_mode = 0;
 unsigned char spi_blacklist[256];
 unsigned char spi_ignorelist[256];
 int spi_blacklist_size = 0;
@@ -91,6 +98,34 @@ static const uint8_t const sfdp_table[] = {
 	0xFF, 0xFF, 0xFF, 0xFF, // @0x54: Macronix parameter table end
 };
 
+/* A JESD216B SFDP table for a 32 MiB chip, the one above with the address
+ * mode, density, timings and the 4-Byte address mode methods filled in.
+ */
+static const uint8_t sfdp_table_4ba[] = {
+	0x53, 0x46, 0x44, 0x50, // @0x00: SFDP signature
+	0x06, 0x01, 0x00, 0xFF, // @0x04: revision 1.6, 1 header
+	0x00, 0x06, 0x01, 0x10, // @0x08: JEDEC SFDP header rev. 1.6, 16 DW long
+	0x10, 0x00, 0x00, 0xFF, // @0x0C: PTP0 = 0x10
+	0xE5, 0x20, 0xCB, 0xFF, // @0x10: SFDP parameter table start, 3 or 4-Byte addresses
+	0xFF, 0xFF, 0xFF, 0x0F, // @0x14: 256 Mbit
+	0x00, 0xFF, 0x08, 0x6B, // @0x18
+	0x08, 0x3B, 0x00, 0xFF, // @0x1C
+	0xEE, 0xFF, 0xFF, 0xFF, // @0x20
+	0xFF, 0xFF, 0x00, 0x00, // @0x24
+	0xFF, 0xFF, 0x00, 0xFF, // @0x28
+	0x0C, 0x20, 0x0F, 0x52, // @0x2C
+	0x10, 0xD8, 0x00, 0xFF, // @0x30
+	0xD2, 0x41, 0xC9, 0x00, // @0x34: erase times
+	0x81, 0xEC, 0x04, 0x53, // @0x38: page size and program times
+	0xFF, 0xFF, 0xFF, 0xFF, // @0x3C
+	0xFF, 0xFF, 0xFF, 0xFF, // @0x40
+	0xFF, 0xFF, 0xFF, 0xFF, // @0x44
+	0x00, 0x00, 0x20, 0x00, // @0x48: QE is bit 6 of the status register
+	0x00, 0x40, 0x00, 0x01, // @0x4C: SFDP parameter table end, enter 0xB7, exit 0xE9
+};
+static const uint8_t *emu_sfdp_table = NULL;
+static unsigned int emu_sfdp_size = 0;
+
 #endif
 #endif
 
@@ -118,16 +153,26 @@ static uint32_t dummy_chip_readl(const struct flashctx *flash,
 				 const chipaddr addr);
 static void dummy_chip_readn(const struct flashctx *flash, uint8_t *buf,
 			     const chipaddr addr, size_t len);
+static int dummy_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds);
+static int dummy_spi_poll_status(struct flashctx *flash, uint8_t opcode,
+				 uint8_t mask, unsigned int timeout_us);
+static int dummy_chip_poll(const struct flashctx *flash,
+			   enum par_poll_type type, chipaddr addr,
+			   uint8_t mask, uint8_t value,
+			   unsigned int timeout_us);
 
 static const struct spi_programmer spi_programmer_dummyflasher = {
 	.type		= SPI_CONTROLLER_DUMMY,
 	.max_data_read	= MAX_DATA_READ_UNLIMITED,
 	.max_data_write	= MAX_DATA_UNSPECIFIED,
+	.io_modes	= SPI_IO_FAST_READ | SPI_IO_DUAL_OUT | SPI_IO_QUAD_OUT |
+			  SPI_IO_4BA | SPI_IO_POLL,
 	.command	= dummy_spi_send_command,
-	.multicommand	= default_spi_send_multicommand,
+	.multicommand	= dummy_spi_send_multicommand,
 	.read		= default_spi_read,
 	.write_256	= dummy_spi_write_256,
 	.write_aai	= default_spi_write_aai,
+	.poll_status	= dummy_spi_poll_status,
 };
 
 static const struct par_programmer par_programmer_dummy = {
@@ -139,6 +184,7 @@ static const struct par_programmer par_programmer_dummy = {
 		.chip_writew		= dummy_chip_writew,
 		.chip_writel		= dummy_chip_writel,
 		.chip_writen		= dummy_chip_writen,
+		.poll			= dummy_chip_poll,
 };
 
 enum chipbustype dummy_buses_supported = BUS_NONE;
@@ -328,6 +374,7 @@ int dummy_init(void)
 		emu_jedec_be_d8_size = 64 * 1024;
 		emu_jedec_ce_60_size = emu_chip_size;
 		emu_jedec_ce_c7_size = emu_chip_size;
+		emu_read_features = FEATURE_FAST_READ;
 		msg_pdbg("Emulating SST SST25VF032B SPI flash chip (RDID, AAI "
 			 "write)\n");
 	}
@@ -341,8 +388,46 @@ int dummy_init(void)
 		emu_jedec_be_d8_size = 64 * 1024;
 		emu_jedec_ce_60_size = emu_chip_size;
 		emu_jedec_ce_c7_size = emu_chip_size;
+		emu_read_features = FEATURE_FAST_READ | FEATURE_DUAL_OUT |
+				    FEATURE_QUAD_OUT;
+		emu_sfdp_table = sfdp_table;
+		emu_sfdp_size = sizeof(sfdp_table);
 		msg_pdbg("Emulating Macronix MX25L6436 SPI flash chip (RDID, "
-			 "SFDP)\n");
+			 "SFDP, dual/quad output read)\n");
+	}
+	if (!strcmp(tmp, "MX25L25635F")) {
+		emu_chip = EMULATE_MACRONIX_MX25L25635F;
+		emu_chip_size = 32 * 1024 * 1024;
+		emu_max_byteprogram_size = 256;
+		emu_max_aai_size = 0;
+		emu_jedec_se_size = 4 * 1024;
+		emu_jedec_be_52_size = 32 * 1024;
+		emu_jedec_be_d8_size = 64 * 1024;
+		emu_jedec_ce_60_size = emu_chip_size;
+		emu_jedec_ce_c7_size = emu_chip_size;
+		emu_read_features = FEATURE_FAST_READ | FEATURE_DUAL_OUT |
+				    FEATURE_QUAD_OUT;
+		emu_4ba_features = FEATURE_4BA_ENTER;
+		emu_sfdp_table = sfdp_table_4ba;
+		emu_sfdp_size = sizeof(sfdp_table_4ba);
+		msg_pdbg("Emulating Macronix MX25L25635F SPI flash chip (RDID, "
+			 "SFDP, 4-byte address mode)\n");
+	}
+	if (!strcmp(tmp, "MX66L51235F")) {
+		emu_chip = EMULATE_MACRONIX_MX66L51235F;
+		emu_chip_size = 64 * 1024 * 1024;
+		emu_max_byteprogram_size = 256;
+		emu_max_aai_size = 0;
+		emu_jedec_se_size = 4 * 1024;
+		emu_jedec_be_52_size = 32 * 1024;
+		emu_jedec_be_d8_size = 64 * 1024;
+		emu_jedec_ce_60_size = emu_chip_size;
+		emu_jedec_ce_c7_size = emu_chip_size;
+		emu_read_features = FEATURE_FAST_READ | FEATURE_DUAL_OUT |
+				    FEATURE_QUAD_OUT;
+		emu_4ba_features = FEATURE_4BA_NATIVE | FEATURE_4BA_ENTER;
+		msg_pdbg("Emulating Macronix MX66L51235F SPI flash chip (RDID, "
+			 "4-byte address opcodes and mode)\n");
 	}
 #endif
 	if (emu_chip == EMULATE_NONE) {
@@ -486,17 +571,97 @@ static void dummy_chip_readn(const struct flashctx *flash, uint8_t *buf,
 	return;
 }
 
+/* Polling is done here like a programmer with its own firmware would do it,
+ * without a round trip per read.
+ */
+static int dummy_chip_poll(const struct flashctx *flash,
+			   enum par_poll_type type, chipaddr addr,
+			   uint8_t mask, uint8_t value,
+			   unsigned int timeout_us)
+{
+	uint64_t start = timestamp_usecs();
+	uint8_t prev, cur;
+
+	msg_pspew("%s: type=%i addr=0x%lx mask=0x%02x value=0x%02x\n",
+		  __func__, type, addr, mask, value);
+	prev = dummy_chip_readb(flash, addr) & mask;
+	do {
+		cur = dummy_chip_readb(flash, addr) & mask;
+		if (type == POLL_TOGGLE && cur == prev)
+			return 0;
+		if (type == POLL_DATA && cur == (value & mask))
+			return 0;
+		prev = cur;
+	} while (timestamp_usecs() - start < timeout_us);
+	return 1;
+}
+
 #if EMULATE_SPI_CHIP
+/* The emu_read_features bit needed for @opcode. */
+static unsigned int emu_read_feature(uint8_t opcode)
+{
+	switch (opcode) {
+	case JEDEC_FAST_READ:
+		return FEATURE_FAST_READ;
+	case JEDEC_DUAL_OUT_READ:
+		return FEATURE_DUAL_OUT;
+	case JEDEC_QUAD_OUT_READ:
+		return FEATURE_QUAD_OUT;
+	default:
+		return 0;
+	}
+}
+
+/* The opcode with a 3-byte address which behaves like @opcode with a 4-byte
+ * address, 0 if @opcode has none.
+ */
+static uint8_t emu_opcode_3ba(uint8_t opcode)
+{
+	switch (opcode) {
+	case JEDEC_READ_4BA:
+		return JEDEC_READ;
+	case JEDEC_FAST_READ_4BA:
+		return JEDEC_FAST_READ;
+	case JEDEC_DUAL_OUT_READ_4BA:
+		return JEDEC_DUAL_OUT_READ;
+	case JEDEC_QUAD_OUT_READ_4BA:
+		return JEDEC_QUAD_OUT_READ;
+	case JEDEC_BYTE_PROGRAM_4BA:
+		return JEDEC_BYTE_PROGRAM;
+	case JEDEC_SE_4BA:
+		return JEDEC_SE;
+	case JEDEC_BE_5C_4BA:
+		return JEDEC_BE_52;
+	case JEDEC_BE_DC_4BA:
+		return JEDEC_BE_D8;
+	default:
+		return 0;
+	}
+}
+
+/* The @alen byte address following the opcode in @writearr. */
+static unsigned int emu_addr(const unsigned char *writearr, unsigned int alen)
+{
+	unsigned int addr = 0, i;
+
+	for (i = 1; i <= alen; i++)
+		addr = addr << 8 | writearr[i];
+	return addr;
+}
+
 static int emulate_spi_chip_response(unsigned int writecnt,
 				     unsigned int readcnt,
 				     const unsigned char *writearr,
 				     unsigned char *readarr)
 {
-	unsigned int offs, i, toread;
+	unsigned int offs, i, toread, alen;
 	static int unsigned aai_offs;
+	uint8_t opcode;
 	const unsigned char sst25vf040_rems_response[2] = {0xbf, 0x44};
 	const unsigned char sst25vf032b_rems_response[2] = {0xbf, 0x4a};
 	const unsigned char mx25l6436_rems_response[2] = {0xc2, 0x16};
+	const unsigned char mx25l25635f_rems_response[2] = {0xc2, 0x18};
+	const unsigned char mx66l51235f_rems_response[2] = {0xc2, 0x19};
 
 	if (writecnt == 0) {
 		msg_perr("No command sent to the chip!\n");
@@ -531,7 +696,17 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		}
 	}
 
-	switch (writearr[0]) {
+	/* Addresses have 4 bytes in 4-byte address mode and after the opcodes
+	 * made for them, which otherwise work like their 3-byte counterparts.
+	 */
+	opcode = writearr[0];
+	alen = emu_4ba_mode ? 4 : 3;
+	if ((emu_4ba_features & FEATURE_4BA_NATIVE) && emu_opcode_3ba(opcode)) {
+		opcode = emu_opcode_3ba(opcode);
+		alen = 4;
+	}
+
+	switch (opcode) {
 	case JEDEC_RES:
 		if (writecnt < JEDEC_RES_OUTSIZE)
 			break;
@@ -555,6 +730,14 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			if (readcnt > 0)
 				memset(readarr, 0x16, readcnt);
 			break;
+		case EMULATE_MACRONIX_MX25L25635F:
+			if (readcnt > 0)
+				memset(readarr, 0x18, readcnt);
+			break;
+		case EMULATE_MACRONIX_MX66L51235F:
+			if (readcnt > 0)
+				memset(readarr, 0x19, readcnt);
+			break;
 		default: /* ignore */
 			break;
 		}
@@ -578,6 +761,14 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			for (i = 0; i < readcnt; i++)
 				readarr[i] = mx25l6436_rems_response[(offs + i) % 2];
 			break;
+		case EMULATE_MACRONIX_MX25L25635F:
+			for (i = 0; i < readcnt; i++)
+				readarr[i] = mx25l25635f_rems_response[(offs + i) % 2];
+			break;
+		case EMULATE_MACRONIX_MX66L51235F:
+			for (i = 0; i < readcnt; i++)
+				readarr[i] = mx66l51235f_rems_response[(offs + i) % 2];
+			break;
 		default: /* ignore */
 			break;
 		}
@@ -600,6 +791,22 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			if (readcnt > 2)
 				readarr[2] = 0x17;
 			break;
+		case EMULATE_MACRONIX_MX25L25635F:
+			if (readcnt > 0)
+				readarr[0] = 0xc2;
+			if (readcnt > 1)
+				readarr[1] = 0x20;
+			if (readcnt > 2)
+				readarr[2] = 0x19;
+			break;
+		case EMULATE_MACRONIX_MX66L51235F:
+			if (readcnt > 0)
+				readarr[0] = 0xc2;
+			if (readcnt > 1)
+				readarr[1] = 0x20;
+			if (readcnt > 2)
+				readarr[2] = 0x1a;
+			break;
 		default: /* ignore */
 			break;
 		}
@@ -622,25 +829,44 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		msg_pdbg2("WRSR wrote 0x%02x.\n", emu_status);
 		break;
 	case JEDEC_READ:
-		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
+		offs = emu_addr(writearr, alen);
+		/* Truncate to emu_chip_size. */
+		offs %= emu_chip_size;
+		if (readcnt > 0)
+			memcpy(readarr, flashchip_contents + offs, readcnt);
+		break;
+	case JEDEC_FAST_READ:
+	case JEDEC_DUAL_OUT_READ:
+	case JEDEC_QUAD_OUT_READ:
+		/* The number of lines doesn't matter for the emulation. */
+		if (!(emu_read_features & emu_read_feature(opcode)))
+			break;
+		if (writecnt < 1 + alen + 1) {
+			msg_perr("FAST READ without dummy byte!\n");
+			return 1;
+		}
+		offs = emu_addr(writearr, alen);
+		/* Bytes written after the dummy byte shift the response. */
+		offs += writecnt - (1 + alen) - 1;
 		/* Truncate to emu_chip_size. */
 		offs %= emu_chip_size;
 		if (readcnt > 0)
 			memcpy(readarr, flashchip_contents + offs, readcnt);
 		break;
 	case JEDEC_BYTE_PROGRAM:
-		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
+		offs = emu_addr(writearr, alen);
 		/* Truncate to emu_chip_size. */
 		offs %= emu_chip_size;
-		if (writecnt < 5) {
+		if (writecnt < 1 + alen + 1) {
 			msg_perr("BYTE PROGRAM size too short!\n");
 			return 1;
 		}
-		if (writecnt - 4 > emu_max_byteprogram_size) {
+		if (writecnt - 1 - alen > emu_max_byteprogram_size) {
 			msg_perr("Max BYTE PROGRAM size exceeded!\n");
 			return 1;
 		}
-		memcpy(flashchip_contents + offs, writearr + 4, writecnt - 4);
+		memcpy(flashchip_contents + offs, writearr + 1 + alen,
+		       writecnt - 1 - alen);
 		break;
 	case JEDEC_AAI_WORD_PROGRAM:
 		if (!emu_max_aai_size)
@@ -685,7 +911,7 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 	case JEDEC_SE:
 		if (!emu_jedec_se_size)
 			break;
-		if (writecnt != JEDEC_SE_OUTSIZE) {
+		if (writecnt != JEDEC_SE_OUTSIZE - 3 + alen) {
 			msg_perr("SECTOR ERASE 0x20 outsize invalid!\n");
 			return 1;
 		}
@@ -693,7 +919,9 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			msg_perr("SECTOR ERASE 0x20 insize invalid!\n");
 			return 1;
 		}
-		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
+		offs = emu_addr(writearr, alen);
+		/* Truncate to emu_chip_size. */
+		offs %= emu_chip_size;
 		if (offs & (emu_jedec_se_size - 1))
 			msg_pdbg("Unaligned SECTOR ERASE 0x20: 0x%x\n", offs);
 		offs &= ~(emu_jedec_se_size - 1);
@@ -702,7 +930,7 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 	case JEDEC_BE_52:
 		if (!emu_jedec_be_52_size)
 			break;
-		if (writecnt != JEDEC_BE_52_OUTSIZE) {
+		if (writecnt != JEDEC_BE_52_OUTSIZE - 3 + alen) {
 			msg_perr("BLOCK ERASE 0x52 outsize invalid!\n");
 			return 1;
 		}
@@ -710,7 +938,9 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			msg_perr("BLOCK ERASE 0x52 insize invalid!\n");
 			return 1;
 		}
-		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
+		offs = emu_addr(writearr, alen);
+		/* Truncate to emu_chip_size. */
+		offs %= emu_chip_size;
 		if (offs & (emu_jedec_be_52_size - 1))
 			msg_pdbg("Unaligned BLOCK ERASE 0x52: 0x%x\n", offs);
 		offs &= ~(emu_jedec_be_52_size - 1);
@@ -719,7 +949,7 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 	case JEDEC_BE_D8:
 		if (!emu_jedec_be_d8_size)
 			break;
-		if (writecnt != JEDEC_BE_D8_OUTSIZE) {
+		if (writecnt != JEDEC_BE_D8_OUTSIZE - 3 + alen) {
 			msg_perr("BLOCK ERASE 0xd8 outsize invalid!\n");
 			return 1;
 		}
@@ -727,7 +957,9 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			msg_perr("BLOCK ERASE 0xd8 insize invalid!\n");
 			return 1;
 		}
-		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
+		offs = emu_addr(writearr, alen);
+		/* Truncate to emu_chip_size. */
+		offs %= emu_chip_size;
 		if (offs & (emu_jedec_be_d8_size - 1))
 			msg_pdbg("Unaligned BLOCK ERASE 0xd8: 0x%x\n", offs);
 		offs &= ~(emu_jedec_be_d8_size - 1);
@@ -763,8 +995,22 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		/* emu_jedec_ce_c7_size is emu_chip_size. */
 		memset(flashchip_contents, 0xff, emu_jedec_ce_c7_size);
 		break;
+	case JEDEC_ENTER_4BA:
+	case JEDEC_EXIT_4BA:
+		if (!(emu_4ba_features & (FEATURE_4BA_ENTER | FEATURE_4BA_ENTER_WREN)))
+			break;
+		if ((emu_4ba_features & FEATURE_4BA_ENTER_WREN) &&
+		    !(emu_status & SPI_SR_WEL)) {
+			msg_perr("4-byte address mode change attempted, but WEL "
+				 "is 0!\n");
+			break;
+		}
+		emu_4ba_mode = opcode == JEDEC_ENTER_4BA;
+		msg_pdbg2("%s 4-byte address mode.\n",
+			  emu_4ba_mode ? "Entered" : "Left");
+		break;
 	case JEDEC_SFDP:
-		if (emu_chip != EMULATE_MACRONIX_MX25L6436)
+		if (!emu_sfdp_table)
 			break;
 		if (writecnt < 4)
 			break;
@@ -786,13 +1032,13 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		/* The SFDP spec implies that the start address of an SFDP read may be truncated to fit in the
 		 * SFDP table address space, i.e. the start address may be wrapped around at SFDP table size.
 		 * This is a reasonable implementation choice in hardware because it saves a few gates. */
-		if (offs >= sizeof(sfdp_table)) {
+		if (offs >= emu_sfdp_size) {
 			msg_pdbg("Wrapping the start address around the SFDP table boundary (using 0x%x "
-				 "instead of 0x%x).\n", (unsigned int)(offs % sizeof(sfdp_table)), offs);
-			offs %= sizeof(sfdp_table);
+				 "instead of 0x%x).\n", (unsigned int)(offs % emu_sfdp_size), offs);
+			offs %= emu_sfdp_size;
 		}
-		toread = min(sizeof(sfdp_table) - offs, readcnt);
-		memcpy(readarr, sfdp_table + offs, toread);
+		toread = min(emu_sfdp_size - offs, readcnt);
+		memcpy(readarr, emu_sfdp_table + offs, toread);
 		if (toread < readcnt)
 			msg_pdbg("Crossing the SFDP table boundary in a single "
 				 "continuous chunk produces undefined results "
@@ -829,6 +1075,8 @@ static int dummy_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 	case EMULATE_SST_SST25VF040_REMS:
 	case EMULATE_SST_SST25VF032B:
 	case EMULATE_MACRONIX_MX25L6436:
+	case EMULATE_MACRONIX_MX25L25635F:
+	case EMULATE_MACRONIX_MX66L51235F:
 		if (emulate_spi_chip_response(writecnt, readcnt, writearr,
 					      readarr)) {
 			msg_pdbg("Invalid command sent to flash chip!\n");
@@ -846,6 +1094,52 @@ static int dummy_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 	return 0;
 }
 
+/* Read status register @opcode into @status until the bits in @mask are
+ * clear. Returns 0 when they are, 1 on timeout and -1 on error.
+ */
+static int dummy_poll(struct flashctx *flash, uint8_t opcode, uint8_t mask,
+		      unsigned int timeout_us, unsigned char *status)
+{
+	uint64_t start = timestamp_usecs();
+
+	msg_pspew("%s: opcode=0x%02x mask=0x%02x\n", __func__, opcode, mask);
+	do {
+		if (dummy_spi_send_command(flash, 1, 1, &opcode, status))
+			return -1;
+		if (!(*status & mask))
+			return 0;
+	} while (timestamp_usecs() - start < timeout_us);
+	return 1;
+}
+
+/* Runs a whole batch like a programmer with its own command buffer would,
+ * waits for the chip (SPI_IO_POLL) included.
+ */
+static int dummy_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds)
+{
+	int ret = 0;
+
+	for (; (cmds->writecnt || cmds->readcnt) && !ret; cmds++) {
+		if (cmds->io & SPI_IO_POLL) {
+			ret = dummy_poll(flash, cmds->writearr[0], cmds->poll_mask,
+					 cmds->poll_timeout_us, cmds->readarr);
+			if (ret > 0)
+				ret = SPI_POLL_TIMEOUT;
+		} else
+			ret = dummy_spi_send_command(flash, cmds->writecnt, cmds->readcnt,
+						     cmds->writearr, cmds->readarr);
+	}
+	return ret;
+}
+
+static int dummy_spi_poll_status(struct flashctx *flash, uint8_t opcode,
+				 uint8_t mask, unsigned int timeout_us)
+{
+	unsigned char status;
+
+	return dummy_poll(flash, opcode, mask, timeout_us, &status);
+}
+
 static int dummy_spi_write_256(struct flashctx *flash, uint8_t *buf,
 			       unsigned int start, unsigned int len)
 {
@@ -64,6 +64,9 @@ int probe_en29lv640b(struct flashctx *flash)
 	chipaddr bios = flash->virtual_memory;
 	uint16_t id1, id2;
 
+	/* Not a sequence the probe cache knows. */
+	probe_cache_flush();
+
 	chip_writeb(flash, 0xAA, bios + 0xAAA);
 	chip_writeb(flash, 0x55, bios + 0x555);
 	chip_writeb(flash, 0x90, bios + 0xAAA);
@@ -0,0 +1,385 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Erase/write planning.
+ *
+ * The usable erase functions of a chip are ordered from the finest to the
+ * coarsest layout, and every block is either erased as a whole or handled with
+ * the blocks of the next finer layout, whichever is estimated to be faster.
+ * The estimates come from the cost hooks of the chip family.
+ */
+
+#include <stdlib.h>
+#include "flash.h"
+#include "chipdrivers.h"
+#include "programmer.h"
+
+/* Rough typical durations for chips without a family of their own: erasing
+ * takes about 20 ms plus 3 ms per kB, programming a byte about 20 us.
+ */
+static uint64_t generic_erase_cost(const struct flashctx *flash, erasefunc_t *block_erase,
+				   unsigned int len)
+{
+	return 20000 + 3000ULL * len / 1024;
+}
+
+static uint64_t generic_write_cost(const struct flashctx *flash, const uint8_t *have,
+				   const uint8_t *want, unsigned int start, unsigned int len)
+{
+	unsigned int i;
+	uint64_t cost = 0;
+
+	for (i = 0; i < len; i++)
+		if ((have ? have[i] : 0xff) != want[i])
+			cost += 20;
+	return cost;
+}
+
+/* Cost estimates in microseconds, selected by the bus of the chip. The last
+ * entry is used for all other chips.
+ */
+static const struct plan_costs {
+	enum chipbustype bustype;
+	/* Erasing the block of @len bytes with @block_erase. */
+	uint64_t (*erase) (const struct flashctx *flash, erasefunc_t *block_erase,
+			   unsigned int len);
+	/* Programming the bytes of the block at @start which differ between
+	 * @want and @have. If @have is NULL, the block is assumed to be erased.
+	 */
+	uint64_t (*write) (const struct flashctx *flash, const uint8_t *have,
+			   const uint8_t *want, unsigned int start, unsigned int len);
+} plan_costs[] = {
+	{BUS_SPI,	spi_erase_cost,		spi_write_cost},
+	{BUS_NONE,	generic_erase_cost,	generic_write_cost},
+};
+
+static const struct plan_costs *plan_get_costs(const struct flashctx *flash)
+{
+	const struct plan_costs *costs = plan_costs;
+
+	while (costs->bustype != BUS_NONE && !(flash->chip->bustype & costs->bustype))
+		costs++;
+	return costs;
+}
+
+static uint64_t plan_erase_cost(const struct flashctx *flash, int k, unsigned int len)
+{
+	return plan_get_costs(flash)->erase(flash, flash->chip->block_erasers[k].block_erase, len);
+}
+
+static uint64_t plan_write_cost(const struct flashctx *flash, const uint8_t *have,
+				const uint8_t *want, unsigned int start, unsigned int len)
+{
+	return plan_get_costs(flash)->write(flash, have, want, start, len);
+}
+
+struct plan_block {
+	unsigned int start;
+	unsigned int len;
+	unsigned int first_child;	/* First block in the next finer level. */
+	int erase;			/* Erase this block as a whole. */
+	uint64_t cost;			/* Estimated time in microseconds. */
+};
+
+struct plan_level {
+	int eraser;			/* Index into chip->block_erasers. */
+	unsigned int count;
+	struct plan_block *blocks;
+};
+
+/* Fill @level with the blocks of erase function @k which lie inside the window
+ * [base, base + len - 1]. Returns 0 if they cover the window completely.
+ */
+static int plan_fill_level(const struct flashctx *flash, int k, struct plan_level *level,
+			   unsigned int base, unsigned int len)
+{
+	const struct block_eraser *eraser = &flash->chip->block_erasers[k];
+	unsigned int start, blocklen, covered = 0;
+	int i, j, pass;
+
+	level->eraser = k;
+	level->count = 0;
+	level->blocks = NULL;
+	/* Count the blocks first, then fill them in. */
+	for (pass = 0; pass < 2; pass++) {
+		if (pass) {
+			if (!level->count)
+				return 1;
+			level->blocks = calloc(level->count, sizeof(struct plan_block));
+			if (!level->blocks) {
+				msg_gerr("Out of memory!\n");
+				exit(1);
+			}
+			level->count = 0;
+		}
+		start = 0;
+		for (i = 0; i < NUM_ERASEREGIONS; i++) {
+			blocklen = eraser->eraseblocks[i].size;
+			for (j = 0; j < eraser->eraseblocks[i].count; j++) {
+				if (start >= base && start + blocklen <= base + len) {
+					if (pass) {
+						level->blocks[level->count].start = start;
+						level->blocks[level->count].len = blocklen;
+						covered += blocklen;
+					}
+					level->count++;
+				}
+				start += blocklen;
+			}
+		}
+	}
+	return covered != len;
+}
+
+/* Check that every block of @coarse is made of whole blocks of @fine and
+ * remember the first of them. Returns 0 if the layouts nest, 1 otherwise.
+ */
+static int plan_link_levels(const struct plan_level *fine, struct plan_level *coarse)
+{
+	unsigned int i, j = 0;
+	struct plan_block *b;
+
+	for (i = 0; i < coarse->count; i++) {
+		b = &coarse->blocks[i];
+		if (j >= fine->count || fine->blocks[j].start != b->start)
+			return 1;
+		b->first_child = j;
+		while (j < fine->count &&
+		       fine->blocks[j].start + fine->blocks[j].len <= b->start + b->len)
+			j++;
+		/* The first fine block reaches beyond the coarse one. */
+		if (j == b->first_child)
+			return 1;
+		if (fine->blocks[j - 1].start + fine->blocks[j - 1].len != b->start + b->len)
+			return 1;
+	}
+	return 0;
+}
+
+static unsigned int plan_children_end(const struct plan_level *fine,
+				      const struct plan_level *coarse, unsigned int i)
+{
+	if (i + 1 < coarse->count)
+		return coarse->blocks[i + 1].first_child;
+	return fine->count;
+}
+
+/* Count the blocks of each level which are erased as a whole. */
+static void plan_count(const struct plan_level *levels, int l, unsigned int i,
+		       unsigned int *erases)
+{
+	const struct plan_block *b = &levels[l].blocks[i];
+	unsigned int c, end;
+
+	if (b->erase) {
+		erases[l]++;
+		return;
+	}
+	if (!l)
+		return;
+	end = plan_children_end(&levels[l - 1], &levels[l], i);
+	for (c = b->first_child; c < end; c++)
+		plan_count(levels, l - 1, c, erases);
+}
+
+static int plan_execute(struct flashctx *flash, const struct plan_level *levels,
+			int l, unsigned int i, uint8_t *curcontents,
+			uint8_t *newcontents, unsigned int base, int *first,
+			enum erase_verify_policy policy)
+{
+	const struct plan_block *b = &levels[l].blocks[i];
+	unsigned int c, end;
+
+	if (l && !b->erase) {
+		end = plan_children_end(&levels[l - 1], &levels[l], i);
+		for (c = b->first_child; c < end; c++)
+			if (plan_execute(flash, levels, l - 1, c, curcontents,
+					 newcontents, base, first, policy))
+				return 1;
+		return 0;
+	}
+	if (!*first)
+		msg_cdbg(", ");
+	*first = 0;
+	msg_cdbg("0x%06x-0x%06x", b->start, b->start + b->len - 1);
+	return erase_and_write_block(flash, b->start, b->len,
+			curcontents + b->start - base, newcontents + b->start - base,
+			flash->chip->block_erasers[levels[l].eraser].block_erase, policy);
+}
+
+/* Plan the erase/write operation with all usable erase functions at once.
+ * The erase functions are ordered from the finest to the coarsest layout and
+ * every block is either erased as a whole or split into the blocks of the next
+ * finer layout, whichever is estimated to be faster. This allows e.g. to erase
+ * a mostly changed 64 kB block in one go while only touching a few 4 kB
+ * sectors elsewhere. Layouts which don't nest are not used for planning.
+ * Only blocks inside the window [base, base + len - 1] are considered, and
+ * @curcontents and @newcontents hold the contents of the window. Erases are
+ * checked according to @policy.
+ * Returns 0 on success, -1 if no plan could be made (the chip is untouched) and
+ * 1 if erasing or writing failed.
+ */
+int erase_and_write_planned(struct flashctx *flash, uint8_t *curcontents,
+			    uint8_t *newcontents, unsigned int base,
+			    unsigned int len, enum erase_verify_policy policy)
+{
+	struct plan_level levels[NUM_ERASEFUNCTIONS];
+	struct plan_level *level, *fine;
+	struct plan_block *b;
+	uint8_t *have, *want;
+	enum write_granularity gran = flash->chip->gran;
+	unsigned int erases[NUM_ERASEFUNCTIONS] = { 0 };
+	unsigned int counts[NUM_ERASEFUNCTIONS];
+	int order[NUM_ERASEFUNCTIONS];
+	uint64_t planned = 0, erase_cost, start_us;
+	unsigned int i, c, end;
+	int nlevels = 0, ret = 0, first = 1;
+	int k, l;
+
+	/* Sort the usable erasers by descending block count, i.e. from the
+	 * finest to the coarsest layout.
+	 */
+	for (k = 0; k < NUM_ERASEFUNCTIONS; k++) {
+		if (check_block_eraser(flash, k, 0))
+			continue;
+		for (l = nlevels; l > 0 && counts[l - 1] < count_eraseblocks(flash, k); l--) {
+			counts[l] = counts[l - 1];
+			order[l] = order[l - 1];
+		}
+		counts[l] = count_eraseblocks(flash, k);
+		order[l] = k;
+		nlevels++;
+	}
+	if (!nlevels)
+		return -1;
+
+	/* Layouts which don't cover the window, are identical to or don't nest
+	 * into the next finer one are not used.
+	 */
+	for (k = 0, l = 0; k < nlevels; k++) {
+		if (plan_fill_level(flash, order[k], &levels[l], base, len) ||
+		    (l && (levels[l].count == levels[l - 1].count ||
+			   plan_link_levels(&levels[l - 1], &levels[l])))) {
+			msg_cdbg("Not planning with erase function %i. ", order[k]);
+			free(levels[l].blocks);
+			continue;
+		}
+		l++;
+	}
+	nlevels = l;
+	if (!nlevels)
+		return -1;
+
+	level = &levels[0];
+	for (i = 0; i < level->count; i++) {
+		b = &level->blocks[i];
+		have = curcontents + b->start - base;
+		want = newcontents + b->start - base;
+		if (need_erase(have, want, b->len, gran)) {
+			b->erase = 1;
+			b->cost = plan_erase_cost(flash, level->eraser, b->len) +
+				  plan_write_cost(flash, NULL, want, b->start, b->len);
+		} else {
+			b->cost = plan_write_cost(flash, have, want, b->start, b->len);
+		}
+	}
+	for (l = 1; l < nlevels; l++) {
+		fine = &levels[l - 1];
+		level = &levels[l];
+		for (i = 0; i < level->count; i++) {
+			b = &level->blocks[i];
+			end = plan_children_end(fine, level, i);
+			for (c = b->first_child; c < end; c++)
+				b->cost += fine->blocks[c].cost;
+			/* Erasing a block none of whose children need an erase
+			 * is never cheaper, so erase here implies need_erase().
+			 * Blocks reaching outside the work area were not read
+			 * completely and must not be erased as a whole.
+			 */
+			erase_cost = plan_erase_cost(flash, level->eraser, b->len) +
+				     plan_write_cost(flash, NULL, newcontents + b->start - base,
+						     b->start, b->len);
+			if (erase_cost < b->cost &&
+			    in_work_area(flash, b->start, b->len)) {
+				b->erase = 1;
+				b->cost = erase_cost;
+			}
+		}
+	}
+
+	level = &levels[nlevels - 1];
+	for (i = 0; i < level->count; i++) {
+		planned += level->blocks[i].cost;
+		plan_count(levels, nlevels - 1, i, erases);
+	}
+	msg_cdbg("Erase plan:");
+	for (l = 0; l < nlevels; l++)
+		msg_cdbg(" %u block(s) with erase function %i,", erases[l], levels[l].eraser);
+	msg_cdbg(" estimated %lu ms.\n", (unsigned long)(planned / 1000));
+
+	start_us = timestamp_usecs();
+	for (i = 0; i < level->count; i++) {
+		ret = plan_execute(flash, levels, nlevels - 1, i, curcontents,
+				   newcontents, base, &first, policy);
+		if (ret)
+			break;
+	}
+	msg_cdbg("\n");
+	if (!ret)
+		msg_cdbg("Erase/write took %lu ms, estimated %lu ms.\n",
+			 (unsigned long)((timestamp_usecs() - start_us) / 1000),
+			 (unsigned long)(planned / 1000));
+
+	for (l = 0; l < nlevels; l++)
+		free(levels[l].blocks);
+	return ret ? 1 : 0;
+}
+
+/* Erase and write the window [base, base + len - 1] with erase function @k
+ * only. @curcontents and @newcontents hold the contents of the window, erases
+ * are checked according to @policy.
+ * Returns 0 on success, -1 if the blocks of @k don't cover the window (the chip
+ * is untouched) and 1 if erasing or writing failed.
+ */
+int erase_and_write_window(struct flashctx *flash, int k, uint8_t *curcontents,
+			   uint8_t *newcontents, unsigned int base, unsigned int len,
+			   enum erase_verify_policy policy)
+{
+	struct plan_level level;
+	struct plan_block *b;
+	unsigned int i;
+	int ret = 0;
+
+	if (plan_fill_level(flash, k, &level, base, len)) {
+		free(level.blocks);
+		return -1;
+	}
+	msg_cdbg("Trying erase function %i... ", k);
+	for (i = 0; i < level.count && !ret; i++) {
+		b = &level.blocks[i];
+		msg_cdbg("%s0x%06x-0x%06x", i ? ", " : "", b->start,
+			 b->start + b->len - 1);
+		ret = erase_and_write_block(flash, b->start, b->len,
+				curcontents + b->start - base,
+				newcontents + b->start - base,
+				flash->chip->block_erasers[k].block_erase, policy);
+	}
+	msg_cdbg("\n");
+	free(level.blocks);
+	return ret ? 1 : 0;
+}
@@ -66,11 +66,26 @@ enum chipbustype {
  * - 128 bytes: If less than 128 bytes are written, the rest will be erased. Each write to a 128-byte region
  *   will trigger an automatic erase before anything is written. Very uncommon behaviour.
  * - 256 bytes: If less than 256 bytes are written, the contents of the unwritten bytes are undefined.
+ * Chips which don't specify their granularity get 256 bytes, the safest of these.
  */
 enum write_granularity {
+	write_gran_256bytes = 0,
 	write_gran_1bit,
 	write_gran_1byte,
-	write_gran_256bytes,
+};
+
+/*
+ * How erased blocks are checked before they are written:
+ * - full: Read back every erased block and compare it against 0xff.
+ * - deferred: Don't read back, rely on the final verification. Blocks which
+ *   fail it are erased and written again with full checking.
+ * - status: Don't read back, check the erase error bits of the status register.
+ *   Only 82802AB style chips have them, all others are checked like full.
+ */
+enum erase_verify_policy {
+	ERASE_VERIFY_FULL = 0,
+	ERASE_VERIFY_DEFERRED,
+	ERASE_VERIFY_STATUS,
 };
 
 /*
@@ -99,11 +114,83 @@ enum write_granularity {
 #define FEATURE_WRSR_EWSR	(1 << 6)
 #define FEATURE_WRSR_WREN	(1 << 7)
 #define FEATURE_OTP		(1 << 8)
+/* Reads can't cross page boundaries, e.g. AT45DB with non-power-of-two pages. */
+#define FEATURE_PAGED_READ	(1 << 9)
+/* Read opcodes beyond JEDEC_READ, all with 8 dummy cycles unless SFDP says
+ * otherwise. Quad output is only flagged if it works without setting QE.
+ */
+#define FEATURE_FAST_READ	(1 << 10)
+#define FEATURE_DUAL_OUT	(1 << 11)
+#define FEATURE_QUAD_OUT	(1 << 12)
+/* Chips above 16 MiB: Commands with a 4-byte address (0x13, 0x12, 0x21, 0xdc
+ * etc.), or 4-byte address mode entered with 0xb7, optionally after WREN.
+ */
+#define FEATURE_4BA_NATIVE	(1 << 13)
+#define FEATURE_4BA_ENTER	(1 << 14)
+#define FEATURE_4BA_ENTER_WREN	(1 << 15)
 #define FEATURE_WRSR_EITHER	(FEATURE_WRSR_EWSR | FEATURE_WRSR_WREN)
 
 struct flashctx;
 typedef int (erasefunc_t)(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
 
+/* Fast read modes described by SFDP, named after the number of lines used for
+ * opcode, address and data.
+ */
+enum sfdp_read_mode {
+	SFDP_READ_1_1_2,
+	SFDP_READ_1_2_2,
+	SFDP_READ_1_1_4,
+	SFDP_READ_1_4_4,
+	SFDP_READ_2_2_2,
+	SFDP_READ_4_4_4,
+	SFDP_READ_MODES,
+};
+
+enum sfdp_addr_mode {
+	SFDP_ADDR_3,
+	SFDP_ADDR_3_OR_4,
+	SFDP_ADDR_4,
+};
+
+#define SFDP_ERASE_TYPES 4
+#define SFDP_QER_UNKNOWN 0xff
+
+/*
+ * Contents of the JEDEC basic flash parameter table (JESD216) of a chip.
+ * Opcodes, sizes and times which the table doesn't specify are 0.
+ */
+struct sfdp_params {
+	enum sfdp_addr_mode addr_mode;
+	/* Density in bytes */
+	uint64_t size;
+	/* Page program buffer size in bytes */
+	unsigned int page_size;
+	struct sfdp_fast_read {
+		uint8_t opcode;
+		uint8_t dummy_cycles;
+		uint8_t mode_cycles;
+	} read[SFDP_READ_MODES];
+	uint8_t opcode_4k_erase;
+	struct sfdp_erase_type {
+		uint32_t size;
+		uint8_t opcode;
+		unsigned int typ_us;
+		unsigned int max_us;
+	} erase[SFDP_ERASE_TYPES];
+	unsigned int chip_erase_typ_ms;
+	unsigned int chip_erase_max_ms;
+	unsigned int page_program_typ_us;
+	unsigned int page_program_max_us;
+	/* Programming n bytes takes first + (n - 1) * additional */
+	unsigned int byte_program_first_us;
+	unsigned int byte_program_add_us;
+	/* Raw QER field of DW15, SFDP_QER_UNKNOWN for older tables */
+	uint8_t quad_enable;
+	/* Raw method masks of DW16, see JESD216B */
+	uint8_t enter_4b;
+	uint16_t exit_4b;
+};
+
 struct flashchip {
 	const char *vendor;
 	const char *name;
@@ -122,7 +209,14 @@ struct flashchip {
 	unsigned int total_size;
 	/* Chip page size in bytes */
 	unsigned int page_size;
+	/* Largest number of bytes one program command can write, writes are
+	 * split at multiples of it. Only needed by page programming chips.
+	 */
+	unsigned int max_write_chunk;
+	enum write_granularity gran;
 	int feature_bits;
+	/* Filled in by SFDP probing, NULL for chips from the table */
+	const struct sfdp_params *sfdp;
 
 	/*
 	 * Indicate if flashrom has been tested with this flash chip and if
@@ -170,6 +264,10 @@ struct flashctx {
 	/* Some flash devices have an additional register space. */
 	chipaddr virtual_registers;
 	struct registered_programmer *pgm;
+	/* The chip takes 4-byte addresses with the 3-byte opcodes, see
+	 * spi_prepare_4ba().
+	 */
+	int in_4ba_mode;
 };
 
 #define TEST_UNTESTED	0
@@ -204,6 +302,11 @@ struct flashctx {
 
 extern const struct flashchip flashchips[];
 
+enum par_poll_type {
+	POLL_TOGGLE,	/* Until the bits in mask stop toggling */
+	POLL_DATA,	/* Until the bits in mask equal value */
+};
+
 void chip_writeb(const struct flashctx *flash, uint8_t val, chipaddr addr);
 void chip_writew(const struct flashctx *flash, uint16_t val, chipaddr addr);
 void chip_writel(const struct flashctx *flash, uint32_t val, chipaddr addr);
@@ -212,6 +315,8 @@ uint8_t chip_readb(const struct flashctx *flash, const chipaddr addr);
 uint16_t chip_readw(const struct flashctx *flash, const chipaddr addr);
 uint32_t chip_readl(const struct flashctx *flash, const chipaddr addr);
 void chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len);
+int chip_poll(const struct flashctx *flash, enum par_poll_type type, chipaddr addr, uint8_t mask,
+	      uint8_t value, unsigned int timeout_us);
 
 /* print.c */
 char *flashbuses_to_text(enum chipbustype bustype);
@@ -223,10 +328,21 @@ extern int verbose_screen;
 extern int verbose_logfile;
 extern const char flashrom_version[];
 extern const char *chip_to_probe;
+extern enum erase_verify_policy erase_verify_policy;
+extern int verify_all;
+extern int low_memory;
 void map_flash_registers(struct flashctx *flash);
 int read_memmapped(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 int erase_flash(struct flashctx *flash);
 int probe_flash(struct registered_programmer *pgm, int startchip, struct flashctx *fill_flash, int force);
+void free_chip_copy(struct flashchip *chip);
+int probe_cache_lookup(const char *method, const void *key, unsigned int keylen, void *data,
+		       unsigned int datalen, int *ret);
+void probe_cache_store(const char *method, const void *key, unsigned int keylen,
+		       const void *data, unsigned int datalen, int ret);
+void probe_cache_flush(void);
+int probe_flash_by_id(struct registered_programmer *pgm, uint32_t manufacture_id, uint32_t model_id,
+		      struct flashctx *flash);
 int read_flash_to_file(struct flashctx *flash, const char *filename);
 int min(int a, int b);
 int max(int a, int b);
@@ -234,6 +350,17 @@ void tolower_string(char *str);
 char *extract_param(const char *const *haystack, const char *needle, const char *delim);
 int verify_range(struct flashctx *flash, uint8_t *cmpbuf, unsigned int start, unsigned int len);
 int need_erase(uint8_t *have, uint8_t *want, unsigned int len, enum write_granularity gran);
+/* Limits for merging nearby writes into one write command. */
+struct write_merge {
+	unsigned int max_gap;	/* Longest run of unchanged bytes worth rewriting. */
+	unsigned int chunk;	/* Merged writes must not cross a multiple of this. */
+	unsigned int max_len;	/* Merged writes must not be longer than this. */
+};
+unsigned int get_next_write(uint8_t *have, uint8_t *want, unsigned int len, unsigned int *first_start,
+			    enum write_granularity gran, const struct write_merge *merge, unsigned int addr);
+int selfcheck_eraseblocks(const struct flashchip *chip);
+int generate_testpattern(uint8_t *buf, uint32_t size, int variant);
+int compare_range(uint8_t *wantbuf, uint8_t *havebuf, unsigned int start, unsigned int len);
 char *strcat_realloc(char *dest, const char *src);
 void print_version(void);
 void print_buildinfo(void);
@@ -241,6 +368,16 @@ void print_banner(void);
 void list_programmers_linebreak(int startcol, int cols, int paren);
 int selfcheck(void);
 int doit(struct flashctx *flash, int force, const char *filename, int read_it, int write_it, int erase_it, int verify_it);
+int chip_safety_check(const struct flashctx *flash, int force, int read_it, int write_it, int erase_it, int verify_it);
+int prepare_flash_access(struct flashctx *flash);
+void finish_flash_access(struct flashctx *flash);
+int check_block_eraser(const struct flashctx *flash, int k, int log);
+unsigned int count_eraseblocks(const struct flashctx *flash, int k);
+int in_work_area(const struct flashctx *flash, unsigned int start, unsigned int len);
+int erase_and_write_block(struct flashctx *flash, unsigned int start, unsigned int len,
+			  uint8_t *curcontents, uint8_t *newcontents, erasefunc_t *erasefn,
+			  enum erase_verify_policy policy);
+void emergency_help_message(void);
 int read_buf_from_file(unsigned char *buf, unsigned long size, const char *filename);
 int write_buf_to_file(unsigned char *buf, unsigned long size, const char *filename);
 
@@ -278,6 +415,7 @@ enum msglevel {
 };
 /* Let gcc and clang check for correct printf-style format strings. */
 int print(enum msglevel level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void print_to_stderr(void);
 #define msg_gerr(...)	print(MSG_ERROR, __VA_ARGS__)	/* general errors */
 #define msg_perr(...)	print(MSG_ERROR, __VA_ARGS__)	/* programmer errors */
 #define msg_cerr(...)	print(MSG_ERROR, __VA_ARGS__)	/* chip errors */
@@ -294,22 +432,86 @@ int print(enum msglevel level, const char *fmt, ...) __attribute__((format(print
 #define msg_pspew(...)	print(MSG_SPEW, __VA_ARGS__)	/* programmer debug spew  */
 #define msg_cspew(...)	print(MSG_SPEW, __VA_ARGS__)	/* chip debug spew  */
 
+/* memscan.c */
+unsigned int memscan_first_diff(const uint8_t *have, const uint8_t *want, unsigned int len);
+unsigned int memscan_first_equal(const uint8_t *have, const uint8_t *want, unsigned int len);
+unsigned int memscan_first_not_erased(const uint8_t *buf, unsigned int len);
+unsigned int memscan_first_bit_conflict(const uint8_t *have, const uint8_t *want, unsigned int len);
+unsigned int memscan_first_byte_conflict(const uint8_t *have, const uint8_t *want, unsigned int len);
+int memscan_select(const char *name);
+const char *memscan_name(int n);
+
+/* benchmark.c */
+int benchmark_flash(struct flashctx *flash, int force, const char *chunklist, const char *range);
+
+/* cache.c */
+int cache_set_dir(const char *dir);
+int cache_set_old_image(const char *filename);
+int cache_active(void);
+uint64_t cache_hash(const uint8_t *buf, unsigned int len);
+char *cache_file_name(const char *kind, const char *key);
+int cache_load_image(struct flashctx *flash, uint8_t *buf);
+void cache_store_image(struct flashctx *flash, const uint8_t *buf);
+void cache_drop_image(struct flashctx *flash);
+int cache_load_last_chip(int *pgm_index, uint32_t *manufacture_id, uint32_t *model_id);
+void cache_store_last_chip(int pgm_index, const struct flashchip *chip);
+
+/* erase_plan.c */
+int erase_and_write_planned(struct flashctx *flash, uint8_t *curcontents, uint8_t *newcontents,
+			    unsigned int base, unsigned int len, enum erase_verify_policy policy);
+int erase_and_write_window(struct flashctx *flash, int k, uint8_t *curcontents,
+			   uint8_t *newcontents, unsigned int base, unsigned int len,
+			   enum erase_verify_policy policy);
+
 /* layout.c */
 int register_include_arg(char *name);
 int process_include_args(void);
 int read_romlayout(char *name);
 int handle_romentries(const struct flashctx *flash, uint8_t *oldcontents, uint8_t *newcontents);
+int handle_romentries_window(uint8_t *oldcontents, uint8_t *newcontents,
+			     unsigned int base, unsigned int len);
+int included_regions_overlap(unsigned int start, unsigned int end);
 
 /* spi.c */
+/* Transfer modes of struct spi_command. Programmers announce the ones they
+ * support in struct spi_programmer.io_modes.
+ */
+#define SPI_IO_POLL		(1 << 0)	/* Waits for the chip, see below */
+#define SPI_IO_FAST_READ	(1 << 1)	/* Dummy cycles before readarr */
+#define SPI_IO_DUAL_OUT		(1 << 2)	/* readarr is shifted in on IO0-IO1 */
+#define SPI_IO_QUAD_OUT		(1 << 3)	/* readarr is shifted in on IO0-IO3 */
+#define SPI_IO_4BA		(1 << 4)	/* Commands with 4-byte addresses */
 struct spi_command {
 	unsigned int writecnt;
 	unsigned int readcnt;
 	const unsigned char *writearr;
 	unsigned char *readarr;
+	/* SPI_IO_* flags, 0 for a plain single line transfer */
+	unsigned int io;
+	/* The last dummy_cycles / 8 bytes of writearr are dummy bytes. They
+	 * are sent on a single line like the rest of writearr, their value
+	 * doesn't matter.
+	 */
+	unsigned int dummy_cycles;
+	/* With SPI_IO_POLL, this is no single transfer: the programmer repeats
+	 * the status register read writearr[0] until the bits in poll_mask are
+	 * clear, with readarr getting the last status. Running into
+	 * poll_timeout_us fails the batch with SPI_POLL_TIMEOUT, readarr of
+	 * that wait then still reads busy or is left alone.
+	 */
+	uint8_t poll_mask;
+	unsigned int poll_timeout_us;
 };
 int spi_send_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt, const unsigned char *writearr, unsigned char *readarr);
 int spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds);
+int spi_poll_status(struct flashctx *flash, uint8_t opcode, uint8_t mask, unsigned int timeout_us);
+int spi_queue_reserve(struct flashctx *flash, unsigned int entries, unsigned int datalen);
+int spi_queue_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
+		      const unsigned char *writearr, unsigned char *readarr);
+void spi_queue_wait_ready(struct flashctx *flash, uint8_t opcode, unsigned int len);
+int spi_queue_flush(struct flashctx *flash);
 uint32_t spi_get_valid_read_addr(struct flashctx *flash);
+unsigned int spi_get_write_overhead(struct flashctx *flash);
 
 enum chipbustype get_buses_supported(void);
 #endif				/* !__FLASH_H__ */
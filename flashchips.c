@@ -65,6 +65,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29F010B,	/* Same as Am29F010A */
 		.total_size	= 128,
 		.page_size	= 16 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -92,6 +93,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29F002BB,
 		.total_size	= 256,
 		.page_size	= 256,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_SHORT_RESET | FEATURE_ADDR_2AA,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -124,6 +126,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29F002BT,
 		.total_size	= 256,
 		.page_size	= 256,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET | FEATURE_ADDR_2AA,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -156,6 +159,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29F016D,
 		.total_size	= 2 * 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -183,6 +187,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29F040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -210,6 +215,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29F080B,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -237,6 +243,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV001BB,
 		.total_size	= 128,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -268,6 +275,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV001BT,
 		.total_size	= 128,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -299,6 +307,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV002BB,
 		.total_size	= 256,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -331,6 +340,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV002BT,
 		.total_size	= 256,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -363,6 +373,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV004BB,
 		.total_size	= 512,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -395,6 +406,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV004BT,
 		.total_size	= 512,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -427,6 +439,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV008BB,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -459,6 +472,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV008BT,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -491,6 +505,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -518,6 +533,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMD_AM29LV080B,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET, /* datasheet specifies address as don't care */
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -545,6 +561,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L05PT,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid4,
@@ -579,6 +597,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L05PU,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid4,
@@ -613,6 +633,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L10PT,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid4,
@@ -648,6 +670,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L10PU,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid4,
@@ -683,6 +707,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L20PT,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid4,
@@ -718,6 +744,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L20PU,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid4,
@@ -758,6 +786,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L40PT,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid4,
@@ -793,6 +823,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L40PU,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid4,
@@ -828,6 +860,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L80P,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_spi_rdid4,
@@ -863,6 +897,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L16PT,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid4,
@@ -901,6 +937,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L16PU,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid4,
@@ -939,6 +977,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L512,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -971,6 +1011,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L010,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1003,6 +1045,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L020,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1035,6 +1079,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L040,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1067,6 +1113,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L080,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1099,6 +1147,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L016,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1131,6 +1181,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25L032,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 64B total; read 0x4B, 0x48; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_OK_PREW,
@@ -1170,6 +1222,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A25LQ032,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 64B total; read 0x4B, 0x48; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -1209,6 +1263,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A29002B,
 		.total_size	= 256,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -1241,6 +1296,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A29002T,
 		.total_size	= 256,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -1273,6 +1329,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A29040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -1300,6 +1357,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= AMIC_A49LF040A,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -1328,6 +1386,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF021,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 128B total, 64B pre-programmed; read 0x77; write 0x9B */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -1367,6 +1427,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF041A,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1405,6 +1467,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF081,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1443,6 +1507,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF081A,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1481,6 +1547,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF161,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PROBE,
 		.probe		= probe_spi_rdid,
@@ -1519,6 +1587,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF321,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -1557,6 +1627,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF321A,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 128B total, 64B pre-programmed; read 0x77; write 0x9B */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_OK_PREW,
@@ -1596,6 +1668,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DF641,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1634,6 +1708,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25DQ161,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 128B total, 64B pre-programmed; read 0x77; write 0x9B */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -1673,6 +1749,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25F512,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_at25f,
@@ -1702,6 +1780,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25F512A,
 		.total_size	= 64,
 		.page_size	= 128,
+		.max_write_chunk = 128,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_at25f,
@@ -1732,6 +1812,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25F512B,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 128B total, 64B pre-programmed; read 0x77; write 0x9B */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -1776,6 +1858,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25F1024,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_at25f,
@@ -1805,6 +1889,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25F2048,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_at25f,
@@ -1834,6 +1920,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25F4096,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_at25f,
@@ -1863,6 +1951,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25FS010,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1904,6 +1994,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT25FS040,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -1942,6 +2034,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT26DF041,
 		.total_size	= 512,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_FAST_READ,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -1974,6 +2068,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT26DF081A,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -2012,6 +2108,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT26DF161,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid,
@@ -2050,6 +2148,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT26DF161A,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -2144,6 +2244,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT29C512,
 		.total_size	= 64,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -2168,6 +2269,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT29C010A,
 		.total_size	= 128,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -2192,6 +2294,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT29C020,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -2216,6 +2319,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT29C040A,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -2241,6 +2345,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 16896 /* No power of two sizes */,
 		.page_size	= 1056 /* No power of two sizes */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2258,6 +2363,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 128 /* Size can only be determined from status register */,
 		.page_size	= 256 /* Size can only be determined from status register */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2275,6 +2381,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 256 /* Size can only be determined from status register */,
 		.page_size	= 256 /* Size can only be determined from status register */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2292,6 +2399,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 512 /* Size can only be determined from status register */,
 		.page_size	= 256 /* Size can only be determined from status register */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2309,6 +2417,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 1024 /* Size can only be determined from status register */,
 		.page_size	= 256 /* Size can only be determined from status register */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2326,6 +2435,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 2048 /* Size can only be determined from status register */,
 		.page_size	= 512 /* Size can only be determined from status register */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2343,6 +2453,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 4224 /* No power of two sizes */,
 		.page_size	= 528 /* No power of two sizes */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2361,7 +2472,7 @@ const struct flashchip flashchips[] = {
 		.page_size	= 512 /* Size can only be determined from status register */,
 		/* OTP: 128B total, 64B pre-programmed; read 0x77; write 0x9B */
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
-		.feature_bits	= FEATURE_OTP,
+		.feature_bits	= FEATURE_OTP | FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2379,6 +2490,7 @@ const struct flashchip flashchips[] = {
 		.total_size	= 8192 /* Size can only be determined from status register */,
 		.page_size	= 1024 /* Size can only be determined from status register */,
 		/* does not support EWSR nor WREN and has no writable status register bits whatsoever */
+		.feature_bits	= FEATURE_PAGED_READ,
 		.tested		= TEST_BAD_REW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -2395,6 +2507,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49BV512,
 		.total_size	= 64,
 		.page_size	= 64,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -2419,6 +2532,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49F002N,
 		.total_size	= 256,
 		.page_size	= 256,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -2451,6 +2565,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49F002NT,
 		.total_size	= 256,
 		.page_size	= 256,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_jedec,
@@ -2483,6 +2598,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49F010,
 		.total_size	= 128,
 		.page_size	= 0, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -2508,6 +2624,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49F020,
 		.total_size	= 256,
 		.page_size	= 0, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -2539,6 +2656,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49F040,
 		.total_size	= 512,
 		.page_size	= 0, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -2570,6 +2688,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49F080,
 		.total_size	= 1024,
 		.page_size	= 0, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -2602,6 +2721,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49F080T,
 		.total_size	= 1024,
 		.page_size	= 0, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -2633,6 +2753,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ATMEL_AT49LH002,
 		.total_size	= 256,
 		.page_size	= 0, /* unused */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP, /* TODO: LPC OK too? */
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab, /* TODO: 0xff cmd not documented? */
@@ -2693,6 +2814,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= BRIGHT_BM29F040,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_jedec,
@@ -2720,6 +2842,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= EMST_F49B002UA,
 		.total_size	= 256,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -2752,6 +2875,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= EMST_F25L008A,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EITHER,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -2787,6 +2911,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B05,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -2821,6 +2947,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B05,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -2855,6 +2983,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B10,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -2889,6 +3019,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B10,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -2923,6 +3055,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B20,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -2958,6 +3092,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B20,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -2993,6 +3129,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B40,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3028,6 +3166,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B40,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3063,6 +3203,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3098,6 +3240,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3133,6 +3277,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3168,6 +3314,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3203,6 +3351,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3238,6 +3388,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3273,6 +3425,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3308,6 +3462,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25B64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3343,6 +3499,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F05,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3381,6 +3539,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F10,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3419,6 +3579,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F20,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3457,6 +3619,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F40,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PROBE,
 		.probe		= probe_spi_rdid,
@@ -3492,6 +3656,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -3527,6 +3693,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -3562,6 +3730,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -3597,6 +3767,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25F64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid,
@@ -3632,6 +3804,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25Q40,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 256B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -3668,6 +3842,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25Q80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 256B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -3706,6 +3882,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25Q16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: D16 512B/Q16 128B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -3746,6 +3924,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25Q32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 512B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_OK_PROBE,
@@ -3782,6 +3962,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25Q64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 512B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -3818,6 +4000,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25Q128,
 		.total_size	= 16384,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 512B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -3853,6 +4037,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25QH16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* supports SFDP */
 		/* OTP: 512B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
@@ -3890,6 +4076,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN25QH32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* supports SFDP */
 		/* OTP: 512B total; enter 0x3A */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
@@ -3927,6 +4115,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN29F010,
 		.total_size	= 128,
 		.page_size	= 128,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -3955,6 +4144,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN29F002B,
 		.total_size	= 256,
 		.page_size	= 256,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_AAA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_jedec,
@@ -3987,6 +4177,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= EON_EN29F002T,
 		.total_size	= 256,
 		.page_size	= 256,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_AAA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -4178,6 +4369,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25Q20,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -4216,6 +4409,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25Q40,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -4254,6 +4449,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25Q80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_OK_PREW,
@@ -4293,6 +4490,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25Q16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -4332,6 +4531,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25Q32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -4371,6 +4572,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25Q64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_OK_PREW,
@@ -4409,6 +4612,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25Q128,
 		.total_size	= 16384,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_UNTESTED,
@@ -4447,6 +4652,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= GIGADEVICE_GD25LQ32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -4485,6 +4692,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= HYUNDAI_HY29F002T,
 		.total_size	= 256,
 		.page_size	= 256 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET, /* Some revisions may need FEATURE_ADDR_2AA */
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -4517,6 +4725,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= HYUNDAI_HY29F002B,
 		.total_size	= 256,
 		.page_size	= 256 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET, /* Some revisions may need FEATURE_ADDR_2AA */
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -4549,6 +4758,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= HYUNDAI_HY29F040A,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -4576,8 +4786,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_25F160S33B8,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 506B total (2x 8B, 30x 16B, 1x 10B); read 0x4B; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -4615,8 +4827,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_25F160S33T8,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 506B total (2x 8B, 30x 16B, 1x 10B); read 0x4B; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -4654,8 +4868,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_25F320S33B8,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 506B total (2x 8B, 30x 16B, 1x 10B); read 0x4B; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -4693,8 +4909,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_25F320S33T8,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 506B total (2x 8B, 30x 16B, 1x 10B); read 0x4B; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -4732,8 +4950,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_25F640S33B8,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 506B total (2x 8B, 30x 16B, 1x 10B); read 0x4B; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -4771,8 +4991,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_25F640S33T8,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 506B total (2x 8B, 30x 16B, 1x 10B); read 0x4B; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -4810,6 +5032,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F001B,
 		.total_size	= 128,
 		.page_size	= 128 * 1024, /* 8k + 2x4k + 112k */
+		.gran		= write_gran_1byte,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
 		.probe_timing	= TIMING_ZERO,	/* Datasheet has no timing info specified */
@@ -4837,6 +5060,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F001T,
 		.total_size	= 128,
 		.page_size	= 128 * 1024, /* 112k + 2x4k + 8k */
+		.gran		= write_gran_1byte,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_jedec,
 		.probe_timing	= TIMING_ZERO,	/* Datasheet has no timing info specified */
@@ -4864,6 +5088,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F002T,
 		.total_size	= 256,
 		.page_size	= 256 * 1024,
+		.gran		= write_gran_1byte,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_82802ab,
 		.probe_timing	= TIMING_ZERO, /* Datasheet has no timing info specified */
@@ -4891,6 +5116,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F004S3,
 		.total_size	= 512,
 		.page_size	= 256,
+		.gran		= write_gran_1byte,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
 		.probe_timing	= TIMING_ZERO,	/* Datasheet has no timing info specified */
@@ -4914,6 +5140,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F004B,
 		.total_size	= 512,
 		.page_size	= 128 * 1024, /* maximal block size */
+		.gran		= write_gran_1byte,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
 		.probe_timing	= TIMING_ZERO,	/* Datasheet has no timing info specified */
@@ -4941,6 +5168,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F004T,
 		.total_size	= 512,
 		.page_size	= 128 * 1024, /* maximal block size */
+		.gran		= write_gran_1byte,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
 		.probe_timing	= TIMING_ZERO,	/* Datasheet has no timing info specified */
@@ -4968,6 +5196,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F400B,
 		.total_size	= 512,
 		.page_size	= 128 * 1024, /* maximal block size */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_SHIFTED,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -4996,6 +5225,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_28F400T,
 		.total_size	= 512,
 		.page_size	= 128 * 1024, /* maximal block size */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_SHIFTED,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -5024,6 +5254,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_82802AB,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_82802ab,
@@ -5049,6 +5280,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= INTEL_82802AC,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_82802ab,
@@ -5074,6 +5306,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L512,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5112,6 +5346,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L1005,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -5147,6 +5383,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L2005,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5185,6 +5423,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L4005,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -5223,6 +5463,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L8005,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -5261,6 +5503,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L1605,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -5299,6 +5543,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L1635D,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5334,6 +5580,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L1635E,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5369,6 +5617,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L3205,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -5404,6 +5654,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L3235D,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5439,7 +5691,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L6405,
 		.total_size	= 8192,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -5474,7 +5728,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX25L12805,
 		.total_size	= 16384,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ,
 		.tested		= TEST_OK_PROBE,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -5501,6 +5757,90 @@ const struct flashchip flashchips[] = {
 		.voltage	= {2700, 3600},
 	},
 
+	{
+		.vendor		= "Macronix",
+		.name		= "MX25L25635F",
+		.bustype	= BUS_SPI,
+		.manufacture_id	= MACRONIX_ID,
+		.model_id	= MACRONIX_MX25L25635F,
+		.total_size	= 32768,
+		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		/* supports SFDP */
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT |
+				  FEATURE_4BA_ENTER,
+		.tested		= TEST_UNTESTED,
+		.probe		= probe_spi_rdid,
+		.probe_timing	= TIMING_ZERO,
+		.block_erasers	=
+		{
+			{
+				.eraseblocks = { {4 * 1024, 8192} },
+				.block_erase = spi_block_erase_20,
+			}, {
+				.eraseblocks = { {32 * 1024, 1024} },
+				.block_erase = spi_block_erase_52,
+			}, {
+				.eraseblocks = { {64 * 1024, 512} },
+				.block_erase = spi_block_erase_d8,
+			}, {
+				.eraseblocks = { {32 * 1024 * 1024, 1} },
+				.block_erase = spi_block_erase_60,
+			}, {
+				.eraseblocks = { {32 * 1024 * 1024, 1} },
+				.block_erase = spi_block_erase_c7,
+			}
+		},
+		.printlock	= spi_prettyprint_status_register_default_bp3, /* TODO: check */
+		.unlock		= spi_disable_blockprotect,
+		.write		= spi_chip_write_256,
+		.read		= spi_chip_read,
+		.voltage	= {2700, 3600},
+	},
+
+	{
+		.vendor		= "Macronix",
+		.name		= "MX66L51235F",
+		.bustype	= BUS_SPI,
+		.manufacture_id	= MACRONIX_ID,
+		.model_id	= MACRONIX_MX66L51235F,
+		.total_size	= 65536,
+		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		/* supports SFDP, 4-byte address opcodes and 4-byte address mode */
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT |
+				  FEATURE_4BA_NATIVE | FEATURE_4BA_ENTER,
+		.tested		= TEST_UNTESTED,
+		.probe		= probe_spi_rdid,
+		.probe_timing	= TIMING_ZERO,
+		.block_erasers	=
+		{
+			{
+				.eraseblocks = { {4 * 1024, 16384} },
+				.block_erase = spi_block_erase_21,
+			}, {
+				.eraseblocks = { {32 * 1024, 2048} },
+				.block_erase = spi_block_erase_5c,
+			}, {
+				.eraseblocks = { {64 * 1024, 1024} },
+				.block_erase = spi_block_erase_dc,
+			}, {
+				.eraseblocks = { {64 * 1024 * 1024, 1} },
+				.block_erase = spi_block_erase_60,
+			}, {
+				.eraseblocks = { {64 * 1024 * 1024, 1} },
+				.block_erase = spi_block_erase_c7,
+			}
+		},
+		.printlock	= spi_prettyprint_status_register_default_bp3, /* TODO: check */
+		.unlock		= spi_disable_blockprotect,
+		.write		= spi_chip_write_256,
+		.read		= spi_chip_read,
+		.voltage	= {2700, 3600},
+	},
+
 	{
 		.vendor		= "Macronix",
 		.name		= "MX29F001B",
@@ -5509,6 +5849,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX29F001B,
 		.total_size	= 128,
 		.page_size	= 32 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5542,6 +5883,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX29F001T,
 		.total_size	= 128,
 		.page_size	= 32 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -5575,6 +5917,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX29F002B,
 		.total_size	= 256,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5607,6 +5950,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX29F002T,
 		.total_size	= 256,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -5639,6 +5983,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX29F040,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5666,6 +6011,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MACRONIX_MX29LV040,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_SHORT_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5693,6 +6039,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MVC_V29C51000B,
 		.total_size	= 64,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5720,6 +6067,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MVC_V29C51000T,
 		.total_size	= 64,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5747,6 +6095,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MVC_V29C51400B,
 		.total_size	= 512,
 		.page_size	= 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5774,6 +6123,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MVC_V29C51400T,
 		.total_size	= 512,
 		.page_size	= 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5801,6 +6151,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MVC_V29LC51000,
 		.total_size	= 64,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5828,6 +6179,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MVC_V29LC51001,
 		.total_size	= 128,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5855,6 +6207,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= MVC_V29LC51002,
 		.total_size	= 256,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -5882,6 +6235,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PE10,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5914,6 +6269,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PE20,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5946,6 +6303,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PE40,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -5978,6 +6337,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PE80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -6010,6 +6371,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PE16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -6042,9 +6405,12 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_N25Q016__1E,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* supports SFDP */
 		/* OTP: 64B total; read 0x4B, write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ |
+				  FEATURE_DUAL_OUT | FEATURE_QUAD_OUT,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -6078,9 +6444,12 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_N25Q032__1E,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* supports SFDP */
 		/* OTP: 64B total; read 0x4B, write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ |
+				  FEATURE_DUAL_OUT | FEATURE_QUAD_OUT,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -6111,9 +6480,12 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_N25Q032__3E,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* supports SFDP */
 		/* OTP: 64B total; read 0x4B, write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ |
+				  FEATURE_DUAL_OUT | FEATURE_QUAD_OUT,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -6144,9 +6516,12 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_N25Q064__1E,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* supports SFDP */
 		/* OTP: 64B total; read 0x4B, write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ |
+				  FEATURE_DUAL_OUT | FEATURE_QUAD_OUT,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -6177,9 +6552,12 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_N25Q064__3E,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* supports SFDP */
 		/* OTP: 64B total; read 0x4B, write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ |
+				  FEATURE_DUAL_OUT | FEATURE_QUAD_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -6203,6 +6581,43 @@ const struct flashchip flashchips[] = {
 		.voltage	= {2700, 3600},
 	},
 
+	{
+		.vendor		= "Numonyx",
+		.name		= "N25Q256..3E", /* ..3E = 3V, uniform 64KB/4KB blocks/sectors */
+		.bustype	= BUS_SPI,
+		.manufacture_id = ST_ID,
+		.model_id	= ST_N25Q256__3E,
+		.total_size	= 32768,
+		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		/* supports SFDP */
+		/* OTP: 64B total; read 0x4B, write 0x42 */
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ |
+				  FEATURE_DUAL_OUT | FEATURE_QUAD_OUT | FEATURE_4BA_ENTER_WREN,
+		.tested		= TEST_UNTESTED,
+		.probe		= probe_spi_rdid,
+		.probe_timing	= TIMING_ZERO,
+		.block_erasers	=
+		{
+			{
+				.eraseblocks = { {4 * 1024, 8192 } },
+				.block_erase = spi_block_erase_20,
+			}, {
+				.eraseblocks = { {64 * 1024, 512} },
+				.block_erase = spi_block_erase_d8,
+			}, {
+				.eraseblocks = { {32 * 1024 * 1024, 1} },
+				.block_erase = spi_block_erase_c7,
+			}
+		},
+		.printlock	= spi_prettyprint_status_register_plain, /* TODO: improve */
+		.unlock		= spi_disable_blockprotect,
+		.write		= spi_chip_write_256,
+		.read		= spi_chip_read, /* Fast read (0x0B) and multi I/O supported */
+		.voltage	= {2700, 3600},
+	},
+
 	{
 		.vendor		= "PMC",
 		.name		= "Pm25LV010",
@@ -6211,6 +6626,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM25LV010,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -6243,6 +6660,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM25LV016B,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -6281,6 +6700,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM25LV020,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -6313,6 +6734,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM25LV040,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -6345,6 +6768,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM25LV080B,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -6383,6 +6808,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM25LV512,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -6415,6 +6842,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM29F002T,
 		.total_size	= 256,
 		.page_size	= 8 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -6447,6 +6875,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM29F002B,
 		.total_size	= 256,
 		.page_size	= 8 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -6479,6 +6908,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM39F010,	/* Pm39LV010 and Pm39F010 have identical IDs but different voltage */
 		.total_size	= 128,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -6509,6 +6939,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM39LV020,
 		.total_size	= 256,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -6539,6 +6970,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM39LV040,
 		.total_size	= 512,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_jedec,
@@ -6569,6 +7001,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM39LV512,
 		.total_size	= 64,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -6599,6 +7032,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM49FL002,
 		.total_size	= 256,
 		.page_size	= 16 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -6630,6 +7064,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= PMC_PM49FL004,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -6661,6 +7096,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SANYO_LE25FW203A,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -6688,6 +7125,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SHARP_LH28F008BJxxPB,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_82802ab,
 		.probe_timing	= TIMING_ZERO,
@@ -6718,6 +7156,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SHARP_LHF00L04,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET | FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -6751,6 +7190,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SPANSION_S25FL004A,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -6780,6 +7221,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SPANSION_S25FL008A,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_spi_rdid,
@@ -6809,6 +7252,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SPANSION_S25FL016A,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid,
@@ -6838,6 +7283,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SPANSION_S25FL032A,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid,
@@ -6867,6 +7314,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SPANSION_S25FL064A,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -6896,6 +7345,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF040_REMS,
 		.total_size	= 512,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_res2,
@@ -6928,6 +7378,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF080_REMS,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_res2,
@@ -6960,6 +7411,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF010_REMS,
 		.total_size	= 128,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rems,
@@ -6992,6 +7444,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF016B,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -7030,7 +7483,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF032B,
 		.total_size	= 4096,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_EWSR,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_EWSR | FEATURE_FAST_READ,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -7068,6 +7522,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF064C,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -7106,6 +7562,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF040_REMS,
 		.total_size	= 512,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rems,
@@ -7138,6 +7595,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF040B,
 		.total_size	= 512,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -7176,6 +7634,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF040B_REMS,
 		.total_size	= 512,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rems,
@@ -7214,6 +7673,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25VF080B,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_EWSR,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -7252,7 +7712,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25WF512,
 		.total_size	= 64,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_EITHER,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_EITHER | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -7286,7 +7747,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25WF010,
 		.total_size	= 128,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_EITHER,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_EITHER | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -7320,7 +7782,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25WF020,
 		.total_size	= 256,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_EITHER,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_EITHER | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -7357,7 +7820,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST25WF040,
 		.total_size	= 512,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_EITHER,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_EITHER | FEATURE_FAST_READ,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -7422,6 +7886,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST29EE010,
 		.total_size	= 128,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_jedec,
@@ -7446,6 +7911,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST29LE010,
 		.total_size	= 128,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -7470,6 +7936,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST29EE020A,
 		.total_size	= 256,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -7494,6 +7961,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST29LE020,
 		.total_size	= 256,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -7518,6 +7986,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39SF512,
 		.total_size	= 64,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7545,6 +8014,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39SF010,
 		.total_size	= 128,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7572,6 +8042,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39SF020,
 		.total_size	= 256,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7599,6 +8070,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39SF040,
 		.total_size	= 512,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7626,6 +8098,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39VF512,
 		.total_size	= 64,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7653,6 +8126,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39VF010,
 		.total_size	= 128,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7680,6 +8154,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39VF020,
 		.total_size	= 256,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -7707,6 +8182,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39VF040,
 		.total_size	= 512,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -7734,6 +8210,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST39VF080,
 		.total_size	= 1024,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -7764,6 +8241,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF002A,
 		.total_size	= 256,
 		.page_size	= 16 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7796,6 +8274,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF003A,
 		.total_size	= 384,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7831,6 +8310,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF004A,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7863,6 +8343,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF004C,
 		.total_size	= 512,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -7896,6 +8377,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF008A,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -7928,6 +8410,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF008C,
 		.total_size	= 1024,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -7961,6 +8444,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF016C,
 		.total_size	= 2048,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_82802ab,
@@ -7994,6 +8478,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF020,
 		.total_size	= 256,
 		.page_size	= 16 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -8024,6 +8509,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF020A,
 		.total_size	= 256,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -8054,6 +8540,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF040,
 		.total_size	= 512,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -8084,6 +8571,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET | FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -8115,6 +8603,7 @@ const struct flashchip flashchips[] = {
  		.model_id	= SST_SST49LF080A,
 		.total_size	= 1024,
 		.page_size	= 4096,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -8145,6 +8634,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SST_SST49LF160C,
 		.total_size	= 2048,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_82802ab,
@@ -8178,6 +8668,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P05A,
 		.total_size	= 64,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -8212,6 +8704,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P05_RES,
 		.total_size	= 64,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_res1,
@@ -8241,6 +8734,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P10A,
 		.total_size	= 128,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_spi_rdid,
@@ -8271,6 +8766,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P10_RES,
 		.total_size	= 128,
 		.page_size	= 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_res1,
@@ -8300,6 +8796,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P20,
 		.total_size	= 256,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
@@ -8329,6 +8827,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P40,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -8358,6 +8858,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P40_RES,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_res1,
@@ -8386,6 +8888,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -8415,6 +8919,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_spi_rdid,
@@ -8444,6 +8950,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -8473,6 +8981,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -8502,6 +9012,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25P128,
 		.total_size	= 16384,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
@@ -8531,6 +9043,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PX16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 64B total; read 0x4B; write 0x42 */
 		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
 		.tested		= TEST_OK_PREW,
@@ -8563,6 +9077,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PX32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_spi_rdid,
@@ -8595,6 +9111,8 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M25PX64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		.feature_bits	= FEATURE_WRSR_WREN,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_spi_rdid,
@@ -8626,6 +9144,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M29F002B,
 		.total_size	= 256,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_AAA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -8658,6 +9177,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M29F002T,
 		.total_size	= 256,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_AAA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -8690,6 +9210,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M29F040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -8782,6 +9303,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M29W010B,
 		.total_size	= 128,
 		.page_size	= 16 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -8809,6 +9331,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M29W040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -8836,6 +9359,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M29W512B,
 		.total_size	= 64,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_jedec,
@@ -8860,6 +9384,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FLW040A,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -8893,6 +9418,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FLW040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -8926,6 +9452,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FLW080A,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_82802ab,
@@ -8959,6 +9486,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FLW080B,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -8992,6 +9520,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FW002,
 		.total_size	= 256,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -9022,6 +9551,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FW016,
 		.total_size	= 2048,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -9047,6 +9577,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FW040,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_82802ab,
@@ -9072,6 +9603,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50FW080,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_82802ab,
@@ -9097,6 +9629,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= ST_M50LPW116,
 		.total_size	= 2048,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_82802ab,
@@ -9128,6 +9661,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C51001B,
 		.total_size	= 128,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9155,6 +9689,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C51001T,
 		.total_size	= 128,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9182,6 +9717,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C51002B,
 		.total_size	= 256,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9208,6 +9744,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C51002T,
 		.total_size	= 256,
 		.page_size	= 512,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -9234,6 +9771,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C51004B,
 		.total_size	= 512,
 		.page_size	= 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9261,6 +9799,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C51004T,
 		.total_size	= 512,
 		.page_size	= 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9288,6 +9827,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C31004B,
 		.total_size	= 512,
 		.page_size	= 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9315,6 +9855,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= SM_MVC_29C31004T,
 		.total_size	= 512,
 		.page_size	= 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9342,6 +9883,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= TI_TMS29F002RB,
 		.total_size	= 256,
 		.page_size	= 16384, /* Non-uniform sectors */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9374,6 +9916,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= TI_TMS29F002RT,
 		.total_size	= 256,
 		.page_size	= 16384, /* Non-uniform sectors */
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_ADDR_2AA | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9406,8 +9949,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25Q80,
 		.total_size	= 1024,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9445,8 +9990,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25Q16,
 		.total_size	= 2048,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9484,8 +10031,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25Q32,
 		.total_size	= 4096,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9523,8 +10072,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25Q64,
 		.total_size	= 8192,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9561,8 +10112,10 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25Q128,
 		.total_size	= 16384,
 		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
 		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
-		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PROBE,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9591,6 +10144,47 @@ const struct flashchip flashchips[] = {
 		.read		= spi_chip_read,
 	},
 
+	{
+		.vendor		= "Winbond",
+		.name		= "W25Q256",
+		.bustype	= BUS_SPI,
+		.manufacture_id	= WINBOND_NEX_ID,
+		.model_id	= WINBOND_NEX_W25Q256,
+		.total_size	= 32768,
+		.page_size	= 256,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		/* OTP: 1024B total, 256B reserved; read 0x48; write 0x42 */
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_OTP | FEATURE_FAST_READ | FEATURE_DUAL_OUT |
+				  FEATURE_4BA_ENTER,
+		.tested		= TEST_UNTESTED,
+		.probe		= probe_spi_rdid,
+		.probe_timing	= TIMING_ZERO,
+		.block_erasers	=
+		{
+			{
+				.eraseblocks = { {4 * 1024, 8192} },
+				.block_erase = spi_block_erase_20,
+			}, {
+				.eraseblocks = { {32 * 1024, 1024} },
+				.block_erase = spi_block_erase_52,
+			}, {
+				.eraseblocks = { {64 * 1024, 512} },
+				.block_erase = spi_block_erase_d8,
+			}, {
+				.eraseblocks = { {32 * 1024 * 1024, 1} },
+				.block_erase = spi_block_erase_60,
+			}, {
+				.eraseblocks = { {32 * 1024 * 1024, 1} },
+				.block_erase = spi_block_erase_c7,
+			}
+		},
+		.printlock	= spi_prettyprint_status_register_plain, /* TODO: improve */
+		.unlock		= spi_disable_blockprotect,
+		.write		= spi_chip_write_256,
+		.read		= spi_chip_read,
+	},
+
 	{
 		.vendor		= "Winbond",
 		.name		= "W25X10",
@@ -9599,7 +10193,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25X10,
 		.total_size	= 128,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9631,7 +10227,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25X20,
 		.total_size	= 256,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9663,7 +10261,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25X40,
 		.total_size	= 512,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9695,7 +10295,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25X80,
 		.total_size	= 1024,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9727,7 +10329,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25X16,
 		.total_size	= 2048,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9765,7 +10369,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25X32,
 		.total_size	= 4096,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PROBE,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9803,7 +10409,9 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_NEX_W25X64,
 		.total_size	= 8192,
 		.page_size	= 256,
-		.feature_bits	= FEATURE_WRSR_WREN,
+		.max_write_chunk = 256,
+		.gran		= write_gran_1bit,
+		.feature_bits	= FEATURE_WRSR_WREN | FEATURE_FAST_READ | FEATURE_DUAL_OUT,
 		.tested		= TEST_OK_PROBE,
 		.probe		= probe_spi_rdid,
 		.probe_timing	= TIMING_ZERO,
@@ -9841,6 +10449,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W29C010,
 		.total_size	= 128,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PRE,
 		.probe		= probe_w29ee011,
@@ -9864,6 +10473,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W29C010,
 		.total_size	= 128,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -9887,6 +10497,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W29C020,
 		.total_size	= 256,
 		.page_size	= 128,
+		.max_write_chunk = 128,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -9911,6 +10522,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W29C040,
 		.total_size	= 512,
 		.page_size	= 256,
+		.max_write_chunk = 256,
 		.feature_bits	= FEATURE_LONG_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9935,6 +10547,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39F010,
 		.total_size	= 128,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -9963,6 +10576,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39L010,
 		.total_size	= 128,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -9991,6 +10605,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39L020,
 		.total_size	= 256,
 		.page_size	= 4 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -10022,6 +10637,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39L040,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PR,
 		.probe		= probe_jedec,
@@ -10053,6 +10669,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V040A,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10081,6 +10698,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10109,6 +10727,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V040C,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10137,6 +10756,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V040FA,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10169,6 +10789,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V040B,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10198,6 +10819,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V040C,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10226,6 +10848,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V080A,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10254,6 +10877,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W49F002U,
 		.total_size	= 256,
 		.page_size	= 128,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10286,6 +10910,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W49F020,
 		.total_size	= 256,
 		.page_size	= 128,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PROBE,
 		.probe		= probe_jedec,
@@ -10310,6 +10935,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W49V002A,
 		.total_size	= 256,
 		.page_size	= 128,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10342,6 +10968,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W49V002FA,
 		.total_size	= 256,
 		.page_size	= 128,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10374,6 +11001,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V080FA,
 		.total_size	= 1024,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_OK_PREW,
 		.probe		= probe_jedec,
@@ -10403,6 +11031,7 @@ const struct flashchip flashchips[] = {
 		.model_id	= WINBOND_W39V080FA_DM,
 		.total_size	= 512,
 		.page_size	= 64 * 1024,
+		.gran		= write_gran_1byte,
 		.feature_bits	= FEATURE_REGISTERMAP | FEATURE_EITHER_RESET,
 		.tested		= TEST_UNTESTED,
 		.probe		= probe_jedec,
@@ -391,6 +391,8 @@
 #define MACRONIX_MX25L3205	0x2016	/* MX25L3205{,A} */
 #define MACRONIX_MX25L6405	0x2017	/* MX25L6405{,D}, MX25L6406E, MX25L6436E */
 #define MACRONIX_MX25L12805	0x2018	/* MX25L12805 */
+#define MACRONIX_MX25L25635F	0x2019	/* MX25L25635F, MX25L25735F */
+#define MACRONIX_MX66L51235F	0x201A	/* MX66L51235F */
 #define MACRONIX_MX25L1635D	0x2415
 #define MACRONIX_MX25L1635E	0x2515	/* MX25L1635{E} */
 #define MACRONIX_MX25L3235D	0x5E16	/* MX25L3225D/MX25L3235D/MX25L3237D */
@@ -601,6 +603,7 @@
 #define ST_N25Q032__1E		0xBB16		/* N25Q032, 1.8V, (uniform sectors expected) */
 #define ST_N25Q064__3E		0xBA17		/* N25Q064, 3.0V, (uniform sectors expected) */
 #define ST_N25Q064__1E		0xBB17		/* N25Q064, 1.8V, (uniform sectors expected) */
+#define ST_N25Q256__3E		0xBA19		/* N25Q256, 3.0V, (uniform sectors expected) */
 
 #define SYNCMOS_MVC_ID		0x40	/* SyncMOS (SM) and Mosel Vitelic Corporation (MVC) */
 #define MVC_V29C51000T		0x00
@@ -642,6 +645,7 @@
 #define WINBOND_NEX_W25Q32	0x4016
 #define WINBOND_NEX_W25Q64	0x4017
 #define WINBOND_NEX_W25Q128	0x4018
+#define WINBOND_NEX_W25Q256	0x4019
 
 #define WINBOND_ID		0xDA	/* Winbond */
 #define WINBOND_W19B160BB	0x49
@@ -36,6 +36,8 @@
 #endif
 #include "flash.h"
 #include "flashchips.h"
+#include "chipdrivers.h"
+#include "spi.h"
 #include "programmer.h"
 #include "hwaccess.h"
 
@@ -43,11 +45,20 @@ const char flashrom_version[] = FLASHROM_VERSION;
 const char *chip_to_probe = NULL;
 int verbose_screen = MSG_INFO;
 int verbose_logfile = MSG_DEBUG2;
+enum erase_verify_policy erase_verify_policy = ERASE_VERIFY_FULL;
+/* Verify the whole work area after writing instead of the touched blocks. */
+int verify_all = 0;
+int low_memory = 0;
 
 static enum programmer programmer = PROGRAMMER_INVALID;
 
 static const char *programmer_param = NULL;
 
+/* Programmer name and its full parameter string, see programmer_id(). */
+static char *programmer_ident = NULL;
+
+static void unmap_flash_windows(void);
+
 /*
  * Programmers supporting multiple buses can have differing size limits on
  * each bus. Store the limits for each bus in a common struct.
@@ -322,8 +333,6 @@ struct shutdown_func_data {
  */
 static int may_register_shutdown = 0;
 
-static int check_block_eraser(const struct flashctx *flash, int k, int log);
-
 /* Register a function to be executed on programmer shutdown.
  * The advantage over atexit() is that you can supply a void pointer which will
  * be used as parameter to the registered function upon programmer shutdown.
@@ -376,6 +385,16 @@ int programmer_init(enum programmer prog, const char *param)
 	programmer_may_write = 1;
 
 	programmer_param = param;
+	/* extract_param() consumes programmer_param, keep a copy. */
+	free(programmer_ident);
+	programmer_ident = malloc(strlen(programmer_table[programmer].name) +
+				  (param ? strlen(param) : 0) + 2);
+	if (!programmer_ident) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	sprintf(programmer_ident, "%s:%s", programmer_table[programmer].name,
+		param ? param : "");
 	msg_pdbg("Initializing %s programmer\n",
 		 programmer_table[programmer].name);
 	ret = programmer_table[programmer].init();
@@ -391,6 +410,9 @@ int programmer_shutdown(void)
 {
 	int ret = 0;
 
+	spi_poll_print_stats();
+	/* The programmer may need its resources to unmap. */
+	unmap_flash_windows();
 	/* Registering shutdown functions is no longer allowed. */
 	may_register_shutdown = 0;
 	while (shutdown_fn_count > 0) {
@@ -398,9 +420,17 @@ int programmer_shutdown(void)
 		ret |= shutdown_fn[i].func(shutdown_fn[i].data);
 	}
 	programmer_param = NULL;
+	free(programmer_ident);
+	programmer_ident = NULL;
 	return ret;
 }
 
+/* Identifies the programmer and its configuration, e.g. for cache keys. */
+const char *programmer_id(void)
+{
+	return programmer_ident ? programmer_ident : "";
+}
+
 void *programmer_map_flash_region(const char *descr, unsigned long phys_addr,
 				  size_t len)
 {
@@ -413,50 +443,127 @@ void programmer_unmap_flash_region(void *virt_addr, size_t len)
 	programmer_table[programmer].unmap_flash_region(virt_addr, len);
 }
 
+/* Flash windows mapped for probing. Most chips in flashchips[] share one of a
+ * few sizes, so every window is mapped once and kept until shutdown.
+ */
+struct flash_window {
+	struct flash_window *next;
+	unsigned long base;
+	size_t size;
+	void *virt;
+};
+
+static struct flash_window *flash_windows = NULL;
+
+static void *map_flash_window(unsigned long base, size_t size)
+{
+	struct flash_window *window;
+
+	for (window = flash_windows; window; window = window->next) {
+		if (window->base == base && window->size == size)
+			return window->virt;
+	}
+	window = malloc(sizeof(*window));
+	if (!window) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	window->base = base;
+	window->size = size;
+	window->virt = programmer_map_flash_region("flash chip", base, size);
+	window->next = flash_windows;
+	flash_windows = window;
+	return window->virt;
+}
+
+static void unmap_flash_windows(void)
+{
+	struct flash_window *window;
+
+	while (flash_windows) {
+		window = flash_windows;
+		flash_windows = window->next;
+		programmer_unmap_flash_region(window->virt, window->size);
+		free(window);
+	}
+}
+
+/* Counts bus accesses and delays, e.g. for the benchmark. */
+struct bus_stats bus_stats;
+
+static void count_access(size_t len)
+{
+	bus_stats.commands++;
+	bus_stats.calls++;
+	bus_stats.bytes += len;
+}
+
 void chip_writeb(const struct flashctx *flash, uint8_t val, chipaddr addr)
 {
+	count_access(1);
 	flash->pgm->par.chip_writeb(flash, val, addr);
 }
 
 void chip_writew(const struct flashctx *flash, uint16_t val, chipaddr addr)
 {
+	count_access(2);
 	flash->pgm->par.chip_writew(flash, val, addr);
 }
 
 void chip_writel(const struct flashctx *flash, uint32_t val, chipaddr addr)
 {
+	count_access(4);
 	flash->pgm->par.chip_writel(flash, val, addr);
 }
 
 void chip_writen(const struct flashctx *flash, uint8_t *buf, chipaddr addr,
 		 size_t len)
 {
+	count_access(len);
 	flash->pgm->par.chip_writen(flash, buf, addr, len);
 }
 
 uint8_t chip_readb(const struct flashctx *flash, const chipaddr addr)
 {
+	count_access(1);
 	return flash->pgm->par.chip_readb(flash, addr);
 }
 
 uint16_t chip_readw(const struct flashctx *flash, const chipaddr addr)
 {
+	count_access(2);
 	return flash->pgm->par.chip_readw(flash, addr);
 }
 
 uint32_t chip_readl(const struct flashctx *flash, const chipaddr addr)
 {
+	count_access(4);
 	return flash->pgm->par.chip_readl(flash, addr);
 }
 
 void chip_readn(const struct flashctx *flash, uint8_t *buf, chipaddr addr,
 		size_t len)
 {
+	count_access(len);
 	flash->pgm->par.chip_readn(flash, buf, addr, len);
 }
 
+/* Let the programmer wait for the chip, see struct par_programmer. Returns -1
+ * if it can't, the caller has to poll on its own then.
+ */
+int chip_poll(const struct flashctx *flash, enum par_poll_type type, chipaddr addr, uint8_t mask,
+	      uint8_t value, unsigned int timeout_us)
+{
+	if (!flash->pgm->par.poll)
+		return -1;
+	count_access(1);
+	return flash->pgm->par.poll(flash, type, addr, mask, value, timeout_us);
+}
+
 void programmer_delay(int usecs)
 {
+	if (usecs > 0)
+		bus_stats.delay_us += usecs;
 	programmer_table[programmer].delay(usecs);
 }
 
@@ -594,14 +701,15 @@ static unsigned int count_usable_erasers(const struct flashctx *flash)
 int compare_range(uint8_t *wantbuf, uint8_t *havebuf, unsigned int start, unsigned int len)
 {
 	int ret = 0, failcount = 0;
-	unsigned int i;
-	for (i = 0; i < len; i++) {
-		if (wantbuf[i] != havebuf[i]) {
-			/* Only print the first failure. */
-			if (!failcount++)
-				msg_cerr("FAILED at 0x%08x! Expected=0x%02x, Found=0x%02x,",
-					 start + i, wantbuf[i], havebuf[i]);
-		}
+	unsigned int i = memscan_first_diff(havebuf, wantbuf, len);
+
+	if (i < len)
+		msg_cerr("FAILED at 0x%08x! Expected=0x%02x, Found=0x%02x,",
+			 start + i, wantbuf[i], havebuf[i]);
+	while (i < len) {
+		failcount++;
+		i++;
+		i += memscan_first_diff(havebuf + i, wantbuf + i, len - i);
 	}
 	if (failcount) {
 		msg_cerr(" failed byte count from 0x%08x-0x%08x: 0x%x\n",
@@ -615,16 +723,49 @@ int compare_range(uint8_t *wantbuf, uint8_t *havebuf, unsigned int start, unsign
 int check_erased_range(struct flashctx *flash, unsigned int start,
 		       unsigned int len)
 {
-	int ret;
-	uint8_t *cmpbuf = malloc(len);
+	int ret, failcount = 0;
+	unsigned int i;
+	uint8_t *readbuf;
 
-	if (!cmpbuf) {
+	if (!len)
+		return 0;
+	if (!flash->chip->read) {
+		msg_cerr("ERROR: flashrom has no read function for this flash chip.\n");
+		return 1;
+	}
+	if (start + len > flash->chip->total_size * 1024) {
+		msg_gerr("Error: %s called with start 0x%x + len 0x%x >"
+			" total_size 0x%x\n", __func__, start, len,
+			flash->chip->total_size * 1024);
+		return -1;
+	}
+	readbuf = malloc(len);
+	if (!readbuf) {
 		msg_gerr("Could not allocate memory!\n");
 		exit(1);
 	}
-	memset(cmpbuf, 0xff, len);
-	ret = verify_range(flash, cmpbuf, start, len);
-	free(cmpbuf);
+	ret = flash->chip->read(flash, readbuf, start, len);
+	if (ret) {
+		msg_gerr("Verification impossible because read failed "
+			 "at 0x%x (len 0x%x)\n", start, len);
+		free(readbuf);
+		return ret;
+	}
+	i = memscan_first_not_erased(readbuf, len);
+	if (i < len)
+		msg_cerr("FAILED at 0x%08x! Expected=0xff, Found=0x%02x,",
+			 start + i, readbuf[i]);
+	while (i < len) {
+		failcount++;
+		i++;
+		i += memscan_first_not_erased(readbuf + i, len - i);
+	}
+	if (failcount) {
+		msg_cerr(" failed byte count from 0x%08x-0x%08x: 0x%x\n",
+			 start, start + len - 1, failcount);
+		ret = -1;
+	}
+	free(readbuf);
 	return ret;
 }
 
@@ -690,37 +831,26 @@ out_free:
 int need_erase(uint8_t *have, uint8_t *want, unsigned int len, enum write_granularity gran)
 {
 	int result = 0;
-	unsigned int i, j, limit;
+	unsigned int j, limit;
 
 	switch (gran) {
 	case write_gran_1bit:
-		for (i = 0; i < len; i++)
-			if ((have[i] & want[i]) != want[i]) {
-				result = 1;
-				break;
-			}
+		result = memscan_first_bit_conflict(have, want, len) < len;
 		break;
 	case write_gran_1byte:
-		for (i = 0; i < len; i++)
-			if ((have[i] != want[i]) && (have[i] != 0xff)) {
-				result = 1;
-				break;
-			}
+		result = memscan_first_byte_conflict(have, want, len) < len;
 		break;
 	case write_gran_256bytes:
 		for (j = 0; j < len / 256; j++) {
 			limit = min (256, len - j * 256);
 			/* Are 'have' and 'want' identical? */
-			if (!memcmp(have + j * 256, want + j * 256, limit))
+			if (memscan_first_diff(have + j * 256, want + j * 256, limit) == limit)
 				continue;
 			/* have needs to be in erased state. */
-			for (i = 0; i < limit; i++)
-				if (have[j * 256 + i] != 0xff) {
-					result = 1;
-					break;
-				}
-			if (result)
+			if (memscan_first_not_erased(have + j * 256, limit) < limit) {
+				result = 1;
 				break;
+			}
 		}
 		break;
 	default:
@@ -730,6 +860,26 @@ int need_erase(uint8_t *have, uint8_t *want, unsigned int len, enum write_granul
 	return result;
 }
 
+/* Only page programming SPI chips benefit from merging: each separate write
+ * costs a write enable, the command and address bytes, status polling and the
+ * round trip of the programmer. A merged write has to stay within one page and
+ * within the programmer's maximum write length to still be a single command.
+ * Chips with 256 byte granularity already write whole, adjacent pages in one
+ * go, and rewriting an unchanged page in between could program it twice.
+ */
+static void get_write_merge(struct flashctx *flash, struct write_merge *merge)
+{
+	memset(merge, 0, sizeof(*merge));
+	if (flash->chip->gran == write_gran_256bytes ||
+	    flash->chip->write != spi_chip_write_256 ||
+	    !(flash->pgm->buses_supported & BUS_SPI) ||
+	    flash->pgm->spi.write_256 == spi_chip_write_1)
+		return;
+	merge->max_gap = spi_get_write_overhead(flash);
+	merge->chunk = flash->chip->max_write_chunk;
+	merge->max_len = flash->pgm->spi.max_data_write;
+}
+
 /**
  * Check if the buffer @have needs to be programmed to get the content of @want.
  * If yes, return 1 and fill in first_start with the start address of the
@@ -746,20 +896,26 @@ int need_erase(uint8_t *have, uint8_t *want, unsigned int len, enum write_granul
  * @first_start	offset of the first byte which needs to be written (passed in
  *		value is increased by the offset of the first needed write
  *		relative to have/want or unchanged if no write is needed)
+ * @merge	coalescing policy, see get_write_merge()
+ * @addr	chip address of have[0], used for the page boundaries
  * @return	length of the first contiguous area which needs to be written
  *		0 if no write is needed
  *
- * FIXME: This function needs a parameter which tells it about coalescing
- * in relation to the max write length of the programmer and the max write
- * length of the chip.
+ * With byte or bit granularity, the area may contain short gaps of unchanged
+ * bytes if rewriting them is cheaper than starting another write command.
+ * @merge is ignored with 256 byte granularity.
+ * Gaps are only rewritten if that can't change anything: with bit granularity
+ * any byte can be rewritten with its current value, otherwise only erased
+ * bytes can.
  */
-static unsigned int get_next_write(uint8_t *have, uint8_t *want, unsigned int len,
-			  unsigned int *first_start,
-			  enum write_granularity gran)
+unsigned int get_next_write(uint8_t *have, uint8_t *want, unsigned int len,
+			    unsigned int *first_start,
+			    enum write_granularity gran,
+			    const struct write_merge *merge, unsigned int addr)
 {
 	int need_write = 0;
 	unsigned int rel_start = 0, first_len = 0;
-	unsigned int i, limit, stride;
+	unsigned int i, limit, stride, next, end, gap;
 
 	switch (gran) {
 	case write_gran_1bit:
@@ -777,21 +933,50 @@ static unsigned int get_next_write(uint8_t *have, uint8_t *want, unsigned int le
 		 */
 		return 0;
 	}
-	for (i = 0; i < len / stride; i++) {
-		limit = min(stride, len - i * stride);
-		/* Are 'have' and 'want' identical? */
-		if (memcmp(have + i * stride, want + i * stride, limit)) {
-			if (!need_write) {
-				/* First location where have and want differ. */
-				need_write = 1;
-				rel_start = i * stride;
-			}
-		} else {
-			if (need_write) {
-				/* First location where have and want
-				 * do not differ anymore.
-				 */
+	if (stride == 1) {
+		i = memscan_first_diff(have, want, len);
+		if (i < len) {
+			need_write = 1;
+			rel_start = i;
+			i += memscan_first_equal(have + i, want + i, len - i);
+		}
+		while (need_write && merge->max_gap && i < len) {
+			next = i + memscan_first_diff(have + i, want + i, len - i);
+			if (next == len)
+				break;
+			gap = next - i;
+			end = next + memscan_first_equal(have + next, want + next, len - next);
+			if (gap > merge->max_gap)
 				break;
+			if (merge->chunk && (addr + rel_start) / merge->chunk !=
+					    (addr + end - 1) / merge->chunk)
+				break;
+			if (merge->max_len && end - rel_start > merge->max_len)
+				break;
+			if (gran != write_gran_1bit &&
+			    memscan_first_not_erased(have + i, gap) < gap)
+				break;
+			i = end;
+		}
+	} else {
+		/* Skip the identical strides at the beginning in one go. */
+		i = memscan_first_diff(have, want, len / stride * stride) / stride;
+		for (; i < len / stride; i++) {
+			limit = min(stride, len - i * stride);
+			/* Are 'have' and 'want' identical? */
+			if (memscan_first_diff(have + i * stride, want + i * stride, limit) < limit) {
+				if (!need_write) {
+					/* First location where have and want differ. */
+					need_write = 1;
+					rel_start = i * stride;
+				}
+			} else {
+				if (need_write) {
+					/* First location where have and want
+					 * do not differ anymore.
+					 */
+					break;
+				}
 			}
 		}
 	}
@@ -986,50 +1171,395 @@ int check_max_decode(enum chipbustype buses, uint32_t size)
 	return 1;
 }
 
-int probe_flash(struct registered_programmer *pgm, int startchip, struct flashctx *flash, int force)
+/* Results of side effect free ID commands, valid for one probe_flash() pass.
+ * Most entries of flashchips[] share a handful of probe methods, without this
+ * cache the same ID command would go to the chip once per entry.
+ *
+ * Only these sequences are shared: SPI RDID, REMS, RES, AT25F RDID and SFDP
+ * reads, the JEDEC AA/55/90 ID entry with its F0 exit (per address mask,
+ * probe timing and reset type) and the 82802ab 90/FF ID read. A parallel
+ * probe which hits the cache still sends its reset sequence, since another
+ * ID entry may have been sent since. Every other command sent while probing
+ * flushes the cache.
+ */
+struct probe_cache_entry {
+	struct probe_cache_entry *next;
+	const char *method;
+	unsigned int keylen;
+	unsigned int datalen;
+	int ret;
+	uint8_t buf[];	/* Key followed by data. */
+};
+
+static struct probe_cache_entry *probe_cache = NULL;
+static int probe_caching = 0;
+/* Counts probe_cache_flush() calls, IDs read before the last one are stale. */
+static unsigned int probe_cache_generation = 0;
+
+/* Look up the result stored for @key of probe @method. Returns 1 and fills
+ * @data and @ret if there is one, 0 if the command has to be sent.
+ */
+int probe_cache_lookup(const char *method, const void *key, unsigned int keylen, void *data,
+		       unsigned int datalen, int *ret)
 {
-	const struct flashchip *chip;
-	unsigned long base = 0;
-	char location[64];
-	uint32_t size;
-	enum chipbustype buses_common;
-	char *tmp;
+	struct probe_cache_entry *entry;
 
-	for (chip = flashchips + startchip; chip && chip->name; chip++) {
-		if (chip_to_probe && strcmp(chip->name, chip_to_probe) != 0)
-			continue;
-		buses_common = pgm->buses_supported & chip->bustype;
-		if (!buses_common)
-			continue;
-		msg_gdbg("Probing for %s %s, %d kB: ", chip->vendor, chip->name, chip->total_size);
-		if (!chip->probe && !force) {
-			msg_gdbg("failed! flashrom has no probe function for this flash chip.\n");
+	if (!probe_caching)
+		return 0;
+	for (entry = probe_cache; entry; entry = entry->next) {
+		if (strcmp(entry->method, method) || entry->keylen != keylen ||
+		    entry->datalen != datalen || (keylen && memcmp(entry->buf, key, keylen)))
 			continue;
-		}
+		if (datalen)
+			memcpy(data, entry->buf + keylen, datalen);
+		*ret = entry->ret;
+		return 1;
+	}
+	return 0;
+}
+
+void probe_cache_store(const char *method, const void *key, unsigned int keylen,
+		       const void *data, unsigned int datalen, int ret)
+{
+	struct probe_cache_entry *entry;
+
+	if (!probe_caching)
+		return;
+	entry = malloc(sizeof(*entry) + keylen + datalen);
+	if (!entry) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	entry->method = method;
+	entry->keylen = keylen;
+	entry->datalen = datalen;
+	entry->ret = ret;
+	if (keylen)
+		memcpy(entry->buf, key, keylen);
+	if (datalen)
+		memcpy(entry->buf + keylen, data, datalen);
+	entry->next = probe_cache;
+	probe_cache = entry;
+}
+
+/* Forget all results, e.g. because a command changed the state of the chip. */
+void probe_cache_flush(void)
+{
+	struct probe_cache_entry *entry;
+
+	while (probe_cache) {
+		entry = probe_cache;
+		probe_cache = entry->next;
+		free(entry);
+	}
+	probe_cache_generation++;
+}
 
-		size = chip->total_size * 1024;
-		check_max_decode(buses_common, size);
+/* Probe methods which read IDs with one command and match the chips with
+ * exactly these IDs, or chips with generic IDs. probe_flash() reads the IDs
+ * once and only probes the matching chips of the index.
+ */
+static const struct {
+	int (*probe)(struct flashctx *flash);
+	int (*read_ids)(struct flashctx *flash, uint32_t *id1, uint32_t *id2);
+} probe_id_methods[] = {
+	{ probe_spi_rdid,	probe_spi_rdid_ids },
+	{ probe_spi_rdid4,	probe_spi_rdid4_ids },
+	{ probe_spi_rems,	probe_spi_rems_ids },
+};
+#define PROBE_ID_METHODS	ARRAY_SIZE(probe_id_methods)
+
+/* flashchips[] positions sorted by manufacturer and model ID, built on first
+ * use by build_chip_index().
+ */
+static int *chip_index = NULL;
+static int chip_index_len = 0;
+/* chip_next[m][i] is the first position from i on with a chip probed by ID
+ * method m, chip_next[PROBE_ID_METHODS][i] the first one probed otherwise.
+ * Chips with generic IDs count as probed otherwise. chip_index_len if none.
+ */
+static int *chip_next[PROBE_ID_METHODS + 1];
+
+static int compare_chip_ids(const void *a, const void *b)
+{
+	const struct flashchip *chip_a = &flashchips[*(const int *)a];
+	const struct flashchip *chip_b = &flashchips[*(const int *)b];
+
+	if (chip_a->manufacture_id != chip_b->manufacture_id)
+		return chip_a->manufacture_id < chip_b->manufacture_id ? -1 : 1;
+	if (chip_a->model_id != chip_b->model_id)
+		return chip_a->model_id < chip_b->model_id ? -1 : 1;
+	/* Chips with the same IDs stay in table order. */
+	return *(const int *)a - *(const int *)b;
+}
 
-		/* Start filling in the dynamic data. */
-		flash->chip = calloc(1, sizeof(struct flashchip));
-		if (!flash->chip) {
+/* The probe_id_methods[] entry used for @chip, -1 if none. */
+static int chip_id_method(const struct flashchip *chip)
+{
+	unsigned int m;
+
+	if (chip->manufacture_id == GENERIC_MANUF_ID || chip->model_id == GENERIC_DEVICE_ID)
+		return -1;
+	for (m = 0; m < PROBE_ID_METHODS; m++) {
+		if (chip->probe == probe_id_methods[m].probe)
+			return m;
+	}
+	return -1;
+}
+
+static void build_chip_index(void)
+{
+	unsigned int m;
+	int n, method;
+
+	if (chip_index)
+		return;
+	while (flashchips[chip_index_len].name)
+		chip_index_len++;
+	chip_index = malloc(chip_index_len * sizeof(*chip_index));
+	if (!chip_index) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	for (m = 0; m <= PROBE_ID_METHODS; m++) {
+		chip_next[m] = malloc((chip_index_len + 1) * sizeof(*chip_next[m]));
+		if (!chip_next[m]) {
 			msg_gerr("Out of memory!\n");
 			exit(1);
 		}
-		memcpy(flash->chip, chip, sizeof(struct flashchip));
-		flash->pgm = pgm;
+	}
+	for (n = 0; n < chip_index_len; n++)
+		chip_index[n] = n;
+	qsort(chip_index, chip_index_len, sizeof(*chip_index), compare_chip_ids);
 
-		base = flashbase ? flashbase : (0xffffffff - size + 1);
-		flash->virtual_memory = (chipaddr)programmer_map_flash_region("flash chip", base, size);
+	for (m = 0; m <= PROBE_ID_METHODS; m++)
+		chip_next[m][chip_index_len] = chip_index_len;
+	for (n = chip_index_len - 1; n >= 0; n--) {
+		method = chip_id_method(&flashchips[n]);
+		if (method < 0)
+			method = PROBE_ID_METHODS;
+		for (m = 0; m <= PROBE_ID_METHODS; m++)
+			chip_next[m][n] = m == method ? n : chip_next[m][n + 1];
+	}
+}
 
-		/* We handle a forced match like a real match, we just avoid probing. Note that probe_flash()
-		 * is only called with force=1 after normal probing failed.
-		 */
-		if (force)
+/* Find the flashchips[] entries with the given IDs. Returns their number and
+ * points @first to their positions in flashchips[], in table order.
+ */
+static int find_chips_by_id(uint32_t manufacture_id, uint32_t model_id, const int **first)
+{
+	const struct flashchip *chip;
+	int lo, hi, mid, n;
+
+	build_chip_index();
+
+	/* Find the first entry which is not smaller. */
+	lo = 0;
+	hi = chip_index_len;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		chip = &flashchips[chip_index[mid]];
+		if (chip->manufacture_id < manufacture_id ||
+		    (chip->manufacture_id == manufacture_id && chip->model_id < model_id))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (n = 0; lo + n < chip_index_len; n++) {
+		chip = &flashchips[chip_index[lo + n]];
+		if (chip->manufacture_id != manufacture_id || chip->model_id != model_id)
 			break;
+	}
+	*first = chip_index + lo;
+	return n;
+}
+
+/* Map @chip and run its probe function, with @scratch as the chip of @flash.
+ * Returns 1 if the chip answered (or @force is set), 0 otherwise.
+ */
+static int probe_candidate(struct registered_programmer *pgm, const struct flashchip *chip,
+			   struct flashctx *flash, struct flashchip *scratch, int force)
+{
+	enum chipbustype buses_common;
+	unsigned long base;
+	uint32_t size;
+
+	buses_common = pgm->buses_supported & chip->bustype;
+	if (!buses_common)
+		return 0;
+	msg_gdbg("Probing for %s %s, %d kB: ", chip->vendor, chip->name, chip->total_size);
+	if (!chip->probe && !force) {
+		msg_gdbg("failed! flashrom has no probe function for this flash chip.\n");
+		return 0;
+	}
+
+	size = chip->total_size * 1024;
+	check_max_decode(buses_common, size);
+
+	/* Start filling in the dynamic data. Probe functions may modify
+	 * the chip, a copy of its own is only needed after a match.
+	 */
+	memcpy(scratch, chip, sizeof(struct flashchip));
+	flash->chip = scratch;
+	flash->pgm = pgm;
+
+	base = flashbase ? flashbase : (0xffffffff - size + 1);
+	flash->virtual_memory = (chipaddr)map_flash_window(base, size);
+
+	/* We handle a forced match like a real match, we just avoid probing. Note that probe_flash()
+	 * is only called with force=1 after normal probing failed.
+	 */
+	if (force)
+		return 1;
+
+	if (flash->chip->probe(flash) == 1)
+		return 1;
+
+	flash->virtual_memory = (chipaddr)NULL;
+	flash->chip = NULL;
+	return 0;
+}
+
+/* Give @flash its own copy of the matching chip in @scratch and report it. */
+static int probe_found(const struct flashchip *chip, struct flashctx *flash,
+		       const struct flashchip *scratch, int force)
+{
+	char location[64];
+	char *tmp;
+
+	flash->chip = malloc(sizeof(struct flashchip));
+	if (!flash->chip) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	memcpy(flash->chip, scratch, sizeof(struct flashchip));
+
+#if CONFIG_INTERNAL == 1
+	if (programmer_table[programmer].map_flash_region == physmap)
+		snprintf(location, sizeof(location), "at physical address 0x%lx",
+			 flashbase ? flashbase : (0xffffffff - flash->chip->total_size * 1024 + 1));
+	else
+#endif
+		snprintf(location, sizeof(location), "on %s", programmer_table[programmer].name);
+
+	tmp = flashbuses_to_text(flash->chip->bustype);
+	msg_cinfo("%s %s flash chip \"%s\" (%d kB, %s) %s.\n", force ? "Assuming" : "Found",
+		  flash->chip->vendor, flash->chip->name, flash->chip->total_size, tmp, location);
+	free(tmp);
+
+	/* Flash registers will not be mapped if the chip was forced. Lock info
+	 * may be stored in registers, so avoid lock info printing.
+	 */
+	if (!force)
+		if (flash->chip->printlock)
+			flash->chip->printlock(flash);
+
+	/* Return position of matching chip. */
+	return chip - flashchips;
+}
+
+/* Free a chip copy made by probe_flash() with the data its probe attached. */
+void free_chip_copy(struct flashchip *chip)
+{
+	if (!chip)
+		return;
+	free((struct sfdp_params *)chip->sfdp);
+	free(chip);
+}
+
+/* What one of the probe_id_methods[] read during a probe_flash() pass. */
+struct probe_id_state {
+	int read;
+	unsigned int generation;
+	/* Chips with the IDs read, from the index */
+	const int *candidates;
+	int count;
+};
+
+/* Read the IDs of method @m with the chip at @pos, the first one using it. */
+static void probe_read_ids(struct registered_programmer *pgm, struct flashctx *flash,
+			   struct flashchip *scratch, struct probe_id_state *ids, unsigned int m,
+			   int pos)
+{
+	const struct flashchip *chip = &flashchips[pos];
+	uint32_t id1, id2;
+
+	ids->read = 1;
+	ids->generation = probe_cache_generation;
+	ids->count = 0;
+	if (!(pgm->buses_supported & chip->bustype))
+		return;
+	memcpy(scratch, chip, sizeof(struct flashchip));
+	flash->chip = scratch;
+	flash->pgm = pgm;
+	if (!probe_id_methods[m].read_ids(flash, &id1, &id2))
+		ids->count = find_chips_by_id(id1, id2, &ids->candidates);
+	flash->chip = NULL;
+}
+
+/* The position of the next chip from @pos on which can match, in table order.
+ * Chips of the probe_id_methods[] are only probed if they have the IDs read
+ * for their method. These are read when the walk reaches the first chip of
+ * the method, and again after the probe cache was flushed.
+ */
+static int probe_next_chip(struct registered_programmer *pgm, struct flashctx *flash,
+			   struct flashchip *scratch, struct probe_id_state *ids, int pos, int force)
+{
+	const int *cand;
+	unsigned int m;
+	int next, event;
+
+	build_chip_index();
+	/* A forced or named chip is searched for by name. */
+	if (chip_to_probe || force)
+		return pos;
+	while (pos < chip_index_len) {
+		next = chip_next[PROBE_ID_METHODS][pos];
+		event = -1;
+		for (m = 0; m < PROBE_ID_METHODS; m++) {
+			if (!ids[m].read || ids[m].generation != probe_cache_generation) {
+				if (chip_next[m][pos] < next) {
+					next = chip_next[m][pos];
+					event = m;
+				}
+				continue;
+			}
+			cand = ids[m].candidates;
+			while (ids[m].count && (*cand < pos ||
+			       flashchips[*cand].probe != probe_id_methods[m].probe)) {
+				cand = ++ids[m].candidates;
+				ids[m].count--;
+			}
+			if (ids[m].count && *cand < next) {
+				next = *cand;
+				event = -1;
+			}
+		}
+		if (event < 0)
+			return next;
+		probe_read_ids(pgm, flash, scratch, &ids[event], event, next);
+	}
+	return chip_index_len;
+}
 
-		if (flash->chip->probe(flash) != 1)
-			goto notfound;
+int probe_flash(struct registered_programmer *pgm, int startchip, struct flashctx *flash, int force)
+{
+	struct probe_id_state ids[PROBE_ID_METHODS] = {{ 0 }};
+	const struct flashchip *chip = NULL;
+	struct flashchip scratch;
+	int pos;
+
+	probe_caching = 1;
+	for (pos = probe_next_chip(pgm, flash, &scratch, ids, startchip, force);
+	     pos < chip_index_len;
+	     pos = probe_next_chip(pgm, flash, &scratch, ids, pos + 1, force)) {
+		chip = &flashchips[pos];
+		if (chip_to_probe && strcmp(chip->name, chip_to_probe) != 0)
+			continue;
+		if (!probe_candidate(pgm, chip, flash, &scratch, force))
+			continue;
+		if (force)
+			break;
 
 		/* If this is the first chip found, accept it.
 		 * If this is not the first chip found, accept it only if it is
@@ -1068,63 +1598,104 @@ int probe_flash(struct registered_programmer *pgm, int startchip, struct flashct
 		if ((flash->chip->model_id != GENERIC_DEVICE_ID) && (flash->chip->model_id != SFDP_DEVICE_ID))
 			break;
 		/* Not the first flash chip detected on this bus, and it's just a generic match. Ignore it. */
-notfound:
-		programmer_unmap_flash_region((void *)flash->virtual_memory, size);
+		free((struct sfdp_params *)scratch.sfdp);
 		flash->virtual_memory = (chipaddr)NULL;
-		free(flash->chip);
 		flash->chip = NULL;
 	}
+	probe_cache_flush();
+	probe_caching = 0;
 
 	if (!flash->chip)
 		return -1;
+	return probe_found(chip, flash, &scratch, force);
+}
 
-#if CONFIG_INTERNAL == 1
-	if (programmer_table[programmer].map_flash_region == physmap)
-		snprintf(location, sizeof(location), "at physical address 0x%lx", base);
-	else
-#endif
-		snprintf(location, sizeof(location), "on %s", programmer_table[programmer].name);
+/* Probe only the chips with the given IDs, e.g. the chip found by an earlier
+ * run. Generic matches are not accepted. Returns like probe_flash().
+ */
+int probe_flash_by_id(struct registered_programmer *pgm, uint32_t manufacture_id, uint32_t model_id,
+		      struct flashctx *flash)
+{
+	const struct flashchip *chip = NULL;
+	struct flashchip scratch;
+	const int *candidates;
+	int i, n;
 
-	tmp = flashbuses_to_text(flash->chip->bustype);
-	msg_cinfo("%s %s flash chip \"%s\" (%d kB, %s) %s.\n", force ? "Assuming" : "Found",
-		  flash->chip->vendor, flash->chip->name, flash->chip->total_size, tmp, location);
-	free(tmp);
+	if (manufacture_id == GENERIC_MANUF_ID || model_id == GENERIC_DEVICE_ID ||
+	    model_id == SFDP_DEVICE_ID)
+		return -1;
+	n = find_chips_by_id(manufacture_id, model_id, &candidates);
+	probe_caching = 1;
+	for (i = 0; i < n; i++) {
+		chip = &flashchips[candidates[i]];
+		if (probe_candidate(pgm, chip, flash, &scratch, 0))
+			break;
+	}
+	probe_cache_flush();
+	probe_caching = 0;
 
-	/* Flash registers will not be mapped if the chip was forced. Lock info
-	 * may be stored in registers, so avoid lock info printing.
-	 */
-	if (!force)
-		if (flash->chip->printlock)
-			flash->chip->printlock(flash);
+	if (i == n)
+		return -1;
+	return probe_found(chip, flash, &scratch, 0);
+}
 
-	/* Return position of matching chip. */
-	return chip - flashchips;
+static int close_image(FILE *image)
+{
+	if (image == stdin)
+		return 0;
+	return fclose(image);
 }
 
-int read_buf_from_file(unsigned char *buf, unsigned long size,
-		       const char *filename)
+/* Opens the image @filename for reading, "-" is standard input. Regular files
+ * must have exactly @size bytes, for pipes this is checked by image_at_end().
+ */
+static FILE *open_image(const char *filename, unsigned long size)
 {
-	unsigned long numbytes;
 	FILE *image;
 	struct stat image_stat;
 
-	if ((image = fopen(filename, "rb")) == NULL) {
+	if (!strcmp(filename, "-")) {
+		image = stdin;
+	} else if ((image = fopen(filename, "rb")) == NULL) {
 		perror(filename);
-		return 1;
+		return NULL;
 	}
 	if (fstat(fileno(image), &image_stat) != 0) {
 		perror(filename);
-		fclose(image);
-		return 1;
+		close_image(image);
+		return NULL;
 	}
-	if (image_stat.st_size != size) {
+	if (S_ISREG(image_stat.st_mode) && image_stat.st_size != size) {
 		msg_gerr("Error: Image size (%ld B) doesn't match the flash chip's size (%ld B)!\n",
-			 image_stat.st_size, size);
-		fclose(image);
-		return 1;
+			 (long)image_stat.st_size, size);
+		close_image(image);
+		return NULL;
 	}
+	return image;
+}
+
+/* Returns 1 if all of @image has been read, i.e. it is not too large. */
+static int image_at_end(FILE *image)
+{
+	if (fgetc(image) == EOF)
+		return 1;
+	msg_gerr("Error: Image is larger than the flash chip!\n");
+	return 0;
+}
+
+int read_buf_from_file(unsigned char *buf, unsigned long size,
+		       const char *filename)
+{
+	unsigned long numbytes;
+	FILE *image;
+	int at_end;
+
+	image = open_image(filename, size);
+	if (!image)
+		return 1;
 	numbytes = fread(buf, 1, size, image);
-	if (fclose(image)) {
+	at_end = numbytes == size && image_at_end(image);
+	if (close_image(image)) {
 		perror(filename);
 		return 1;
 	}
@@ -1133,7 +1704,7 @@ int read_buf_from_file(unsigned char *buf, unsigned long size,
 			 "wanted %ld!\n", numbytes, size);
 		return 1;
 	}
-	return 0;
+	return !at_end;
 }
 
 int write_buf_to_file(unsigned char *buf, unsigned long size,
@@ -1161,13 +1732,25 @@ int write_buf_to_file(unsigned char *buf, unsigned long size,
 	return 0;
 }
 
+/* The chip is read and written to the file in chunks of this size. */
+#define READ_CHUNK_SIZE		(64 * 1024)
+
+/* Read the chip to @filename, "-" is standard output. Each chunk is written
+ * as soon as it was read, so the file (or a pipe) fills while the chip is
+ * still being read.
+ */
 int read_flash_to_file(struct flashctx *flash, const char *filename)
 {
 	unsigned long size = flash->chip->total_size * 1024;
-	unsigned char *buf = calloc(size, sizeof(char));
+	unsigned int start, len;
+	unsigned char *buf, *chunk;
+	/* The cache needs the whole image. */
+	int whole = cache_active();
+	FILE *image;
 	int ret = 0;
 
 	msg_cinfo("Reading flash... ");
+	buf = malloc(whole ? size : min(size, READ_CHUNK_SIZE));
 	if (!buf) {
 		msg_gerr("Memory allocation failed!\n");
 		msg_cinfo("FAILED.\n");
@@ -1178,13 +1761,40 @@ int read_flash_to_file(struct flashctx *flash, const char *filename)
 		ret = 1;
 		goto out_free;
 	}
-	if (flash->chip->read(flash, buf, 0, size)) {
-		msg_cerr("Read operation failed!\n");
+	if (!strcmp(filename, "-")) {
+		image = stdout;
+	} else if ((image = fopen(filename, "wb")) == NULL) {
+		perror(filename);
 		ret = 1;
 		goto out_free;
 	}
 
-	ret = write_buf_to_file(buf, size, filename);
+	for (start = 0; start < size; start += len) {
+		len = min(READ_CHUNK_SIZE, size - start);
+		chunk = whole ? buf + start : buf;
+		if (flash->chip->read(flash, chunk, start, len)) {
+			msg_cerr("Read operation failed!\n");
+			ret = 1;
+			break;
+		}
+		if (fwrite(chunk, 1, len, image) != len || fflush(image)) {
+			msg_gerr("File %s could not be written completely.\n",
+				 filename);
+			ret = 1;
+			break;
+		}
+	}
+	if (image != stdout) {
+		if (fclose(image)) {
+			perror(filename);
+			ret = 1;
+		}
+		/* Don't leave a truncated image behind. */
+		if (ret)
+			remove(filename);
+	}
+	if (!ret && whole)
+		cache_store_image(flash, buf);
 out_free:
 	free(buf);
 	msg_cinfo("%s.\n", ret ? "FAILED" : "done");
@@ -1195,7 +1805,7 @@ out_free:
  * walk_eraseregions().
  * Even if an error is found, the function will keep going and check the rest.
  */
-static int selfcheck_eraseblocks(const struct flashchip *chip)
+int selfcheck_eraseblocks(const struct flashchip *chip)
 {
 	int i, j, k;
 	int ret = 0;
@@ -1260,31 +1870,270 @@ static int selfcheck_eraseblocks(const struct flashchip *chip)
 	return ret;
 }
 
-static int erase_and_write_block_helper(struct flashctx *flash,
-					unsigned int start, unsigned int len,
-					uint8_t *curcontents,
-					uint8_t *newcontents,
-					int (*erasefn) (struct flashctx *flash,
-							unsigned int addr,
-							unsigned int len))
+/* Returns the number of eraseblocks of erase function @k. */
+unsigned int count_eraseblocks(const struct flashctx *flash, int k)
+{
+	const struct block_eraser *eraser = &flash->chip->block_erasers[k];
+	unsigned int count = 0;
+	int i;
+
+	for (i = 0; i < NUM_ERASEREGIONS; i++)
+		count += eraser->eraseblocks[i].count;
+	return count;
+}
+
+/* Returns the usable erase function with the smallest blocks or -1 if there is
+ * none. Its blocks define the granularity of the work area below.
+ */
+static int finest_eraser(const struct flashctx *flash)
+{
+	unsigned int count, best_count = 0;
+	int k, best = -1;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS; k++) {
+		if (check_block_eraser(flash, k, 0))
+			continue;
+		count = count_eraseblocks(flash, k);
+		if (count > best_count) {
+			best_count = count;
+			best = k;
+		}
+	}
+	return best;
+}
+
+/* The work area of a write is the set of the finest eraseblocks which overlap
+ * an included layout region. Only the work area is read, erased, written and
+ * verified, everything else is preserved and never touched. Without layout
+ * restrictions the work area covers the whole chip.
+ *
+ * Calls @fn for each contiguous run of blocks in the work area which lies
+ * inside [base, base + size - 1] and stops at the first error.
+ */
+static int walk_work_range(struct flashctx *flash, unsigned int base, unsigned int size,
+			   int (*fn) (struct flashctx *flash, unsigned int start,
+				      unsigned int len, void *data),
+			   void *data)
+{
+	const struct block_eraser *eraser;
+	unsigned int start = 0, runstart = 0, runlen = 0, len, from, to;
+	int i, j, k, ret;
+
+	k = finest_eraser(flash);
+	if (k < 0)
+		return fn(flash, base, size, data);
+	eraser = &flash->chip->block_erasers[k];
+	for (i = 0; i < NUM_ERASEREGIONS; i++) {
+		len = eraser->eraseblocks[i].size;
+		for (j = 0; j < eraser->eraseblocks[i].count; j++) {
+			/* Clip the block to the range. */
+			from = max(start, base);
+			to = min(start + len, base + size);
+			if (from < to && included_regions_overlap(start, start + len - 1)) {
+				if (!runlen)
+					runstart = from;
+				runlen += to - from;
+			} else if (runlen) {
+				ret = fn(flash, runstart, runlen, data);
+				if (ret)
+					return ret;
+				runlen = 0;
+			}
+			start += len;
+		}
+	}
+	if (runlen)
+		return fn(flash, runstart, runlen, data);
+	return 0;
+}
+
+static int walk_work_area(struct flashctx *flash,
+			  int (*fn) (struct flashctx *flash, unsigned int start,
+				     unsigned int len, void *data),
+			  void *data)
+{
+	return walk_work_range(flash, 0, flash->chip->total_size * 1024, fn, data);
+}
+
+/* Returns 1 if [start, start + len - 1] lies completely inside the work area. */
+int in_work_area(const struct flashctx *flash, unsigned int start, unsigned int len)
+{
+	const struct block_eraser *eraser;
+	unsigned int blockstart = 0, blocklen;
+	int i, j, k;
+
+	k = finest_eraser(flash);
+	if (k < 0)
+		return 1;
+	eraser = &flash->chip->block_erasers[k];
+	for (i = 0; i < NUM_ERASEREGIONS; i++) {
+		blocklen = eraser->eraseblocks[i].size;
+		for (j = 0; j < eraser->eraseblocks[i].count; j++) {
+			if (blockstart < start + len && blockstart + blocklen > start &&
+			    !included_regions_overlap(blockstart, blockstart + blocklen - 1))
+				return 0;
+			blockstart += blocklen;
+		}
+	}
+	return 1;
+}
+
+static int read_work_area_fn(struct flashctx *flash, unsigned int start,
+			     unsigned int len, void *buf)
+{
+	msg_cdbg2("Reading 0x%06x-0x%06x\n", start, start + len - 1);
+	return flash->chip->read(flash, (uint8_t *)buf + start, start, len);
+}
+
+/* Read the work area of the chip into @buf. Bytes outside are left alone. */
+static int read_work_area(struct flashctx *flash, uint8_t *buf)
+{
+	return walk_work_area(flash, read_work_area_fn, buf);
+}
+
+static int verify_work_area_fn(struct flashctx *flash, unsigned int start,
+			       unsigned int len, void *buf)
+{
+	return verify_range(flash, (uint8_t *)buf + start, start, len);
+}
+
+/* Blocks which were erased or written since the last reset_touched(). */
+static struct touched_range {
+	unsigned int start;
+	unsigned int end;
+} *touched = NULL;
+static unsigned int touched_count = 0, touched_alloc = 0;
+
+static void reset_touched(void)
+{
+	free(touched);
+	touched = NULL;
+	touched_count = touched_alloc = 0;
+}
+
+static void mark_touched(unsigned int start, unsigned int len)
+{
+	struct touched_range *last = touched_count ? &touched[touched_count - 1] : NULL;
+
+	/* Blocks are usually handled in ascending order. */
+	if (last && start >= last->start && start <= last->end + 1) {
+		last->end = max(last->end, start + len - 1);
+		return;
+	}
+	if (touched_count == touched_alloc) {
+		touched_alloc = touched_alloc ? touched_alloc * 2 : 64;
+		touched = realloc(touched, touched_alloc * sizeof(struct touched_range));
+		if (!touched) {
+			msg_gerr("Out of memory!\n");
+			exit(1);
+		}
+	}
+	touched[touched_count].start = start;
+	touched[touched_count].end = start + len - 1;
+	touched_count++;
+}
+
+static int compare_touched(const void *a, const void *b)
+{
+	const struct touched_range *ra = a, *rb = b;
+
+	return (ra->start > rb->start) - (ra->start < rb->start);
+}
+
+/* Verify all touched blocks against @newcontents, each byte only once.
+ * @newcontents holds the chip contents starting at @base.
+ */
+static int verify_touched(struct flashctx *flash, uint8_t *newcontents, unsigned int base)
+{
+	unsigned int i, start, end;
+	int ret = 0;
+
+	qsort(touched, touched_count, sizeof(struct touched_range), compare_touched);
+	for (i = 0; i < touched_count && !ret; ) {
+		start = touched[i].start;
+		end = touched[i].end;
+		for (i++; i < touched_count && touched[i].start <= end + 1; i++)
+			end = max(end, touched[i].end);
+		msg_cdbg2("Verifying 0x%06x-0x%06x\n", start, end);
+		ret = verify_range(flash, newcontents + start - base, start, end - start + 1);
+	}
+	return ret;
+}
+
+/* Whether chips erased with @erasefn report failed erases in a status
+ * register, which is what ERASE_VERIFY_STATUS checks. SPI chips only report
+ * being busy, and the erase functions already wait for that.
+ */
+static int erase_has_status(int (*erasefn) (struct flashctx *flash, unsigned int addr,
+					    unsigned int len))
+{
+	return erasefn == erase_block_82802ab || erasefn == erase_sector_49lfxxxc;
+}
+
+/* Whether any erase function of the chip works with ERASE_VERIFY_STATUS. */
+static int erase_status_usable(const struct flashctx *flash)
+{
+	int k;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS; k++)
+		if (erase_has_status(flash->chip->block_erasers[k].block_erase))
+			return 1;
+	return 0;
+}
+
+/* Check an erased block according to @policy. Without a status to check,
+ * ERASE_VERIFY_STATUS reads the block back like ERASE_VERIFY_FULL.
+ */
+static int check_erase(struct flashctx *flash, unsigned int start, unsigned int len,
+		       int (*erasefn) (struct flashctx *flash, unsigned int addr,
+				       unsigned int len),
+		       enum erase_verify_policy policy)
+{
+	switch (policy) {
+	case ERASE_VERIFY_DEFERRED:
+		return 0;
+	case ERASE_VERIFY_STATUS:
+		if (erase_has_status(erasefn))
+			return erase_failed_82802ab(flash) ? -1 : 0;
+		/* Fall through. */
+	default:
+		return check_erased_range(flash, start, len);
+	}
+}
+
+/* Erase and write the block at @start. @curcontents and @newcontents point to
+ * the current and the wanted contents of the block itself. Erases are checked
+ * according to @policy.
+ */
+int erase_and_write_block(struct flashctx *flash,
+			  unsigned int start, unsigned int len,
+			  uint8_t *curcontents,
+			  uint8_t *newcontents,
+			  int (*erasefn) (struct flashctx *flash,
+					  unsigned int addr,
+					  unsigned int len),
+			  enum erase_verify_policy policy)
 {
 	unsigned int starthere = 0, lenhere = 0;
 	int ret = 0, skip = 1, writecount = 0;
-	enum write_granularity gran = write_gran_256bytes; /* FIXME */
+	enum write_granularity gran = flash->chip->gran;
+	struct write_merge merge;
 
-	/* curcontents and newcontents are opaque to walk_eraseregions, and
-	 * need to be adjusted here to keep the impression of proper abstraction
-	 */
-	curcontents += start;
-	newcontents += start;
 	msg_cdbg(":");
-	/* FIXME: Assume 256 byte granularity for now to play it safe. */
 	if (need_erase(curcontents, newcontents, len, gran)) {
+		/* Parts of this block were not read, don't destroy them. */
+		if (!in_work_area(flash, start, len)) {
+			msg_cerr("Block 0x%06x-0x%06x extends beyond the "
+				 "included regions, not erasing it.\n",
+				 start, start + len - 1);
+			return -1;
+		}
 		msg_cdbg("E");
+		mark_touched(start, len);
 		ret = erasefn(flash, start, len);
 		if (ret)
 			return ret;
-		if (check_erased_range(flash, start, len)) {
+		if (check_erase(flash, start, len, erasefn, policy)) {
 			msg_cerr("ERASE FAILED!\n");
 			return -1;
 		}
@@ -1292,12 +2141,16 @@ static int erase_and_write_block_helper(struct flashctx *flash,
 		memset(curcontents, 0xff, len);
 		skip = 0;
 	}
+	get_write_merge(flash, &merge);
 	/* get_next_write() sets starthere to a new value after the call. */
 	while ((lenhere = get_next_write(curcontents + starthere,
 					 newcontents + starthere,
-					 len - starthere, &starthere, gran))) {
-		if (!writecount++)
+					 len - starthere, &starthere, gran,
+					 &merge, start + starthere))) {
+		if (!writecount++) {
 			msg_cdbg("W");
+			mark_touched(start, len);
+		}
 		/* Needs the partial write function signature. */
 		ret = flash->chip->write(flash, newcontents + starthere,
 				   start + starthere, lenhere);
@@ -1311,6 +2164,22 @@ static int erase_and_write_block_helper(struct flashctx *flash,
 	return ret;
 }
 
+static int erase_and_write_block_helper(struct flashctx *flash,
+					unsigned int start, unsigned int len,
+					uint8_t *curcontents,
+					uint8_t *newcontents,
+					int (*erasefn) (struct flashctx *flash,
+							unsigned int addr,
+							unsigned int len),
+					enum erase_verify_policy policy)
+{
+	/* curcontents and newcontents are opaque to walk_eraseregions, and
+	 * need to be adjusted here to keep the impression of proper abstraction
+	 */
+	return erase_and_write_block(flash, start, len, curcontents + start,
+				     newcontents + start, erasefn, policy);
+}
+
 static int walk_eraseregions(struct flashctx *flash, int erasefunction,
 			     int (*do_something) (struct flashctx *flash,
 						  unsigned int addr,
@@ -1320,8 +2189,9 @@ static int walk_eraseregions(struct flashctx *flash, int erasefunction,
 						  int (*erasefn) (
 							struct flashctx *flash,
 							unsigned int addr,
-							unsigned int len)),
-			     void *param1, void *param2)
+							unsigned int len),
+						  enum erase_verify_policy policy),
+			     void *param1, void *param2, enum erase_verify_policy policy)
 {
 	int i, j;
 	unsigned int start = 0;
@@ -1340,7 +2210,7 @@ static int walk_eraseregions(struct flashctx *flash, int erasefunction,
 			msg_cdbg("0x%06x-0x%06x", start,
 				     start + len - 1);
 			if (do_something(flash, start, len, param1, param2,
-					 eraser.block_erase)) {
+					 eraser.block_erase, policy)) {
 				return 1;
 			}
 			start += len;
@@ -1350,7 +2220,7 @@ static int walk_eraseregions(struct flashctx *flash, int erasefunction,
 	return 0;
 }
 
-static int check_block_eraser(const struct flashctx *flash, int k, int log)
+int check_block_eraser(const struct flashctx *flash, int k, int log)
 {
 	struct block_eraser eraser = flash->chip->block_erasers[k];
 
@@ -1375,8 +2245,9 @@ static int check_block_eraser(const struct flashctx *flash, int k, int log)
 	return 0;
 }
 
+/* Erase and write the whole chip, checking erases according to @policy. */
 int erase_and_write_flash(struct flashctx *flash, uint8_t *oldcontents,
-			  uint8_t *newcontents)
+			  uint8_t *newcontents, enum erase_verify_policy policy)
 {
 	int k, ret = 1;
 	uint8_t *curcontents;
@@ -1392,6 +2263,22 @@ int erase_and_write_flash(struct flashctx *flash, uint8_t *oldcontents,
 	/* Copy oldcontents to curcontents to avoid clobbering oldcontents. */
 	memcpy(curcontents, oldcontents, size);
 
+	ret = erase_and_write_planned(flash, curcontents, newcontents, 0, size, policy);
+	if (!ret)
+		goto out;
+	if (ret > 0) {
+		/* The planned run failed half-way. Find out what the current
+		 * chip contents are and fall back to one erase function at a
+		 * time.
+		 */
+		msg_cinfo("Reading current flash chip contents... ");
+		if (read_work_area(flash, curcontents)) {
+			msg_cerr("Can't read anymore! Aborting.\n");
+			goto out;
+		}
+		msg_cinfo("done. ");
+	}
+
 	for (k = 0; k < NUM_ERASEFUNCTIONS; k++) {
 		if (k != 0)
 			msg_cdbg("Looking for another erase function.\n");
@@ -1404,7 +2291,7 @@ int erase_and_write_flash(struct flashctx *flash, uint8_t *oldcontents,
 			continue;
 		usable_erasefunctions--;
 		ret = walk_eraseregions(flash, k, &erase_and_write_block_helper,
-					curcontents, newcontents);
+					curcontents, newcontents, policy);
 		/* If everything is OK, don't try another erase function. */
 		if (!ret)
 			break;
@@ -1418,7 +2305,7 @@ int erase_and_write_flash(struct flashctx *flash, uint8_t *oldcontents,
 		 * in non-verbose mode.
 		 */
 		msg_cinfo("Reading current flash chip contents... ");
-		if (flash->chip->read(flash, curcontents, 0, size)) {
+		if (read_work_area(flash, curcontents)) {
 			/* Now we are truly screwed. Read failed as well. */
 			msg_cerr("Can't read anymore! Aborting.\n");
 			/* We have no idea about the flash chip contents, so
@@ -1428,10 +2315,13 @@ int erase_and_write_flash(struct flashctx *flash, uint8_t *oldcontents,
 		}
 		msg_cinfo("done. ");
 	}
+out:
 	/* Free the scratchpad. */
 	free(curcontents);
 
 	if (ret) {
+		/* Whatever was cached for this chip is no longer true. */
+		cache_drop_image(flash);
 		msg_cerr("FAILED!\n");
 	} else {
 		msg_cinfo("Erase/write done.\n");
@@ -1666,9 +2556,17 @@ int selfcheck(void)
 		msg_gerr("Flashchips table miscompilation!\n");
 		ret = 1;
 	}
-	for (chip = flashchips; chip && chip->name; chip++)
+	for (chip = flashchips; chip && chip->name; chip++) {
 		if (selfcheck_eraseblocks(chip))
 			ret = 1;
+		/* Page programming needs to know where to split writes. */
+		if ((chip->write == spi_chip_write_256 || chip->write == write_jedec) &&
+		    !chip->max_write_chunk) {
+			msg_gerr("ERROR: Flash chip %s has no max_write_chunk. Please report a "
+				 "bug at flashrom@flashrom.org\n", chip->name);
+			ret = 1;
+		}
+	}
 
 #if CONFIG_INTERNAL == 1
 	if (chipset_enables == NULL) {
@@ -1810,6 +2708,334 @@ int chip_safety_check(const struct flashctx *flash, int force, int read_it, int
 	return 0;
 }
 
+/* Get the chip ready for any access after chip_safety_check(). Undo with
+ * finish_flash_access(), also if this fails.
+ */
+int prepare_flash_access(struct flashctx *flash)
+{
+	/* Given the existence of read locks, we want to unlock for read,
+	 * erase and write.
+	 */
+	if (flash->chip->unlock)
+		flash->chip->unlock(flash);
+
+	if (flash->chip->bustype == BUS_SPI && spi_prepare_4ba(flash))
+		return 1;
+	return 0;
+}
+
+void finish_flash_access(struct flashctx *flash)
+{
+	spi_finish_4ba(flash);
+}
+
+/* Wait until the chip finished its last internal operation. How the chip
+ * reports that depends on the command set of its write function: SPI chips
+ * have a status register, 82802AB style chips a status register behind a read
+ * status command, and JEDEC style chips stop toggling bit 6. For all others,
+ * e.g. opaque flash, just wait a moment.
+ */
+static void wait_for_chip_ready(struct flashctx *flash)
+{
+	const struct flashchip *chip = flash->chip;
+	int i;
+
+	if (chip->bustype == BUS_SPI) {
+		for (i = 0; i < 1000; i++) {
+			if (!(spi_read_status_register(flash) & SPI_SR_WIP))
+				return;
+			programmer_delay(1000);
+		}
+		msg_cdbg("Chip still busy after 1 s. ");
+	} else if (chip->write == write_82802ab) {
+		wait_82802ab(flash);
+	} else if (chip->write == write_jedec_1 || chip->write == write_jedec ||
+		   chip->write == write_28sf040 || chip->write == write_m29f400bt ||
+		   chip->write == write_en29lv640b) {
+		toggle_ready_jedec(flash, flash->virtual_memory);
+	} else {
+		programmer_delay(10 * 1000);
+	}
+}
+
+/* Verify after writing: only the blocks touched in this run, or the whole
+ * work area if verify_all or @whole is set. Touched-only verification relies
+ * on the old contents having been read from the chip; blocks which were not
+ * touched because they seemed to match are not checked.
+ */
+static int verify_written(struct flashctx *flash, uint8_t *newcontents, int whole)
+{
+	if (verify_all || whole)
+		return walk_work_area(flash, verify_work_area_fn, newcontents);
+	return verify_touched(flash, newcontents, 0);
+}
+
+/* With deferred erase verification, erase failures only show up in the final
+ * verification. Re-read the chip and erase/write everything which still
+ * differs, this time checking each erase, then verify again.
+ * @scratch is overwritten with the current chip contents.
+ */
+static int retry_failed_blocks(struct flashctx *flash, uint8_t *scratch, uint8_t *newcontents)
+{
+	int ret;
+
+	msg_cinfo("\nRetrying the blocks which failed to verify.\n");
+	msg_cinfo("Reading current flash chip contents... ");
+	if (read_work_area(flash, scratch)) {
+		msg_cerr("Can't read anymore! Aborting.\n");
+		return 1;
+	}
+	msg_cinfo("done.\n");
+	ret = erase_and_write_flash(flash, scratch, newcontents, ERASE_VERIFY_FULL);
+	if (ret)
+		return ret;
+	msg_cinfo("Verifying flash... ");
+	return verify_written(flash, newcontents, 0);
+}
+
+/* In low memory mode, the image file is streamed and the chip is read, erased,
+ * written and verified one window at a time. A window is a block of the
+ * coarsest erase function which doesn't erase the whole chip at once, so memory
+ * use is bounded by the size of such a block instead of the size of the chip.
+ */
+static int stream_window_eraser(const struct flashctx *flash)
+{
+	unsigned int count, best_count = 0;
+	int k, best = -1;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS; k++) {
+		if (check_block_eraser(flash, k, 0))
+			continue;
+		count = count_eraseblocks(flash, k);
+		if (best < 0 || (count > 1 && (best_count == 1 || count < best_count))) {
+			best_count = count;
+			best = k;
+		}
+	}
+	return best;
+}
+
+struct stream_buf {
+	uint8_t *buf;
+	unsigned int base;
+};
+
+static int read_window_fn(struct flashctx *flash, unsigned int start,
+			  unsigned int len, void *data)
+{
+	struct stream_buf *sb = data;
+
+	msg_cdbg2("Reading 0x%06x-0x%06x\n", start, start + len - 1);
+	return flash->chip->read(flash, sb->buf + start - sb->base, start, len);
+}
+
+/* Read the work area inside the window at @base into @buf. */
+static int read_window(struct flashctx *flash, uint8_t *buf, unsigned int base,
+		       unsigned int len)
+{
+	struct stream_buf sb = { buf, base };
+
+	return walk_work_range(flash, base, len, read_window_fn, &sb);
+}
+
+static int verify_window_fn(struct flashctx *flash, unsigned int start,
+			    unsigned int len, void *data)
+{
+	struct stream_buf *sb = data;
+
+	return verify_range(flash, sb->buf + start - sb->base, start, len);
+}
+
+/* Like the loop over all erase functions in erase_and_write_flash(), but
+ * limited to one window.
+ */
+static int stream_write_fallback(struct flashctx *flash, uint8_t *oldcontents,
+				 uint8_t *newcontents, unsigned int base,
+				 unsigned int len, enum erase_verify_policy policy)
+{
+	int k, ret = 1;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS && ret; k++) {
+		if (check_block_eraser(flash, k, 0))
+			continue;
+		ret = erase_and_write_window(flash, k, oldcontents, newcontents, base, len, policy);
+		if (!ret)
+			break;
+		if (ret < 0)
+			continue;
+		msg_cinfo("Reading current flash chip contents... ");
+		if (read_window(flash, oldcontents, base, len)) {
+			msg_cerr("Can't read anymore! Aborting.\n");
+			break;
+		}
+		msg_cinfo("done. ");
+	}
+	return ret ? 1 : 0;
+}
+
+/* Erase and write one window, then verify it if requested. @oldcontents holds
+ * the current contents of the window and is clobbered. Erases are checked
+ * according to @policy.
+ */
+static int stream_write_window(struct flashctx *flash, uint8_t *oldcontents,
+			       uint8_t *newcontents, unsigned int base,
+			       unsigned int len, int verify_it,
+			       enum erase_verify_policy policy)
+{
+	struct stream_buf sb = { newcontents, base };
+	int ret;
+
+	reset_touched();
+	ret = erase_and_write_planned(flash, oldcontents, newcontents, base, len, policy);
+	if (ret > 0) {
+		msg_cinfo("Reading current flash chip contents... ");
+		if (read_window(flash, oldcontents, base, len)) {
+			msg_cerr("Can't read anymore! Aborting.\n");
+			return 1;
+		}
+		msg_cinfo("done. ");
+	}
+	if (ret && stream_write_fallback(flash, oldcontents, newcontents, base, len, policy))
+		return 1;
+	if (!verify_it)
+		return 0;
+	wait_for_chip_ready(flash);
+	if (verify_all)
+		ret = walk_work_range(flash, base, len, verify_window_fn, &sb);
+	else
+		ret = verify_touched(flash, newcontents, base);
+	if (ret && policy == ERASE_VERIFY_DEFERRED) {
+		msg_cinfo("\nRetrying the blocks which failed to verify.\n");
+		if (read_window(flash, oldcontents, base, len)) {
+			msg_cerr("Can't read anymore! Aborting.\n");
+			return 1;
+		}
+		ret = stream_write_window(flash, oldcontents, newcontents, base, len,
+					  verify_it, ERASE_VERIFY_FULL);
+	}
+	return ret;
+}
+
+/* Write and/or verify @filename window by window, see stream_window_eraser(). */
+static int stream_flash(struct flashctx *flash, const char *filename, int write_it,
+			int verify_it)
+{
+	const struct block_eraser *eraser;
+	unsigned long size = flash->chip->total_size * 1024;
+	unsigned int base = 0, len, maxlen = 0;
+	uint8_t *oldcontents = NULL, *newcontents = NULL;
+	FILE *image;
+	int i, j, k, ret = 0, failed = 0;
+
+	k = stream_window_eraser(flash);
+	if (k < 0) {
+		msg_cerr("No usable erase function, can't work window by window.\n");
+		return 1;
+	}
+	eraser = &flash->chip->block_erasers[k];
+	for (i = 0; i < NUM_ERASEREGIONS; i++)
+		maxlen = max(maxlen, eraser->eraseblocks[i].size);
+
+	image = open_image(filename, size);
+	if (!image)
+		return 1;
+
+#if CONFIG_INTERNAL == 1
+	if (programmer == PROGRAMMER_INTERNAL) {
+		/* The coreboot image check needs the whole image, but only
+		 * briefly. Afterwards the image is read again from the start.
+		 */
+		if (image == stdin) {
+			msg_gerr("Error: Can't check an image from standard input "
+				 "in low memory mode.\n");
+			return 1;
+		}
+		newcontents = malloc(size);
+		if (!newcontents) {
+			msg_gerr("Out of memory!\n");
+			exit(1);
+		}
+		if (fread(newcontents, 1, size, image) != size || fseek(image, 0, SEEK_SET)) {
+			msg_gerr("Error: Failed to read complete file.\n");
+			ret = 1;
+		} else if (cb_check_image(newcontents, size) < 0) {
+			if (force_boardmismatch) {
+				msg_pinfo("Proceeding anyway because user forced us to.\n");
+			} else {
+				msg_perr("Aborting. You can override this with "
+					 "-p internal:boardmismatch=force.\n");
+				ret = 1;
+			}
+		}
+		free(newcontents);
+		if (ret) {
+			close_image(image);
+			return ret;
+		}
+	}
+#endif
+
+	oldcontents = malloc(maxlen);
+	newcontents = malloc(maxlen);
+	if (!oldcontents || !newcontents) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	msg_cdbg("Working in windows of up to %u kB.\n", maxlen / 1024);
+	if (write_it)
+		msg_cinfo("Erasing and writing flash chip... ");
+	else
+		msg_cinfo("Verifying flash... ");
+	/* Verification goes on after a mismatch to report all of them. */
+	for (i = 0; i < NUM_ERASEREGIONS && !ret; i++) {
+		len = eraser->eraseblocks[i].size;
+		for (j = 0; j < eraser->eraseblocks[i].count && !ret; j++, base += len) {
+			/* The image is read sequentially, it may be a pipe. */
+			if (fread(newcontents, 1, len, image) != len) {
+				msg_gerr("Error: Failed to read complete file.\n");
+				ret = 1;
+				break;
+			}
+			if (!included_regions_overlap(base, base + len - 1))
+				continue;
+			/* Assume worst case: All bits are 0. */
+			memset(oldcontents, 0x00, len);
+			if (read_window(flash, oldcontents, base, len)) {
+				msg_cerr("Read operation failed!\n");
+				ret = 1;
+				break;
+			}
+			handle_romentries_window(oldcontents, newcontents, base, len);
+			if (write_it)
+				ret = stream_write_window(flash, oldcontents, newcontents,
+							  base, len, verify_it,
+							  erase_verify_policy);
+			else if (compare_range(newcontents, oldcontents, base, len))
+				failed = 1;
+		}
+	}
+	if (!ret && !image_at_end(image))
+		ret = 1;
+	ret |= failed;
+	reset_touched();
+	free(oldcontents);
+	free(newcontents);
+	close_image(image);
+
+	if (ret) {
+		msg_cerr("FAILED!\n");
+		if (write_it)
+			emergency_help_message();
+	} else if (write_it) {
+		msg_cinfo("Erase/write done.\n");
+		if (verify_it)
+			msg_cinfo("Verifying flash... VERIFIED.\n");
+	} else {
+		msg_cinfo("VERIFIED.\n");
+	}
+	return ret;
+}
+
 /* This function signature is horrible. We need to design a better interface,
  * but right now it allows us to split off the CLI code.
  * Besides that, the function itself is a textbook example of abysmal code flow.
@@ -1820,6 +3046,10 @@ int doit(struct flashctx *flash, int force, const char *filename, int read_it,
 	uint8_t *oldcontents;
 	uint8_t *newcontents;
 	int ret = 0;
+	/* oldcontents holds the whole chip, not just the work area. */
+	int complete = 0;
+	/* oldcontents came from the cache or --old-image, not from the chip. */
+	int old_unread = 0;
 	unsigned long size = flash->chip->total_size * 1024;
 
 	if (chip_safety_check(flash, force, read_it, write_it, erase_it, verify_it)) {
@@ -1828,17 +3058,34 @@ int doit(struct flashctx *flash, int force, const char *filename, int read_it,
 		goto out_nofree;
 	}
 
-	/* Given the existence of read locks, we want to unlock for read,
-	 * erase and write.
-	 */
-	if (flash->chip->unlock)
-		flash->chip->unlock(flash);
+	if (prepare_flash_access(flash)) {
+		ret = 1;
+		goto out_nofree;
+	}
 
 	if (read_it) {
 		ret = read_flash_to_file(flash, filename);
 		goto out_nofree;
 	}
 
+	if ((write_it || erase_it) && erase_verify_policy == ERASE_VERIFY_STATUS &&
+	    !erase_status_usable(flash))
+		msg_cinfo("This flash chip doesn't report failed erases, reading erased "
+			  "blocks back instead.\n");
+
+	if (low_memory && (write_it || verify_it) && !erase_it) {
+		if (write_it && erase_verify_policy == ERASE_VERIFY_DEFERRED && !verify_it) {
+			msg_cinfo("Deferred erase verification needs the final "
+				  "verification, enabling it.\n");
+			verify_it = 1;
+		}
+		/* The cache needs the whole image, it is not used here. */
+		if (write_it)
+			cache_drop_image(flash);
+		ret = stream_flash(flash, filename, write_it, verify_it);
+		goto out_nofree;
+	}
+
 	oldcontents = malloc(size);
 	if (!oldcontents) {
 		msg_gerr("Out of memory!\n");
@@ -1866,7 +3113,11 @@ int doit(struct flashctx *flash, int force, const char *filename, int read_it,
 		 * so if the user wanted erase and reboots afterwards, the user
 		 * knows very well that booting won't work.
 		 */
-		if (erase_and_write_flash(flash, oldcontents, newcontents)) {
+		cache_drop_image(flash);
+		/* Nothing verifies a plain erase later, don't defer it. */
+		if (erase_and_write_flash(flash, oldcontents, newcontents,
+					  erase_verify_policy == ERASE_VERIFY_DEFERRED ?
+					  ERASE_VERIFY_FULL : erase_verify_policy)) {
 			emergency_help_message();
 			ret = 1;
 		}
@@ -1893,19 +3144,37 @@ int doit(struct flashctx *flash, int force, const char *filename, int read_it,
 #endif
 	}
 
-	/* Read the whole chip to be able to check whether regions need to be
-	 * erased and to give better diagnostics in case write fails.
-	 * The alternative would be to read only the regions which are to be
-	 * preserved, but in that case we might perform unneeded erase which
-	 * takes time as well.
+	if (write_it && erase_verify_policy == ERASE_VERIFY_DEFERRED && !verify_it) {
+		msg_cinfo("Deferred erase verification needs the final "
+			  "verification, enabling it.\n");
+		verify_it = 1;
+	}
+
+	/* Read the work area, i.e. all eraseblocks touched by the included
+	 * regions, to be able to check whether regions need to be erased and
+	 * to give better diagnostics in case write fails. Everything outside
+	 * is preserved: oldcontents keeps its placeholder there and
+	 * handle_romentries() copies it to newcontents, so those bytes are
+	 * never erased, written or verified.
+	 * A cached or user supplied image of the chip spares the read if a
+	 * sample of blocks proves it current. Only the final verification of
+	 * every block written or skipped as unchanged catches the rest, so
+	 * writes without verification read the chip. Verify-only runs always
+	 * read it, that is their purpose.
 	 */
-	msg_cinfo("Reading old flash chip contents... ");
-	if (flash->chip->read(flash, oldcontents, 0, size)) {
-		ret = 1;
-		msg_cinfo("FAILED.\n");
-		goto out;
+	if (write_it && verify_it && !cache_load_image(flash, oldcontents)) {
+		complete = 1;
+		old_unread = 1;
+	} else {
+		msg_cinfo("Reading old flash chip contents... ");
+		if (read_work_area(flash, oldcontents)) {
+			ret = 1;
+			msg_cinfo("FAILED.\n");
+			goto out;
+		}
+		msg_cinfo("done.\n");
+		complete = in_work_area(flash, 0, size);
 	}
-	msg_cinfo("done.\n");
 
 	// This should be moved into each flash part's code to do it 
 	// cleanly. This does the job.
@@ -1914,10 +3183,11 @@ int doit(struct flashctx *flash, int force, const char *filename, int read_it,
 	// ////////////////////////////////////////////////////////////
 
 	if (write_it) {
-		if (erase_and_write_flash(flash, oldcontents, newcontents)) {
+		reset_touched();
+		if (erase_and_write_flash(flash, oldcontents, newcontents, erase_verify_policy)) {
 			msg_cerr("Uh oh. Erase/write failed. Checking if "
 				 "anything changed.\n");
-			if (!flash->chip->read(flash, newcontents, 0, size)) {
+			if (!read_work_area(flash, newcontents)) {
 				if (!memcmp(oldcontents, newcontents, size)) {
 					msg_cinfo("Good. It seems nothing was "
 						  "changed.\n");
@@ -1936,9 +3206,18 @@ int doit(struct flashctx *flash, int force, const char *filename, int read_it,
 		msg_cinfo("Verifying flash... ");
 
 		if (write_it) {
-			/* Work around chips which need some time to calm down. */
-			programmer_delay(1000*1000);
-			ret = verify_range(flash, newcontents, 0, size);
+			wait_for_chip_ready(flash);
+			ret = verify_written(flash, newcontents, old_unread);
+			/* A cached or user supplied image may be stale in
+			 * blocks the spot check didn't sample, which were then
+			 * skipped as unchanged. Reading the chip fixes that.
+			 */
+			if (ret && old_unread) {
+				msg_cinfo("\nThe old contents were not current.");
+				cache_drop_image(flash);
+			}
+			if (ret && (erase_verify_policy == ERASE_VERIFY_DEFERRED || old_unread))
+				ret = retry_failed_blocks(flash, oldcontents, newcontents);
 			/* If we tried to write, and verification now fails, we
 			 * might have an emergency situation.
 			 */
@@ -1951,10 +3230,18 @@ int doit(struct flashctx *flash, int force, const char *filename, int read_it,
 			msg_cinfo("VERIFIED.\n");
 	}
 
+	/* newcontents now matches the chip, oldcontents if only verified. */
+	if (!ret && complete && verify_it)
+		cache_store_image(flash, write_it ? newcontents : oldcontents);
+	else if (write_it)
+		cache_drop_image(flash);
+
 out:
+	reset_touched();
 	free(oldcontents);
 	free(newcontents);
 out_nofree:
+	finish_flash_access(flash);
 	programmer_shutdown();
 	return ret;
 }
@@ -143,13 +143,15 @@ static int ft2232_spi_send_command(struct flashctx *flash,
 				   unsigned int writecnt, unsigned int readcnt,
 				   const unsigned char *writearr,
 				   unsigned char *readarr);
+static int ft2232_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds);
 
 static const struct spi_programmer spi_programmer_ft2232 = {
 	.type		= SPI_CONTROLLER_FT2232,
 	.max_data_read	= 64 * 1024,
 	.max_data_write	= 256,
+	.io_modes	= SPI_IO_FAST_READ | SPI_IO_4BA,
 	.command	= ft2232_spi_send_command,
-	.multicommand	= default_spi_send_multicommand,
+	.multicommand	= ft2232_spi_send_multicommand,
 	.read		= default_spi_read,
 	.write_256	= default_spi_write_256,
 	.write_aai	= default_spi_write_aai,
@@ -482,4 +484,86 @@ static int ft2232_spi_send_command(struct flashctx *flash,
 	return failed ? -1 : 0;
 }
 
+/* Bytes read from the chip in one batch, small enough for the receive FIFO. */
+#define FT2232_BATCH_READ	4096
+
+/* Pack a batch of commands, each framed by asserting and deasserting CS#, into
+ * a single USB write and fetch all their responses with a single read.
+ */
+static int ft2232_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds)
+{
+	struct ftdi_context *ftdic = &ftdic_context;
+	struct spi_command *cmd, *end;
+	unsigned char *buf, *rbuf;
+	unsigned int i, len, rlen;
+	int ret;
+
+	while (cmds->writecnt || cmds->readcnt) {
+		len = 0;
+		rlen = 0;
+		for (end = cmds; end->writecnt || end->readcnt; end++) {
+			if (end->writecnt > 65536 || end->readcnt > FT2232_BATCH_READ - rlen)
+				break;
+			len += 12 + end->writecnt;
+			rlen += end->readcnt;
+		}
+		/* Large transfers are handled, or rejected, one by one. */
+		if (end == cmds) {
+			ret = ft2232_spi_send_command(flash, cmds->writecnt, cmds->readcnt,
+						      cmds->writearr, cmds->readarr);
+			if (ret)
+				return ret;
+			cmds++;
+			continue;
+		}
+
+		buf = malloc(len);
+		rbuf = malloc(max(rlen, 1));
+		if (!buf || !rbuf) {
+			msg_perr("Out of memory!\n");
+			free(buf);
+			free(rbuf);
+			return SPI_GENERIC_ERROR;
+		}
+		i = 0;
+		for (cmd = cmds; cmd != end; cmd++) {
+			buf[i++] = SET_BITS_LOW;
+			buf[i++] = 0 & ~cs_bits; /* assertive */
+			buf[i++] = pindir;
+			if (cmd->writecnt) {
+				buf[i++] = 0x11;
+				buf[i++] = (cmd->writecnt - 1) & 0xff;
+				buf[i++] = ((cmd->writecnt - 1) >> 8) & 0xff;
+				memcpy(buf + i, cmd->writearr, cmd->writecnt);
+				i += cmd->writecnt;
+			}
+			if (cmd->readcnt) {
+				buf[i++] = 0x20;
+				buf[i++] = (cmd->readcnt - 1) & 0xff;
+				buf[i++] = ((cmd->readcnt - 1) >> 8) & 0xff;
+			}
+			buf[i++] = SET_BITS_LOW;
+			buf[i++] = cs_bits;
+			buf[i++] = pindir;
+		}
+		msg_pspew("Sending %i commands in one batch\n", (int)(end - cmds));
+		ret = send_buf(ftdic, buf, i);
+		if (!ret && rlen)
+			ret = get_buf(ftdic, rbuf, rlen);
+		if (!ret) {
+			i = 0;
+			for (cmd = cmds; cmd != end; cmd++) {
+				memcpy(cmd->readarr, rbuf + i, cmd->readcnt);
+				i += cmd->readcnt;
+			}
+		}
+		free(buf);
+		free(rbuf);
+		if (ret)
+			return -1;
+		cmds = end;
+	}
+	return 0;
+}
+
 #endif
@@ -0,0 +1,322 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Host side microbenchmark for the CPU bound parts of flashrom, built and run
+ * by "make bench". No programmer is initialized, the functions run on
+ * synthetic images in memory.
+ *
+ * Usage: flashrom_bench [max image size in MB]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "flash.h"
+#include "flashchips.h"
+#include "programmer.h"
+
+/* Every measurement is repeated until it took at least this long. */
+#define BENCH_MIN_US		200000
+
+static const unsigned int bench_sizes_mb[] = { 1, 16, 64 };
+
+/* Fraction of 4 kB blocks which differ between the old and the new image, in
+ * units of 1/1000.
+ */
+static const unsigned int bench_densities[] = { 0, 1, 10, 100, 1000 };
+
+static uint8_t *oldimg, *newimg;
+static unsigned int imgsize;
+static volatile unsigned int sink;
+
+static uint32_t bench_seed = 0x2545f491;
+
+static uint32_t bench_random(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+/* The old image is random, mostly with erased space at the end. The new image
+ * differs in @density per mille of the 4 kB blocks. Half of the changed blocks
+ * only program bits (no erase needed), the other half is random.
+ */
+static void make_images(unsigned int density)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < imgsize; i++)
+		oldimg[i] = i < imgsize / 4 * 3 ? bench_random() : 0xff;
+	memcpy(newimg, oldimg, imgsize);
+	for (i = 0; i < imgsize; i += 4096) {
+		if (bench_random() % 1000 >= density)
+			continue;
+		if (bench_random() & 1) {
+			for (j = i; j < i + 4096; j++)
+				newimg[j] = oldimg[j] & bench_random();
+		} else {
+			for (j = i; j < i + 4096; j++)
+				newimg[j] = bench_random();
+		}
+	}
+}
+
+static void report(const char *name, const char *variant, unsigned int density,
+		   uint64_t us, unsigned long long bytes)
+{
+	printf("%-24s %-10s %5u.%u%% %8u MB %10.3f ns/byte\n", name, variant,
+	       density / 10, density % 10, imgsize >> 20, us * 1000.0 / bytes);
+}
+
+static void bench_need_erase(const char *variant, unsigned int density,
+			     enum write_granularity gran, unsigned int block)
+{
+	unsigned long long bytes = 0;
+	uint64_t start = timestamp_usecs();
+	unsigned int i;
+
+	do {
+		for (i = 0; i < imgsize; i += block)
+			sink += need_erase(oldimg + i, newimg + i, block, gran);
+		bytes += imgsize;
+	} while (timestamp_usecs() - start < BENCH_MIN_US);
+	report("need_erase", variant, density, timestamp_usecs() - start, bytes);
+}
+
+static void bench_get_next_write(const char *variant, unsigned int density,
+				 enum write_granularity gran, const struct write_merge *merge)
+{
+	unsigned long long bytes = 0;
+	uint64_t start = timestamp_usecs();
+	unsigned int i, pos, len;
+
+	do {
+		/* Same pattern as erase_and_write_block(), one 4 kB block at
+		 * a time.
+		 */
+		for (i = 0; i < imgsize; i += 4096) {
+			pos = 0;
+			while ((len = get_next_write(oldimg + i + pos, newimg + i + pos,
+						     4096 - pos, &pos, gran, merge, i + pos)))
+				pos += len;
+		}
+		bytes += imgsize;
+	} while (timestamp_usecs() - start < BENCH_MIN_US);
+	report("get_next_write", variant, density, timestamp_usecs() - start, bytes);
+}
+
+static void bench_compare_range(void)
+{
+	unsigned long long bytes = 0;
+	uint64_t start = timestamp_usecs();
+
+	/* The successful verify is the common case, it scans everything. */
+	memcpy(newimg, oldimg, imgsize);
+	do {
+		sink += compare_range(newimg, oldimg, 0, imgsize);
+		bytes += imgsize;
+	} while (timestamp_usecs() - start < BENCH_MIN_US);
+	report("compare_range", "equal", 0, timestamp_usecs() - start, bytes);
+}
+
+static void bench_testpattern(void)
+{
+	unsigned long long bytes = 0;
+	uint64_t start = timestamp_usecs();
+	int variant;
+
+	do {
+		for (variant = 0; variant < 8; variant++)
+			sink += generate_testpattern(newimg, imgsize, variant);
+		bytes += 8ULL * imgsize;
+	} while (timestamp_usecs() - start < BENCH_MIN_US);
+	report("generate_testpattern", "all", 0, timestamp_usecs() - start, bytes);
+}
+
+static int bench_layout(void)
+{
+	char name[] = "/tmp/flashrom_bench.XXXXXX";
+	struct flashchip chip = { .total_size = imgsize / 1024 };
+	struct flashctx flash = { .chip = &chip };
+	unsigned long long bytes = 0;
+	uint64_t start;
+	unsigned int i, regions = 16;
+	char region[16];
+	FILE *f;
+	int fd;
+
+	/* A layout with 16 regions, every other one included. */
+	fd = mkstemp(name);
+	if (fd < 0 || !(f = fdopen(fd, "w"))) {
+		perror(name);
+		return 1;
+	}
+	for (i = 0; i < regions; i++)
+		fprintf(f, "%08x:%08x r%u\n", i * (imgsize / regions),
+			(i + 1) * (imgsize / regions) - 1, i);
+	fclose(f);
+	if (read_romlayout(name)) {
+		remove(name);
+		return 1;
+	}
+	remove(name);
+	for (i = 0; i < regions; i += 2) {
+		snprintf(region, sizeof(region), "r%u", i);
+		if (register_include_arg(strdup(region)))
+			return 1;
+	}
+	if (process_include_args())
+		return 1;
+
+	start = timestamp_usecs();
+	do {
+		handle_romentries(&flash, oldimg, newimg);
+		bytes += imgsize;
+	} while (timestamp_usecs() - start < BENCH_MIN_US);
+	report("handle_romentries", "16 regions", 0, timestamp_usecs() - start, bytes);
+
+	/* walk_work_area() asks this for every eraseblock. */
+	bytes = 0;
+	start = timestamp_usecs();
+	do {
+		for (i = 0; i < imgsize; i += 4096)
+			sink += included_regions_overlap(i, i + 4095);
+		bytes += imgsize;
+	} while (timestamp_usecs() - start < BENCH_MIN_US);
+	report("included_regions_overlap", "4 kB", 0, timestamp_usecs() - start, bytes);
+	return 0;
+}
+
+static void bench_selfcheck(void)
+{
+	const struct flashchip *chip;
+	unsigned long long chips = 0;
+	uint64_t start = timestamp_usecs(), us;
+
+	do {
+		for (chip = flashchips; chip->name; chip++) {
+			sink += selfcheck_eraseblocks(chip);
+			chips++;
+		}
+	} while (timestamp_usecs() - start < BENCH_MIN_US);
+	us = timestamp_usecs() - start;
+	printf("%-24s %-10s %8.1f ns/chip\n", "selfcheck_eraseblocks", "flashchips",
+	       us * 1000.0 / chips);
+}
+
+/* Run every scan of the selected memscan implementation on one range. */
+static void run_memscan(unsigned int *res, unsigned int pos, unsigned int len)
+{
+	res[0] = memscan_first_diff(oldimg + pos, newimg + pos, len);
+	res[1] = memscan_first_equal(oldimg + pos, newimg + pos, len);
+	res[2] = memscan_first_not_erased(oldimg + pos, len);
+	res[3] = memscan_first_bit_conflict(oldimg + pos, newimg + pos, len);
+	res[4] = memscan_first_byte_conflict(oldimg + pos, newimg + pos, len);
+}
+
+/* All memscan implementations must agree with the scalar one. */
+static int check_memscan(void)
+{
+	unsigned int i, ref[5], res[5], pos, len;
+	const char *name;
+	int n, ret = 0;
+
+	for (i = 0; i < 64; i++) {
+		pos = bench_random() % imgsize;
+		len = min(imgsize - pos, bench_random() % 8192);
+		if (memscan_select("scalar")) {
+			printf("memscan scalar: not available\n");
+			return 1;
+		}
+		run_memscan(ref, pos, len);
+		for (n = 0; (name = memscan_name(n)); n++) {
+			if (memscan_select(name))
+				continue;
+			run_memscan(res, pos, len);
+			if (memcmp(ref, res, sizeof(ref))) {
+				printf("memscan %s: mismatch at 0x%x+0x%x\n", name, pos, len);
+				ret = 1;
+			}
+		}
+	}
+	memscan_select(NULL);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	const struct write_merge nomerge = { 0, 0, 0 };
+	const struct write_merge merge = { 8, 256, 256 };
+	unsigned int maxmb = 64, d, s, n;
+	const char *name;
+	int ret = 0;
+
+	if (argc > 1)
+		maxmb = strtoul(argv[1], NULL, 0);
+	verbose_screen = MSG_ERROR;
+
+	for (s = 0; s < ARRAY_SIZE(bench_sizes_mb) && bench_sizes_mb[s] <= maxmb; s++) {
+		imgsize = bench_sizes_mb[s] << 20;
+		oldimg = malloc(imgsize);
+		newimg = malloc(imgsize);
+		if (!oldimg || !newimg) {
+			fprintf(stderr, "Out of memory!\n");
+			return 1;
+		}
+		for (d = 0; d < ARRAY_SIZE(bench_densities); d++) {
+			make_images(bench_densities[d]);
+			for (n = 0; (name = memscan_name(n)); n++) {
+				if (memscan_select(name))
+					continue;
+				bench_need_erase(name, bench_densities[d], write_gran_256bytes, 4096);
+			}
+			memscan_select(NULL);
+			bench_need_erase("1 byte", bench_densities[d], write_gran_1byte, 4096);
+			bench_need_erase("1 bit", bench_densities[d], write_gran_1bit, 4096);
+			bench_get_next_write("256 bytes", bench_densities[d], write_gran_256bytes,
+					     &nomerge);
+			bench_get_next_write("1 byte", bench_densities[d], write_gran_1byte,
+					     &nomerge);
+			bench_get_next_write("merged", bench_densities[d], write_gran_1byte,
+					     &merge);
+			ret |= check_memscan();
+		}
+		bench_compare_range();
+		bench_testpattern();
+		free(oldimg);
+		free(newimg);
+	}
+	/* The layout code keeps global state, run it once. */
+	imgsize = 16 << 20;
+	oldimg = calloc(imgsize, 1);
+	newimg = calloc(imgsize, 1);
+	if (!oldimg || !newimg) {
+		fprintf(stderr, "Out of memory!\n");
+		return 1;
+	}
+	ret |= bench_layout();
+	free(oldimg);
+	free(newimg);
+	bench_selfcheck();
+	if (ret)
+		printf("FAILED.\n");
+	return ret;
+}
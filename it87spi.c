@@ -331,7 +331,7 @@ static int it8716f_spi_page_program(struct flashctx *flash, uint8_t *buf,
 	/* FIXME: The command below seems to be redundant or wrong. */
 	OUTB(0x06, it8716f_flashport + 1);
 	OUTB(((2 + (fast_spi ? 1 : 0)) << 4), it8716f_flashport);
-	for (i = 0; i < flash->chip->page_size; i++)
+	for (i = 0; i < flash->chip->max_write_chunk; i++)
 		mmio_writeb(buf[i], (void *)(bios + start + i));
 	OUTB(0, it8716f_flashport);
 	/* Wait until the Write-In-Progress bit is cleared.
@@ -371,34 +371,34 @@ static int it8716f_spi_chip_write_256(struct flashctx *flash, uint8_t *buf,
 	/*
 	 * IT8716F only allows maximum of 512 kb SPI chip size for memory
 	 * mapped access. It also can't write more than 1+3+256 bytes at once,
-	 * so page_size > 256 bytes needs a fallback.
+	 * so write chunks larger than 256 bytes need a fallback.
 	 * FIXME: Split too big page writes into chunks IT87* can handle instead
 	 * of degrading to single-byte program.
 	 * FIXME: Check if someone explicitly requested to use IT87 SPI although
 	 * the mainboard does not use IT87 SPI translation. This should be done
 	 * via a programmer parameter for the internal programmer.
 	 */
-	if ((chip->total_size * 1024 > 512 * 1024) || (chip->page_size > 256)) {
+	if ((chip->total_size * 1024 > 512 * 1024) || (chip->max_write_chunk > 256)) {
 		spi_chip_write_1(flash, buf, start, len);
 	} else {
 		unsigned int lenhere;
 
-		if (start % chip->page_size) {
+		if (start % chip->max_write_chunk) {
 			/* start to the end of the page or to start + len,
 			 * whichever is smaller.
 			 */
-			lenhere = min(len, chip->page_size - start % chip->page_size);
+			lenhere = min(len, chip->max_write_chunk - start % chip->max_write_chunk);
 			spi_chip_write_1(flash, buf, start, lenhere);
 			start += lenhere;
 			len -= lenhere;
 			buf += lenhere;
 		}
 
-		while (len >= chip->page_size) {
+		while (len >= chip->max_write_chunk) {
 			it8716f_spi_page_program(flash, buf, start);
-			start += chip->page_size;
-			len -= chip->page_size;
-			buf += chip->page_size;
+			start += chip->max_write_chunk;
+			len -= chip->max_write_chunk;
+			buf += chip->max_write_chunk;
 		}
 		if (len)
 			spi_chip_write_1(flash, buf, start, len);
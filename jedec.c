@@ -22,12 +22,15 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <string.h>
 #include "flash.h"
 
 #define MAX_REFLASH_TRIES 0x10
 #define MASK_FULL 0xffff
 #define MASK_2AA 0x7ff
 #define MASK_AAA 0xfff
+/* Limit for programmers polling on their own, the host takes over after it. */
+#define JEDEC_POLL_TIMEOUT_US (10 * 1000 * 1000)
 
 /* Check one byte for odd parity */
 uint8_t oddparity(uint8_t val)
@@ -43,6 +46,9 @@ static void toggle_ready_jedec_common(const struct flashctx *flash,
 	unsigned int i = 0;
 	uint8_t tmp1, tmp2;
 
+	/* The programmer can't wait between reads, only offload the fast case. */
+	if (!delay && chip_poll(flash, POLL_TOGGLE, dst, 0x40, 0, JEDEC_POLL_TIMEOUT_US) == 0)
+		return;
 	tmp1 = chip_readb(flash, dst) & 0x40;
 
 	while (i++ < 0xFFFFFFF) {
@@ -83,6 +89,8 @@ void data_polling_jedec(const struct flashctx *flash, chipaddr dst,
 
 	data &= 0x80;
 
+	if (chip_poll(flash, POLL_DATA, dst, 0x80, data, JEDEC_POLL_TIMEOUT_US) == 0)
+		return;
 	while (i++ < 0xFFFFFFF) {
 		tmp = chip_readb(flash, dst) & 0x80;
 		if (tmp == data) {
@@ -121,38 +129,36 @@ static void start_program_jedec_common(struct flashctx *flash,
 	chip_writeb(flash, 0xA0, bios + (0x5555 & mask));
 }
 
-static int probe_jedec_common(struct flashctx *flash, unsigned int mask)
-{
-	chipaddr bios = flash->virtual_memory;
-	const struct flashchip *chip = flash->chip;
-	uint8_t id1, id2;
-	uint32_t largeid1, largeid2;
-	uint32_t flashcontent1, flashcontent2;
-	int probe_timing_enter, probe_timing_exit;
+/* What a JEDEC ID probe read from the chip. */
+struct jedec_ids {
+	uint32_t largeid1;
+	uint32_t largeid2;
+	uint32_t flashcontent1;
+	uint32_t flashcontent2;
+	uint8_t id1;
+};
+
+/* Probe results only depend on the mapping and on how the ID mode is entered
+ * and left, this is the key for the probe cache. The mapped size is part of it
+ * because a new mapping of a different window may reuse the address.
+ */
+struct jedec_probe_key {
+	chipaddr bios;
+	unsigned int size;
+	unsigned int mask;
+	int probe_timing_enter;
+	int probe_timing_exit;
+	int long_reset;
+};
 
-	if (chip->probe_timing > 0)
-		probe_timing_enter = probe_timing_exit = chip->probe_timing;
-	else if (chip->probe_timing == TIMING_ZERO) { /* No delay. */
-		probe_timing_enter = probe_timing_exit = 0;
-	} else if (chip->probe_timing == TIMING_FIXME) { /* == _IGNORED */
-		msg_cdbg("Chip lacks correct probe timing information, "
-			     "using default 10mS/40uS. ");
-		probe_timing_enter = 10000;
-		probe_timing_exit = 40;
-	} else {
-		msg_cerr("Chip has negative value in probe_timing, failing "
-		       "without chip access\n");
-		return 0;
-	}
+/* Issue JEDEC Product ID Exit command, this also resets the chip to read mode. */
+static void exit_id_jedec(struct flashctx *flash, const struct jedec_probe_key *key)
+{
+	chipaddr bios = key->bios;
+	unsigned int mask = key->mask;
+	int probe_timing_exit = key->probe_timing_exit;
 
-	/* Earlier probes might have been too fast for the chip to enter ID
-	 * mode completely. Allow the chip to finish this before seeing a
-	 * reset command.
-	 */
-	if (probe_timing_enter)
-		programmer_delay(probe_timing_enter);
-	/* Reset chip to a clean slate */
-	if ((chip->feature_bits & FEATURE_RESET_MASK) == FEATURE_LONG_RESET)
+	if (key->long_reset)
 	{
 		chip_writeb(flash, 0xAA, bios + (0x5555 & mask));
 		if (probe_timing_exit)
@@ -164,6 +170,31 @@ static int probe_jedec_common(struct flashctx *flash, unsigned int mask)
 	chip_writeb(flash, 0xF0, bios + (0x5555 & mask));
 	if (probe_timing_exit)
 		programmer_delay(probe_timing_exit);
+}
+
+/* Reset chip to a clean slate */
+static void reset_id_jedec(struct flashctx *flash, const struct jedec_probe_key *key)
+{
+	/* Earlier probes might have been too fast for the chip to enter ID
+	 * mode completely. Allow the chip to finish this before seeing a
+	 * reset command.
+	 */
+	if (key->probe_timing_enter)
+		programmer_delay(key->probe_timing_enter);
+	exit_id_jedec(flash, key);
+}
+
+static void read_ids_jedec(struct flashctx *flash, const struct jedec_probe_key *key,
+			   struct jedec_ids *ids)
+{
+	chipaddr bios = key->bios;
+	unsigned int mask = key->mask;
+	int probe_timing_enter = key->probe_timing_enter;
+	uint8_t id1, id2;
+	uint32_t largeid1, largeid2;
+	uint32_t flashcontent1, flashcontent2;
+
+	reset_id_jedec(flash, key);
 
 	/* Issue JEDEC Product ID Entry command */
 	chip_writeb(flash, 0xAA, bios + (0x5555 & mask));
@@ -194,23 +225,7 @@ static int probe_jedec_common(struct flashctx *flash, unsigned int mask)
 		largeid2 |= id2;
 	}
 
-	/* Issue JEDEC Product ID Exit command */
-	if ((chip->feature_bits & FEATURE_RESET_MASK) == FEATURE_LONG_RESET)
-	{
-		chip_writeb(flash, 0xAA, bios + (0x5555 & mask));
-		if (probe_timing_exit)
-			programmer_delay(10);
-		chip_writeb(flash, 0x55, bios + (0x2AAA & mask));
-		if (probe_timing_exit)
-			programmer_delay(10);
-	}
-	chip_writeb(flash, 0xF0, bios + (0x5555 & mask));
-	if (probe_timing_exit)
-		programmer_delay(probe_timing_exit);
-
-	msg_cdbg("%s: id1 0x%02x, id2 0x%02x", __func__, largeid1, largeid2);
-	if (!oddparity(id1))
-		msg_cdbg(", id1 parity violation");
+	exit_id_jedec(flash, key);
 
 	/* Read the product ID location again. We should now see normal flash contents. */
 	flashcontent1 = chip_readb(flash, bios);
@@ -226,13 +241,64 @@ static int probe_jedec_common(struct flashctx *flash, unsigned int mask)
 		flashcontent2 |= chip_readb(flash, bios + 0x101);
 	}
 
-	if (largeid1 == flashcontent1)
+	ids->largeid1 = largeid1;
+	ids->largeid2 = largeid2;
+	ids->flashcontent1 = flashcontent1;
+	ids->flashcontent2 = flashcontent2;
+	ids->id1 = id1;
+}
+
+static int probe_jedec_common(struct flashctx *flash, unsigned int mask)
+{
+	const struct flashchip *chip = flash->chip;
+	struct jedec_probe_key key;
+	struct jedec_ids ids;
+	int probe_timing_enter, probe_timing_exit;
+	int ret;
+
+	if (chip->probe_timing > 0)
+		probe_timing_enter = probe_timing_exit = chip->probe_timing;
+	else if (chip->probe_timing == TIMING_ZERO) { /* No delay. */
+		probe_timing_enter = probe_timing_exit = 0;
+	} else if (chip->probe_timing == TIMING_FIXME) { /* == _IGNORED */
+		msg_cdbg("Chip lacks correct probe timing information, "
+			     "using default 10mS/40uS. ");
+		probe_timing_enter = 10000;
+		probe_timing_exit = 40;
+	} else {
+		msg_cerr("Chip has negative value in probe_timing, failing "
+		       "without chip access\n");
+		return 0;
+	}
+
+	memset(&key, 0, sizeof(key));
+	key.bios = flash->virtual_memory;
+	key.size = chip->total_size;
+	key.mask = mask;
+	key.probe_timing_enter = probe_timing_enter;
+	key.probe_timing_exit = probe_timing_exit;
+	key.long_reset = (chip->feature_bits & FEATURE_RESET_MASK) == FEATURE_LONG_RESET;
+	if (probe_cache_lookup("jedec", &key, sizeof(key), &ids, sizeof(ids), &ret)) {
+		/* Other ID commands since the cached one may have left the
+		 * chip in ID mode, the chip still gets this probe's reset.
+		 */
+		reset_id_jedec(flash, &key);
+	} else {
+		read_ids_jedec(flash, &key, &ids);
+		probe_cache_store("jedec", &key, sizeof(key), &ids, sizeof(ids), 0);
+	}
+
+	msg_cdbg("%s: id1 0x%02x, id2 0x%02x", __func__, ids.largeid1, ids.largeid2);
+	if (!oddparity(ids.id1))
+		msg_cdbg(", id1 parity violation");
+
+	if (ids.largeid1 == ids.flashcontent1)
 		msg_cdbg(", id1 is normal flash content");
-	if (largeid2 == flashcontent2)
+	if (ids.largeid2 == ids.flashcontent2)
 		msg_cdbg(", id2 is normal flash content");
 
 	msg_cdbg("\n");
-	if (largeid1 != chip->manufacture_id || largeid2 != chip->model_id)
+	if (ids.largeid1 != chip->manufacture_id || ids.largeid2 != chip->model_id)
 		return 0;
 
 	if (chip->feature_bits & FEATURE_REGISTERMAP)
@@ -434,12 +500,7 @@ int write_jedec(struct flashctx *flash, uint8_t *buf, unsigned int start,
 		int unsigned len)
 {
 	unsigned int i, starthere, lenhere;
-	/* FIXME: page_size is the wrong variable. We need max_writechunk_size
-	 * in struct flashctx to do this properly. All chips using
-	 * write_jedec have page_size set to max_writechunk_size, so
-	 * we're OK for now.
-	 */
-	unsigned int page_size = flash->chip->page_size;
+	unsigned int page_size = flash->chip->max_write_chunk;
 
 	/* Warning: This loop has a very unusual condition and body.
 	 * The loop needs to go through each page with at least one affected
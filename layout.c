@@ -217,11 +217,33 @@ romlayout_t *get_next_included_romentry(unsigned int start)
 	return best_entry;
 }
 
+/* Returns 1 if any part of [start, end] belongs to an included region or if no
+ * regions were specified for inclusion, 0 otherwise.
+ */
+int included_regions_overlap(unsigned int start, unsigned int end)
+{
+	romlayout_t *entry;
+
+	if (num_include_args == 0)
+		return 1;
+	entry = get_next_included_romentry(start);
+	return entry && entry->start <= end;
+}
+
 int handle_romentries(const struct flashctx *flash, uint8_t *oldcontents, uint8_t *newcontents)
 {
-	unsigned int start = 0;
+	return handle_romentries_window(oldcontents, newcontents, 0,
+					flash->chip->total_size * 1024);
+}
+
+/* Like handle_romentries(), but the buffers only hold the window
+ * [base, base + len - 1] of the chip.
+ */
+int handle_romentries_window(uint8_t *oldcontents, uint8_t *newcontents,
+			     unsigned int base, unsigned int len)
+{
+	unsigned int start = base, end = base + len;
 	romlayout_t *entry;
-	unsigned int size = flash->chip->total_size * 1024;
 
 	/* If no regions were specified for inclusion, assume
 	 * that the user wants to write the complete new image.
@@ -232,17 +254,17 @@ int handle_romentries(const struct flashctx *flash, uint8_t *oldcontents, uint8_
 	/* Non-included romentries are ignored.
 	 * The union of all included romentries is used from the new image.
 	 */
-	while (start < size) {
+	while (start < end) {
 		entry = get_next_included_romentry(start);
 		/* No more romentries for remaining region? */
-		if (!entry) {
-			memcpy(newcontents + start, oldcontents + start,
-			       size - start);
+		if (!entry || entry->start >= end) {
+			memcpy(newcontents + start - base, oldcontents + start - base,
+			       end - start);
 			break;
 		}
 		/* For non-included region, copy from old content. */
 		if (entry->start > start)
-			memcpy(newcontents + start, oldcontents + start,
+			memcpy(newcontents + start - base, oldcontents + start - base,
 			       entry->start - start);
 		/* Skip to location after current romentry. */
 		start = entry->end + 1;
@@ -41,17 +41,19 @@ static int linux_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 				  unsigned int readcnt,
 				  const unsigned char *txbuf,
 				  unsigned char *rxbuf);
+static int linux_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds);
 static int linux_spi_read(struct flashctx *flash, uint8_t *buf,
 			  unsigned int start, unsigned int len);
 static int linux_spi_write_256(struct flashctx *flash, uint8_t *buf,
 			       unsigned int start, unsigned int len);
 
-static const struct spi_programmer spi_programmer_linux = {
+static struct spi_programmer spi_programmer_linux = {
 	.type		= SPI_CONTROLLER_LINUX,
 	.max_data_read	= MAX_DATA_UNSPECIFIED, /* TODO? */
 	.max_data_write	= MAX_DATA_UNSPECIFIED, /* TODO? */
+	.io_modes	= SPI_IO_FAST_READ | SPI_IO_4BA, /* Dual/quad: linux_spi_init() */
 	.command	= linux_spi_send_command,
-	.multicommand	= default_spi_send_multicommand,
+	.multicommand	= linux_spi_send_multicommand,
 	.read		= linux_spi_read,
 	.write_256	= linux_spi_write_256,
 	.write_aai	= default_spi_write_aai,
@@ -65,6 +67,9 @@ int linux_spi_init(void)
 	/* SPI mode 0 (beware this also includes: MSB first, CS active low and others */
 	const uint8_t mode = SPI_MODE_0;
 	const uint8_t bits = 8;
+#ifdef SPI_IOC_WR_MODE32
+	uint32_t mode32;
+#endif
 
 	dev = extract_programmer_param("dev");
 	if (!dev || !strlen(dev)) {
@@ -115,6 +120,26 @@ int linux_spi_init(void)
 		return 1;
 	}
 
+#ifdef SPI_IOC_WR_MODE32
+	/* Ask for quad reads, then for dual reads. The kernel refuses to set
+	 * both bits at once and keeps the old mode if the controller or the
+	 * device tree don't allow the requested one, so read the mode back.
+	 * Quad mode also allows dual transfers.
+	 */
+	mode32 = mode | SPI_RX_QUAD;
+	if (ioctl(fd, SPI_IOC_WR_MODE32, &mode32) != -1 &&
+	    ioctl(fd, SPI_IOC_RD_MODE32, &mode32) != -1 && (mode32 & SPI_RX_QUAD))
+		spi_programmer_linux.io_modes |= SPI_IO_DUAL_OUT | SPI_IO_QUAD_OUT;
+	mode32 = mode | SPI_RX_DUAL;
+	if (!(spi_programmer_linux.io_modes & SPI_IO_QUAD_OUT) &&
+	    ioctl(fd, SPI_IOC_WR_MODE32, &mode32) != -1 &&
+	    ioctl(fd, SPI_IOC_RD_MODE32, &mode32) != -1 && (mode32 & SPI_RX_DUAL))
+		spi_programmer_linux.io_modes |= SPI_IO_DUAL_OUT;
+	msg_pdbg("Dual output reads %ssupported, quad output reads %ssupported.\n",
+		 spi_programmer_linux.io_modes & SPI_IO_DUAL_OUT ? "" : "not ",
+		 spi_programmer_linux.io_modes & SPI_IO_QUAD_OUT ? "" : "not ");
+#endif
+
 	register_spi_programmer(&spi_programmer_linux);
 
 	return 0;
@@ -167,6 +192,58 @@ static int linux_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 	return 0;
 }
 
+#ifdef SPI_IOC_WR_MODE32
+/* Number of lines to receive the data of @cmd on, 0 means the default of 1. */
+static uint8_t linux_spi_rx_nbits(const struct spi_command *cmd)
+{
+	if (cmd->io & SPI_IO_QUAD_OUT)
+		return 4;
+	if (cmd->io & SPI_IO_DUAL_OUT)
+		return 2;
+	return 0;
+}
+#endif
+
+/* Transfers per ioctl, two per command. */
+#define LINUX_SPI_MAX_TRANSFERS	64
+
+/* Send a whole batch of commands with one ioctl. cs_change on the last transfer
+ * of a command deasserts CS# before the next one starts.
+ */
+static int linux_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds)
+{
+	struct spi_ioc_transfer msg[LINUX_SPI_MAX_TRANSFERS];
+	unsigned int n;
+
+	if (fd == -1)
+		return -1;
+	while (cmds->writecnt || cmds->readcnt) {
+		memset(msg, 0, sizeof(msg));
+		for (n = 0; (cmds->writecnt || cmds->readcnt) && n + 2 <= LINUX_SPI_MAX_TRANSFERS;
+		     cmds++) {
+			/* See linux_spi_send_command(). */
+			if (cmds->writecnt == 0)
+				return SPI_INVALID_LENGTH;
+			if (n)
+				msg[n - 1].cs_change = 1;
+			msg[n].tx_buf = (uint64_t)(ptrdiff_t)cmds->writearr;
+			msg[n++].len = cmds->writecnt;
+			if (cmds->readcnt) {
+				msg[n].rx_buf = (uint64_t)(ptrdiff_t)cmds->readarr;
+#ifdef SPI_IOC_WR_MODE32
+				msg[n].rx_nbits = linux_spi_rx_nbits(cmds);
+#endif
+				msg[n++].len = cmds->readcnt;
+			}
+		}
+		if (ioctl(fd, SPI_IOC_MESSAGE(n), msg) == -1) {
+			msg_cerr("%s: ioctl: %s\n", __func__, strerror(errno));
+			return -1;
+		}
+	}
+	return 0;
+}
+
 static int linux_spi_read(struct flashctx *flash, uint8_t *buf,
 			  unsigned int start, unsigned int len)
 {
@@ -0,0 +1,458 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Buffer scanning primitives used for comparing flash contents with images.
+ *
+ * Each primitive returns the offset of the first byte matching its condition
+ * or len if there is none. The plain byte loops are the reference, the word
+ * and SIMD variants must return exactly the same results. The fastest variant
+ * supported by the CPU is picked at runtime.
+ */
+
+#include <string.h>
+#include "flash.h"
+
+#if (defined(__i386__) || defined(__x86_64__)) && !defined(__LIBPAYLOAD__) && \
+    ((defined(__clang__) && (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8))) || \
+     (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define MEMSCAN_X86 1
+#include <immintrin.h>
+#else
+#define MEMSCAN_X86 0
+#endif
+
+struct memscan_ops {
+	const char *name;
+	/* have[i] != want[i] */
+	unsigned int (*first_diff) (const uint8_t *have, const uint8_t *want, unsigned int len);
+	/* have[i] == want[i] */
+	unsigned int (*first_equal) (const uint8_t *have, const uint8_t *want, unsigned int len);
+	/* buf[i] != 0xff */
+	unsigned int (*first_not_erased) (const uint8_t *buf, unsigned int len);
+	/* (have[i] & want[i]) != want[i], i.e. a bit would have to go from 0 to 1 */
+	unsigned int (*first_bit_conflict) (const uint8_t *have, const uint8_t *want, unsigned int len);
+	/* have[i] != want[i] && have[i] != 0xff, i.e. a written byte would change */
+	unsigned int (*first_byte_conflict) (const uint8_t *have, const uint8_t *want, unsigned int len);
+};
+
+static unsigned int scalar_first_diff(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		if (have[i] != want[i])
+			break;
+	return i;
+}
+
+static unsigned int scalar_first_equal(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		if (have[i] == want[i])
+			break;
+	return i;
+}
+
+static unsigned int scalar_first_not_erased(const uint8_t *buf, unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		if (buf[i] != 0xff)
+			break;
+	return i;
+}
+
+static unsigned int scalar_first_bit_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		if ((have[i] & want[i]) != want[i])
+			break;
+	return i;
+}
+
+static unsigned int scalar_first_byte_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		if ((have[i] != want[i]) && (have[i] != 0xff))
+			break;
+	return i;
+}
+
+static const struct memscan_ops memscan_scalar = {
+	.name			= "scalar",
+	.first_diff		= scalar_first_diff,
+	.first_equal		= scalar_first_equal,
+	.first_not_erased	= scalar_first_not_erased,
+	.first_bit_conflict	= scalar_first_bit_conflict,
+	.first_byte_conflict	= scalar_first_byte_conflict,
+};
+
+/* The word variants look at 8 bytes at a time and let the byte loops find the
+ * exact offset once a word contains a match.
+ */
+#define WORD_ONES	0x0101010101010101ULL
+#define WORD_HIGHS	0x8080808080808080ULL
+#define WORD_LOWS	0x7f7f7f7f7f7f7f7fULL
+
+static inline uint64_t load_word(const uint8_t *p)
+{
+	uint64_t w;
+
+	memcpy(&w, p, sizeof(w));
+	return w;
+}
+
+/* Sets the high bit of every byte of v which is non-zero. */
+static inline uint64_t nonzero_bytes(uint64_t v)
+{
+	return (((v & WORD_LOWS) + WORD_LOWS) | v) & WORD_HIGHS;
+}
+
+static unsigned int word_first_diff(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0;
+
+	for (; i + 8 <= len; i += 8)
+		if (load_word(have + i) != load_word(want + i))
+			break;
+	return i + scalar_first_diff(have + i, want + i, len - i);
+}
+
+static unsigned int word_first_equal(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0;
+
+	for (; i + 8 <= len; i += 8)
+		if (nonzero_bytes(load_word(have + i) ^ load_word(want + i)) != WORD_HIGHS)
+			break;
+	return i + scalar_first_equal(have + i, want + i, len - i);
+}
+
+static unsigned int word_first_not_erased(const uint8_t *buf, unsigned int len)
+{
+	unsigned int i = 0;
+
+	for (; i + 8 <= len; i += 8)
+		if (load_word(buf + i) != ~0ULL)
+			break;
+	return i + scalar_first_not_erased(buf + i, len - i);
+}
+
+static unsigned int word_first_bit_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0;
+
+	for (; i + 8 <= len; i += 8)
+		if (~load_word(have + i) & load_word(want + i))
+			break;
+	return i + scalar_first_bit_conflict(have + i, want + i, len - i);
+}
+
+static unsigned int word_first_byte_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0;
+	uint64_t h;
+
+	for (; i + 8 <= len; i += 8) {
+		h = load_word(have + i);
+		if (nonzero_bytes(h ^ load_word(want + i)) & nonzero_bytes(~h))
+			break;
+	}
+	return i + scalar_first_byte_conflict(have + i, want + i, len - i);
+}
+
+static const struct memscan_ops memscan_word = {
+	.name			= "word",
+	.first_diff		= word_first_diff,
+	.first_equal		= word_first_equal,
+	.first_not_erased	= word_first_not_erased,
+	.first_bit_conflict	= word_first_bit_conflict,
+	.first_byte_conflict	= word_first_byte_conflict,
+};
+
+#if MEMSCAN_X86 == 1
+/* The SIMD variants compute a mask with one bit per byte which is set for the
+ * bytes NOT matching the condition, so the first clear bit is the result.
+ */
+#define SSE2_FN __attribute__((target("sse2")))
+
+SSE2_FN static unsigned int sse2_first_diff(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0, mask;
+
+	for (; i + 16 <= len; i += 16) {
+		mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(have + i)),
+							_mm_loadu_si128((const __m128i *)(want + i))));
+		if (mask != 0xffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_diff(have + i, want + i, len - i);
+}
+
+SSE2_FN static unsigned int sse2_first_equal(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0, mask;
+
+	for (; i + 16 <= len; i += 16) {
+		mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(have + i)),
+							_mm_loadu_si128((const __m128i *)(want + i))));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return i + scalar_first_equal(have + i, want + i, len - i);
+}
+
+SSE2_FN static unsigned int sse2_first_not_erased(const uint8_t *buf, unsigned int len)
+{
+	const __m128i ones = _mm_set1_epi8((char)0xff);
+	unsigned int i = 0, mask;
+
+	for (; i + 16 <= len; i += 16) {
+		mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i)), ones));
+		if (mask != 0xffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_not_erased(buf + i, len - i);
+}
+
+SSE2_FN static unsigned int sse2_first_bit_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	const __m128i zero = _mm_setzero_si128();
+	unsigned int i = 0, mask;
+	__m128i lost;
+
+	for (; i + 16 <= len; i += 16) {
+		lost = _mm_andnot_si128(_mm_loadu_si128((const __m128i *)(have + i)),
+					_mm_loadu_si128((const __m128i *)(want + i)));
+		mask = _mm_movemask_epi8(_mm_cmpeq_epi8(lost, zero));
+		if (mask != 0xffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_bit_conflict(have + i, want + i, len - i);
+}
+
+SSE2_FN static unsigned int sse2_first_byte_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	const __m128i ones = _mm_set1_epi8((char)0xff);
+	unsigned int i = 0, mask;
+	__m128i h;
+
+	for (; i + 16 <= len; i += 16) {
+		h = _mm_loadu_si128((const __m128i *)(have + i));
+		mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(h, _mm_loadu_si128((const __m128i *)(want + i))),
+						      _mm_cmpeq_epi8(h, ones)));
+		if (mask != 0xffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_byte_conflict(have + i, want + i, len - i);
+}
+
+static const struct memscan_ops memscan_sse2 = {
+	.name			= "sse2",
+	.first_diff		= sse2_first_diff,
+	.first_equal		= sse2_first_equal,
+	.first_not_erased	= sse2_first_not_erased,
+	.first_bit_conflict	= sse2_first_bit_conflict,
+	.first_byte_conflict	= sse2_first_byte_conflict,
+};
+
+#define AVX2_FN __attribute__((target("avx2")))
+
+AVX2_FN static unsigned int avx2_first_diff(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0, mask;
+
+	for (; i + 32 <= len; i += 32) {
+		mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(have + i)),
+							      _mm256_loadu_si256((const __m256i *)(want + i))));
+		if (mask != 0xffffffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_diff(have + i, want + i, len - i);
+}
+
+AVX2_FN static unsigned int avx2_first_equal(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	unsigned int i = 0, mask;
+
+	for (; i + 32 <= len; i += 32) {
+		mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(have + i)),
+							      _mm256_loadu_si256((const __m256i *)(want + i))));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return i + scalar_first_equal(have + i, want + i, len - i);
+}
+
+AVX2_FN static unsigned int avx2_first_not_erased(const uint8_t *buf, unsigned int len)
+{
+	const __m256i ones = _mm256_set1_epi8((char)0xff);
+	unsigned int i = 0, mask;
+
+	for (; i + 32 <= len; i += 32) {
+		mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i)),
+							      ones));
+		if (mask != 0xffffffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_not_erased(buf + i, len - i);
+}
+
+AVX2_FN static unsigned int avx2_first_bit_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	unsigned int i = 0, mask;
+	__m256i lost;
+
+	for (; i + 32 <= len; i += 32) {
+		lost = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i *)(have + i)),
+					   _mm256_loadu_si256((const __m256i *)(want + i)));
+		mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(lost, zero));
+		if (mask != 0xffffffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_bit_conflict(have + i, want + i, len - i);
+}
+
+AVX2_FN static unsigned int avx2_first_byte_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	const __m256i ones = _mm256_set1_epi8((char)0xff);
+	unsigned int i = 0, mask;
+	__m256i h, w;
+
+	for (; i + 32 <= len; i += 32) {
+		h = _mm256_loadu_si256((const __m256i *)(have + i));
+		w = _mm256_loadu_si256((const __m256i *)(want + i));
+		mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(h, w),
+							    _mm256_cmpeq_epi8(h, ones)));
+		if (mask != 0xffffffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + scalar_first_byte_conflict(have + i, want + i, len - i);
+}
+
+static const struct memscan_ops memscan_avx2 = {
+	.name			= "avx2",
+	.first_diff		= avx2_first_diff,
+	.first_equal		= avx2_first_equal,
+	.first_not_erased	= avx2_first_not_erased,
+	.first_bit_conflict	= avx2_first_bit_conflict,
+	.first_byte_conflict	= avx2_first_byte_conflict,
+};
+#endif
+
+static const struct memscan_ops *const memscan_all[] = {
+#if MEMSCAN_X86 == 1
+	&memscan_avx2,
+	&memscan_sse2,
+#endif
+	&memscan_word,
+	&memscan_scalar,
+	NULL,
+};
+
+static const struct memscan_ops *memscan = NULL;
+
+static int memscan_supported(const struct memscan_ops *ops)
+{
+#if MEMSCAN_X86 == 1
+	__builtin_cpu_init();
+	if (ops == &memscan_avx2)
+		return __builtin_cpu_supports("avx2");
+	if (ops == &memscan_sse2)
+		return __builtin_cpu_supports("sse2");
+#endif
+	return 1;
+}
+
+static const struct memscan_ops *memscan_get(void)
+{
+	int i;
+
+	if (memscan)
+		return memscan;
+	for (i = 0; !memscan_supported(memscan_all[i]); i++)
+		;
+	memscan = memscan_all[i];
+	msg_gspew("Using %s buffer scanning.\n", memscan->name);
+	return memscan;
+}
+
+/* Force a specific implementation, e.g. for benchmarking. Passing NULL selects
+ * the best one again. Returns 0 on success, 1 if the implementation is unknown
+ * or not supported by this CPU.
+ */
+int memscan_select(const char *name)
+{
+	int i;
+
+	memscan = NULL;
+	if (!name)
+		return 0;
+	for (i = 0; memscan_all[i]; i++) {
+		if (strcmp(memscan_all[i]->name, name))
+			continue;
+		if (!memscan_supported(memscan_all[i]))
+			return 1;
+		memscan = memscan_all[i];
+		return 0;
+	}
+	return 1;
+}
+
+/* Returns the name of the n-th implementation or NULL past the last one. */
+const char *memscan_name(int n)
+{
+	int i;
+
+	for (i = 0; i < n && memscan_all[i]; i++)
+		;
+	return memscan_all[i] ? memscan_all[i]->name : NULL;
+}
+
+unsigned int memscan_first_diff(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	return memscan_get()->first_diff(have, want, len);
+}
+
+unsigned int memscan_first_equal(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	return memscan_get()->first_equal(have, want, len);
+}
+
+unsigned int memscan_first_not_erased(const uint8_t *buf, unsigned int len)
+{
+	return memscan_get()->first_not_erased(buf, len);
+}
+
+unsigned int memscan_first_bit_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	return memscan_get()->first_bit_conflict(have, want, len);
+}
+
+unsigned int memscan_first_byte_conflict(const uint8_t *have, const uint8_t *want, unsigned int len)
+{
+	return memscan_get()->first_byte_conflict(have, want, len);
+}
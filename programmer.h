@@ -124,6 +124,7 @@ extern const struct programmer_entry programmer_table[];
 
 int programmer_init(enum programmer prog, const char *param);
 int programmer_shutdown(void);
+const char *programmer_id(void);
 
 enum bitbang_spi_master_type {
 	BITBANG_SPI_INVALID	= 0, /* This must always be the first entry. */
@@ -231,6 +232,7 @@ extern const struct board_info laptops_known[];
 void myusec_delay(int usecs);
 void myusec_calibrate_delay(void);
 void internal_delay(int usecs);
+uint64_t timestamp_usecs(void);
 
 #if NEED_PCI == 1
 /* pcidev.c */
@@ -469,6 +471,13 @@ struct decode_sizes {
 extern struct decode_sizes max_rom_decode;
 extern int programmer_may_write;
 extern unsigned long flashbase;
+struct bus_stats {
+	unsigned long long commands;	/* SPI commands or parallel bus accesses */
+	unsigned long long calls;	/* Calls into the programmer, one per multicommand */
+	unsigned long long bytes;	/* Bytes sent and received */
+	unsigned long long delay_us;	/* Time requested from programmer_delay() */
+};
+extern struct bus_stats bus_stats;
 void check_chip_supported(const struct flashchip *chip);
 int check_max_decode(enum chipbustype buses, uint32_t size);
 char *extract_programmer_param(const char *param_name);
@@ -517,6 +526,11 @@ struct spi_programmer {
 	enum spi_controller type;
 	unsigned int max_data_read;
 	unsigned int max_data_write;
+	/* SPI_IO_* transfer modes supported by multicommand. command() only
+	 * sees the bytes, so leave out the multi line modes unless the lines
+	 * don't matter (emulation) or multicommand is implemented natively.
+	 */
+	unsigned int io_modes;
 	int (*command)(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
 		   const unsigned char *writearr, unsigned char *readarr);
 	int (*multicommand)(struct flashctx *flash, struct spi_command *cmds);
@@ -525,6 +539,11 @@ struct spi_programmer {
 	int (*read)(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 	int (*write_256)(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 	int (*write_aai)(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
+	/* Optional: read status register @opcode until the bits in @mask are
+	 * clear. Returns 0 when they are, 1 on timeout and <0 on error.
+	 */
+	int (*poll_status)(struct flashctx *flash, uint8_t opcode, uint8_t mask,
+			   unsigned int timeout_us);
 	const void *data;
 };
 
@@ -608,6 +627,11 @@ struct par_programmer {
 	uint16_t (*chip_readw) (const struct flashctx *flash, const chipaddr addr);
 	uint32_t (*chip_readl) (const struct flashctx *flash, const chipaddr addr);
 	void (*chip_readn) (const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len);
+	/* Optional: read @addr until the condition of @type is met. Returns 0
+	 * when it is, 1 on timeout and <0 on error.
+	 */
+	int (*poll) (const struct flashctx *flash, enum par_poll_type type, chipaddr addr,
+		     uint8_t mask, uint8_t value, unsigned int timeout_us);
 	const void *data;
 };
 int register_par_programmer(const struct par_programmer *pgm, const enum chipbustype buses);
@@ -627,6 +651,10 @@ int register_programmer(struct registered_programmer *pgm);
 #if CONFIG_SERPROG == 1
 int serprog_init(void);
 void serprog_delay(int usecs);
+uint16_t serprog_crc16(uint16_t crc, const unsigned char *buf, uint32_t len);
+
+/* serprog_server.c */
+int serve_serprog(const char *spec);
 #endif
 
 /* serial.c */
@@ -39,6 +39,7 @@
 #include "programmer.h"
 #include "chipdrivers.h"
 #include "serprog.h"
+#include "spi.h"
 
 #define MSGHEADER "serprog: "
 
@@ -81,6 +82,42 @@ static int sp_opbuf_usage = 0;
 	whether the command is supported before doing it */
 static int sp_check_avail_automatic = 0;
 
+/* Protocol v2: SPI operations carry a tag and are sent without waiting for the
+ * replies to earlier ones, as long as their requests fit into the serial buffer
+ * of the device. The replies arrive in order and are read as the window moves.
+ */
+#define SP_TSPIOP_HEADER	11
+#define SP_MAX_INFLIGHT		256
+/* Requests with up to this many bytes to send are written in one piece. */
+#define SP_TSPIOP_INLINE	272
+/* Reads are split into operations of this size to keep several in flight. */
+#define SP_TSPIOP_READ_CHUNK	16384
+/* Error bit of a reply to O_POLL, the device gave up waiting. */
+#define SP_POLL_NAK		2
+
+struct sp_inflight {
+	uint8_t tag;
+	uint32_t reqlen;	/* Bytes taken in the serial buffer */
+	uint32_t readcnt;
+	unsigned char *readarr;
+	int rle;
+	int poll;		/* An untagged O_POLL, see sp_tagged_poll() */
+};
+
+static int sp_tagged_ops = 0;
+static int sp_tagged_crc = 0;
+/* Reads may be answered run-length encoded, see sp_read_rle(). */
+static int sp_rle = 0;
+/* Ask for run-length encoded replies to the next tagged operations. */
+static int sp_tagged_rle = 0;
+/* Leave the replies in flight when returning from an SPI command. */
+static int sp_tagged_defer = 0;
+static struct sp_inflight sp_inflight[SP_MAX_INFLIGHT];
+static unsigned int sp_inflight_first = 0;
+static unsigned int sp_inflight_count = 0;
+static uint32_t sp_inflight_bytes = 0;
+static uint8_t sp_next_tag = 0;
+
 static int sp_opensocket(char *ip, unsigned int port)
 {
 	int flag = 1;
@@ -229,20 +266,27 @@ static int sp_automatic_cmdcheck(uint8_t cmd)
 	return 0;
 }
 
-static int sp_docommand(uint8_t command, uint32_t parmlen,
-			uint8_t *params, uint32_t retlen, void *retparms)
+static int sp_read_all(void *buf, uint32_t len)
 {
-	unsigned char c;
-	if (sp_automatic_cmdcheck(command))
-		return 1;
-	if (write(sp_fd, &command, 1) != 1) {
-		msg_perr("Error: cannot write op code: %s\n", strerror(errno));
-		return 1;
-	}
-	if (write(sp_fd, params, parmlen) != (parmlen)) {
-		msg_perr("Error: cannot write parameters: %s\n", strerror(errno));
-		return 1;
+	uint32_t rd_bytes = 0;
+	int r;
+
+	while (rd_bytes != len) {
+		r = read(sp_fd, buf + rd_bytes, len - rd_bytes);
+		if (r <= 0) {
+			msg_perr("Error: cannot read return parameters: %s\n", strerror(errno));
+			return 1;
+		}
+		rd_bytes += r;
 	}
+	return 0;
+}
+
+/* Read the ACK or NAK of a command and @retlen bytes of return parameters. */
+static int sp_read_reply(uint32_t retlen, void *retparms)
+{
+	unsigned char c;
+
 	if (read(sp_fd, &c, 1) != 1) {
 		msg_perr("Error: cannot read from device: %s\n", strerror(errno));
 		return 1;
@@ -253,20 +297,234 @@ static int sp_docommand(uint8_t command, uint32_t parmlen,
 		msg_perr("Error: invalid response 0x%02X from device\n", c);
 		return 1;
 	}
-	if (retlen) {
-		int rd_bytes = 0;
-		do {
-			int r;
-			r = read(sp_fd, retparms + rd_bytes,
-				 retlen - rd_bytes);
-			if (r <= 0) {
-				msg_perr("Error: cannot read return parameters: %s\n", strerror(errno));
-				return 1;
+	return sp_read_all(retparms, retlen);
+}
+
+/* Read @len bytes of run-length encoded data, see S_CMD_R_NBYTES_RLE in
+ * serprog-protocol.txt. The data comes in chunks with a length each, so
+ * nothing beyond the reply is read from the device.
+ */
+static int sp_read_rle(unsigned char *buf, uint32_t len)
+{
+	static unsigned char chunk[0xffff];
+	uint32_t done = 0, n;
+	unsigned int chunklen, pos;
+	unsigned char hdr[2], c;
+
+	while (done < len) {
+		if (sp_read_all(hdr, sizeof(hdr)))
+			return 1;
+		chunklen = hdr[0] | (hdr[1] << 8);
+		if (!chunklen || sp_read_all(chunk, chunklen))
+			goto bad;
+		for (pos = 0; pos < chunklen; ) {
+			c = chunk[pos++];
+			if (c < 0x80) {
+				n = c + 1;
+				if (pos + n > chunklen || done + n > len)
+					goto bad;
+				memcpy(buf + done, chunk + pos, n);
+				pos += n;
+			} else {
+				n = c - 0x80 + 3;
+				if (pos == chunklen || done + n > len)
+					goto bad;
+				memset(buf + done, chunk[pos++], n);
 			}
-			rd_bytes += r;
-		} while (rd_bytes != retlen);
+			done += n;
+		}
 	}
 	return 0;
+bad:
+	msg_perr("Error: invalid run-length encoded data from device\n");
+	return 1;
+}
+
+/* CRC-16/CCITT-FALSE, used by protocol v2. */
+uint16_t serprog_crc16(uint16_t crc, const unsigned char *buf, uint32_t len)
+{
+	uint32_t i;
+	int j;
+
+	for (i = 0; i < len; i++) {
+		crc ^= buf[i] << 8;
+		for (j = 0; j < 8; j++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+static void sp_write_all(const unsigned char *buf, uint32_t len)
+{
+	if (write(sp_fd, buf, len) != len)
+		sp_die("Error: cannot write SPI operation");
+}
+
+/* Read the reply to the oldest operation in flight. Returns 1 on errors,
+ * SP_POLL_NAK if it was an O_POLL which gave up.
+ */
+static int sp_tagged_reply(void)
+{
+	struct sp_inflight *op = &sp_inflight[sp_inflight_first];
+	unsigned char hdr[2], crcbuf[2];
+	uint16_t crc;
+
+	sp_inflight_first = (sp_inflight_first + 1) % SP_MAX_INFLIGHT;
+	sp_inflight_count--;
+	sp_inflight_bytes -= op->reqlen;
+	if (op->poll) {
+		if (sp_read_all(hdr, 1))
+			sp_die("Error: cannot read reply to poll");
+		if (hdr[0] == S_NAK)
+			return SP_POLL_NAK;
+		if (hdr[0] != S_ACK || sp_read_all(op->readarr, 1))
+			sp_die("Error: lost synchronization with the device");
+		return 0;
+	}
+	if (sp_read_all(hdr, sizeof(hdr)))
+		sp_die("Error: cannot read reply to SPI operation");
+	if ((hdr[0] != S_ACK && hdr[0] != S_NAK) || hdr[1] != op->tag) {
+		msg_perr("Error: got 0x%02X for tag %u while waiting for tag %u\n",
+			 hdr[0], hdr[1], op->tag);
+		sp_die("Error: lost synchronization with the device");
+	}
+	if (hdr[0] == S_NAK)
+		return 1;
+	if (op->rle ? sp_read_rle(op->readarr, op->readcnt) :
+		      sp_read_all(op->readarr, op->readcnt))
+		sp_die("Error: cannot read reply to SPI operation");
+	if (!sp_tagged_crc)
+		return 0;
+	if (sp_read_all(crcbuf, sizeof(crcbuf)))
+		sp_die("Error: cannot read reply to SPI operation");
+	crc = serprog_crc16(0xffff, hdr, sizeof(hdr));
+	crc = serprog_crc16(crc, op->readarr, op->readcnt);
+	if (crc != (crcbuf[0] | (crcbuf[1] << 8))) {
+		msg_perr("Error: CRC mismatch in the reply to SPI operation %u\n", op->tag);
+		return 1;
+	}
+	return 0;
+}
+
+/* Send a tagged SPI operation once it fits into the window. Returns the
+ * errors of earlier operations whose replies had to be read to make room.
+ */
+static int sp_tagged_send(unsigned int writecnt, unsigned int readcnt,
+			  const unsigned char *writearr, unsigned char *readarr)
+{
+	unsigned char buf[SP_TSPIOP_HEADER + SP_TSPIOP_INLINE + 2];
+	uint32_t reqlen = SP_TSPIOP_HEADER + writecnt + (sp_tagged_crc ? 2 : 0);
+	struct sp_inflight *op;
+	uint16_t crc;
+	int ret = 0;
+
+	/* A request larger than the whole buffer is sent on its own. */
+	while (sp_inflight_count && (sp_inflight_count == SP_MAX_INFLIGHT ||
+	       sp_inflight_bytes + reqlen > sp_device_serbuf_size))
+		ret |= sp_tagged_reply();
+
+	buf[0] = S_CMD_O_TSPIOP;
+	buf[1] = sp_next_tag;
+	buf[2] = (sp_tagged_crc ? S_TSPIOP_CRC : 0) | (sp_tagged_rle ? S_TSPIOP_RLE : 0);
+	buf[3] = (writecnt >> 0) & 0xFF;
+	buf[4] = (writecnt >> 8) & 0xFF;
+	buf[5] = (writecnt >> 16) & 0xFF;
+	buf[6] = (writecnt >> 24) & 0xFF;
+	buf[7] = (readcnt >> 0) & 0xFF;
+	buf[8] = (readcnt >> 8) & 0xFF;
+	buf[9] = (readcnt >> 16) & 0xFF;
+	buf[10] = (readcnt >> 24) & 0xFF;
+	crc = serprog_crc16(0xffff, buf, SP_TSPIOP_HEADER);
+	crc = serprog_crc16(crc, writearr, writecnt);
+	if (writecnt <= SP_TSPIOP_INLINE) {
+		memcpy(buf + SP_TSPIOP_HEADER, writearr, writecnt);
+		buf[SP_TSPIOP_HEADER + writecnt] = crc & 0xFF;
+		buf[SP_TSPIOP_HEADER + writecnt + 1] = crc >> 8;
+		sp_write_all(buf, reqlen);
+	} else {
+		sp_write_all(buf, SP_TSPIOP_HEADER);
+		sp_write_all(writearr, writecnt);
+		buf[0] = crc & 0xFF;
+		buf[1] = crc >> 8;
+		if (sp_tagged_crc)
+			sp_write_all(buf, 2);
+	}
+
+	op = &sp_inflight[(sp_inflight_first + sp_inflight_count) % SP_MAX_INFLIGHT];
+	op->tag = sp_next_tag++;
+	op->reqlen = reqlen;
+	op->readcnt = readcnt;
+	op->readarr = readarr;
+	op->rle = sp_tagged_rle;
+	op->poll = 0;
+	sp_inflight_count++;
+	sp_inflight_bytes += reqlen;
+	return ret;
+}
+
+/* Send an O_POLL for the SPI status register between tagged operations. The
+ * device runs it in order, so the operations after it wait for the chip
+ * without a round trip. @status gets the last status read.
+ */
+static int sp_tagged_poll(uint8_t opcode, uint8_t mask, uint32_t timeout_us,
+			  unsigned char *status)
+{
+	unsigned char buf[11];
+	struct sp_inflight *op;
+	int ret = 0;
+
+	while (sp_inflight_count && (sp_inflight_count == SP_MAX_INFLIGHT ||
+	       sp_inflight_bytes + sizeof(buf) > sp_device_serbuf_size))
+		ret |= sp_tagged_reply();
+
+	buf[0] = S_CMD_O_POLL;
+	buf[1] = S_POLL_SPI_STATUS;
+	buf[2] = 0;
+	buf[3] = 0;
+	buf[4] = 0;
+	buf[5] = mask;
+	buf[6] = opcode;
+	buf[7] = (timeout_us >> 0) & 0xFF;
+	buf[8] = (timeout_us >> 8) & 0xFF;
+	buf[9] = (timeout_us >> 16) & 0xFF;
+	buf[10] = (timeout_us >> 24) & 0xFF;
+	sp_write_all(buf, sizeof(buf));
+
+	op = &sp_inflight[(sp_inflight_first + sp_inflight_count) % SP_MAX_INFLIGHT];
+	op->reqlen = sizeof(buf);
+	op->readcnt = 1;
+	op->readarr = status;
+	op->rle = 0;
+	op->poll = 1;
+	sp_inflight_count++;
+	sp_inflight_bytes += sizeof(buf);
+	return ret;
+}
+
+/* Read all outstanding replies. */
+static int sp_tagged_drain(void)
+{
+	int ret = 0;
+
+	while (sp_inflight_count)
+		ret |= sp_tagged_reply();
+	return ret;
+}
+
+static int sp_docommand(uint8_t command, uint32_t parmlen,
+			uint8_t *params, uint32_t retlen, void *retparms)
+{
+	if (sp_automatic_cmdcheck(command))
+		return 1;
+	if (write(sp_fd, &command, 1) != 1) {
+		msg_perr("Error: cannot write op code: %s\n", strerror(errno));
+		return 1;
+	}
+	if (write(sp_fd, params, parmlen) != (parmlen)) {
+		msg_perr("Error: cannot write parameters: %s\n", strerror(errno));
+		return 1;
+	}
+	return sp_read_reply(retlen, retparms);
 }
 
 static void sp_flush_stream(void)
@@ -313,14 +571,18 @@ static int serprog_spi_send_command(struct flashctx *flash,
 				    unsigned int writecnt, unsigned int readcnt,
 				    const unsigned char *writearr,
 				    unsigned char *readarr);
+static int serprog_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds);
 static int serprog_spi_read(struct flashctx *flash, uint8_t *buf,
 			    unsigned int start, unsigned int len);
+static int serprog_spi_poll_status(struct flashctx *flash, uint8_t opcode,
+				   uint8_t mask, unsigned int timeout_us);
 static struct spi_programmer spi_programmer_serprog = {
 	.type		= SPI_CONTROLLER_SERPROG,
 	.max_data_read	= MAX_DATA_READ_UNLIMITED,
 	.max_data_write	= MAX_DATA_WRITE_UNLIMITED,
+	.io_modes	= SPI_IO_4BA,
 	.command	= serprog_spi_send_command,
-	.multicommand	= default_spi_send_multicommand,
+	.multicommand	= serprog_spi_send_multicommand,
 	.read		= serprog_spi_read,
 	.write_256	= default_spi_write_256,
 	.write_aai	= default_spi_write_aai,
@@ -332,7 +594,11 @@ static uint8_t serprog_chip_readb(const struct flashctx *flash,
 				  const chipaddr addr);
 static void serprog_chip_readn(const struct flashctx *flash, uint8_t *buf,
 			       const chipaddr addr, size_t len);
-static const struct par_programmer par_programmer_serprog = {
+static int serprog_chip_poll(const struct flashctx *flash,
+			     enum par_poll_type type, chipaddr addr,
+			     uint8_t mask, uint8_t value,
+			     unsigned int timeout_us);
+static struct par_programmer par_programmer_serprog = {
 		.chip_readb		= serprog_chip_readb,
 		.chip_readw		= fallback_chip_readw,
 		.chip_readl		= fallback_chip_readl,
@@ -481,6 +747,7 @@ int serprog_init(void)
 	if (serprog_buses_supported & BUS_SPI) {
 		uint8_t bt = BUS_SPI;
 		char *spispeed;
+		char *crc;
 		if (sp_check_commandavail(S_CMD_O_SPIOP) == 0) {
 			msg_perr("Error: SPI operation not supported while the "
 				 "bustype is SPI\n");
@@ -512,6 +779,28 @@ int serprog_init(void)
 			spi_programmer_serprog.max_data_read = v;
 			msg_pdbg(MSGHEADER "Maximum read-n length is %d\n", v);
 		}
+		crc = extract_programmer_param("crc");
+		if (crc && !strcmp(crc, "yes")) {
+			sp_tagged_crc = 1;
+		} else if (crc && strcmp(crc, "no")) {
+			msg_perr("Error: crc must be \"yes\" or \"no\".\n");
+			free(crc);
+			return 1;
+		}
+		free(crc);
+		if (sp_check_commandavail(S_CMD_O_TSPIOP)) {
+			sp_tagged_ops = 1;
+			/* Lengths are 32 bit, and the reply to a read is
+			 * streamed instead of buffered by the device.
+			 */
+			spi_programmer_serprog.max_data_read = MAX_DATA_READ_UNLIMITED;
+			msg_pdbg(MSGHEADER "Using tagged SPI operations%s\n",
+				 sp_tagged_crc ? " with CRC" : "");
+		} else if (sp_tagged_crc) {
+			msg_perr("Error: crc=yes needs tagged SPI operations, which the device "
+				 "does not support.\n");
+			return 1;
+		}
 		spispeed = extract_programmer_param("spispeed");
 		if (spispeed && strlen(spispeed)) {
 			uint32_t f_spi_req, f_spi;
@@ -673,6 +962,17 @@ int serprog_init(void)
 			msg_pdbg(MSGHEADER "Output drivers enabled\n");
 	} else
 		msg_pdbg(MSGHEADER "Warning: Programmer does not support toggling its output drivers\n");
+	/* Mostly erased chips are read much faster. */
+	if (sp_check_commandavail(S_CMD_R_NBYTES_RLE)) {
+		msg_pdbg(MSGHEADER "Reads are run-length encoded\n");
+		sp_rle = 1;
+	}
+	if (sp_check_commandavail(S_CMD_O_POLL)) {
+		msg_pdbg(MSGHEADER "Programmer waits for the flash chip on its own\n");
+		spi_programmer_serprog.poll_status = serprog_spi_poll_status;
+		spi_programmer_serprog.io_modes |= SPI_IO_POLL;
+		par_programmer_serprog.poll = serprog_chip_poll;
+	}
 	sp_prev_was_write = 0;
 	sp_streamed_transmit_ops = 0;
 	sp_streamed_transmit_bytes = 0;
@@ -838,6 +1138,13 @@ static void sp_do_read_n(uint8_t * buf, const chipaddr addr, size_t len)
 	sbuf[3] = ((len >> 0) & 0xFF);
 	sbuf[4] = ((len >> 8) & 0xFF);
 	sbuf[5] = ((len >> 16) & 0xFF);
+	if (sp_rle) {
+		sp_stream_buffer_op(S_CMD_R_NBYTES_RLE, 6, sbuf);
+		sp_flush_stream();
+		if (sp_read_rle(buf, len))
+			sp_die("Error: cannot read read-n data");
+		return;
+	}
 	sp_stream_buffer_op(S_CMD_R_NBYTES, 6, sbuf);
 	sp_flush_stream();
 	do {
@@ -895,6 +1202,12 @@ static int serprog_spi_send_command(struct flashctx *flash,
 	msg_pspew("%s, writecnt=%i, readcnt=%i\n", __func__, writecnt, readcnt);
 	if ((sp_opbuf_usage) || (sp_max_write_n && sp_write_n_bytes))
 		sp_execute_opbuf();
+	if (sp_tagged_ops) {
+		ret = sp_tagged_send(writecnt, readcnt, writearr, readarr);
+		if (!sp_tagged_defer)
+			ret |= sp_tagged_drain();
+		return ret;
+	}
 	parmbuf = malloc(writecnt + 6);
 	if (!parmbuf)
 		sp_die("Error: cannot malloc SPI send param buffer");
@@ -911,22 +1224,167 @@ static int serprog_spi_send_command(struct flashctx *flash,
 	return ret;
 }
 
-/* FIXME: This function is optimized so that it does not split each transaction
- * into chip page_size long blocks unnecessarily like spi_read_chunked. This has
- * the advantage that it is much faster for most chips, but breaks those with
- * non-contiguous address space (like AT45DB161D). When spi_read_chunked is
- * fixed this method can be removed. */
-static int serprog_spi_read(struct flashctx *flash, uint8_t *buf,
-			    unsigned int start, unsigned int len)
+/* Send as many SPI operations as fit into the serial buffer of the device
+ * before reading their replies, instead of waiting for every reply. The device
+ * handles the operations one after another, so this saves a round trip per
+ * command. Waits for the chip (SPI_IO_POLL) go into the stream as O_POLL, the
+ * commands after them only run once the chip is ready. If the device gives up
+ * on a wait, this returns SPI_POLL_TIMEOUT unless something else failed too.
+ */
+static int serprog_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds)
 {
-	unsigned int i, cur_len;
-	const unsigned int max_read = spi_programmer_serprog.max_data_read;
-	for (i = 0; i < len; i += cur_len) {
-		int ret;
-		cur_len = min(max_read, (len - i));
-		ret = spi_nbyte_read(flash, start + i, buf + i, cur_len);
+	struct spi_command *cmd, *end;
+	unsigned char *buf;
+	uint32_t len, opsize;
+	int ret = 0, polled = 0;
+
+	if ((sp_opbuf_usage) || (sp_max_write_n && sp_write_n_bytes))
+		sp_execute_opbuf();
+	if (sp_tagged_ops) {
+		for (cmd = cmds; cmd->writecnt || cmd->readcnt; cmd++) {
+			if (cmd->io & SPI_IO_POLL)
+				ret |= sp_tagged_poll(cmd->writearr[0], cmd->poll_mask,
+						      cmd->poll_timeout_us, cmd->readarr);
+			else
+				ret |= sp_tagged_send(cmd->writecnt, cmd->readcnt, cmd->writearr,
+						      cmd->readarr);
+		}
+		ret |= sp_tagged_drain();
+		if (ret & ~SP_POLL_NAK)
+			return 1;
+		return ret ? SPI_POLL_TIMEOUT : 0;
+	}
+	if (sp_automatic_cmdcheck(S_CMD_O_SPIOP))
+		return 1;
+	while (cmds->writecnt || cmds->readcnt) {
+		len = 0;
+		for (end = cmds; end->writecnt || end->readcnt; end++) {
+			if (end->io & SPI_IO_POLL)
+				opsize = 1 + 10;
+			else
+				opsize = 1 + 6 + end->writecnt;
+			if (end != cmds && len + opsize > sp_device_serbuf_size)
+				break;
+			len += opsize;
+		}
+		buf = malloc(len);
+		if (!buf)
+			sp_die("Error: cannot malloc SPI send param buffer");
+		len = 0;
+		for (cmd = cmds; cmd != end; cmd++) {
+			if (cmd->io & SPI_IO_POLL) {
+				buf[len++] = S_CMD_O_POLL;
+				buf[len++] = S_POLL_SPI_STATUS;
+				buf[len++] = 0;
+				buf[len++] = 0;
+				buf[len++] = 0;
+				buf[len++] = cmd->poll_mask;
+				buf[len++] = cmd->writearr[0];
+				buf[len++] = (cmd->poll_timeout_us >> 0) & 0xFF;
+				buf[len++] = (cmd->poll_timeout_us >> 8) & 0xFF;
+				buf[len++] = (cmd->poll_timeout_us >> 16) & 0xFF;
+				buf[len++] = (cmd->poll_timeout_us >> 24) & 0xFF;
+				continue;
+			}
+			buf[len++] = S_CMD_O_SPIOP;
+			buf[len++] = (cmd->writecnt >> 0) & 0xFF;
+			buf[len++] = (cmd->writecnt >> 8) & 0xFF;
+			buf[len++] = (cmd->writecnt >> 16) & 0xFF;
+			buf[len++] = (cmd->readcnt >> 0) & 0xFF;
+			buf[len++] = (cmd->readcnt >> 8) & 0xFF;
+			buf[len++] = (cmd->readcnt >> 16) & 0xFF;
+			memcpy(buf + len, cmd->writearr, cmd->writecnt);
+			len += cmd->writecnt;
+		}
+		if (write(sp_fd, buf, len) != len) {
+			msg_perr("Error: cannot write SPI operations: %s\n", strerror(errno));
+			free(buf);
+			return 1;
+		}
+		free(buf);
+		/* Every operation in flight has to be answered, even after a NAK. */
+		for (cmd = cmds; cmd != end; cmd++) {
+			if (!sp_read_reply(cmd->readcnt, cmd->readarr))
+				continue;
+			if (cmd->io & SPI_IO_POLL)
+				polled = 1;
+			else
+				ret = 1;
+		}
 		if (ret)
 			return ret;
+		if (polled)
+			return SPI_POLL_TIMEOUT;
+		cmds = end;
 	}
 	return 0;
 }
+
+/* Let the device read the chip until it is ready. Returns 0 if it is, 1 if the
+ * device gave up.
+ */
+static int sp_poll(uint8_t type, uint32_t addr, uint8_t mask, uint8_t value,
+		   uint32_t timeout_us)
+{
+	unsigned char parms[10];
+	uint8_t last;
+
+	msg_pspew("%s: type=%i addr=0x%x mask=0x%02x value=0x%02x timeout=%u\n",
+		  __func__, type, addr, mask, value, timeout_us);
+	if ((sp_opbuf_usage) || (sp_max_write_n && sp_write_n_bytes))
+		sp_execute_opbuf();
+	parms[0] = type;
+	parms[1] = (addr >> 0) & 0xFF;
+	parms[2] = (addr >> 8) & 0xFF;
+	parms[3] = (addr >> 16) & 0xFF;
+	parms[4] = mask;
+	parms[5] = value;
+	parms[6] = (timeout_us >> 0) & 0xFF;
+	parms[7] = (timeout_us >> 8) & 0xFF;
+	parms[8] = (timeout_us >> 16) & 0xFF;
+	parms[9] = (timeout_us >> 24) & 0xFF;
+	if (sp_docommand(S_CMD_O_POLL, sizeof(parms), parms, 1, &last))
+		return 1;
+	msg_pspew("%s: ready, last read 0x%02x\n", __func__, last);
+	return 0;
+}
+
+static int serprog_spi_poll_status(struct flashctx *flash, uint8_t opcode,
+				   uint8_t mask, unsigned int timeout_us)
+{
+	return sp_poll(S_POLL_SPI_STATUS, 0, mask, opcode, timeout_us);
+}
+
+static int serprog_chip_poll(const struct flashctx *flash,
+			     enum par_poll_type type, chipaddr addr,
+			     uint8_t mask, uint8_t value,
+			     unsigned int timeout_us)
+{
+	switch (type) {
+	case POLL_TOGGLE:
+		return sp_poll(S_POLL_TOGGLE, addr, mask, 0, timeout_us);
+	case POLL_DATA:
+		return sp_poll(S_POLL_DATA, addr, mask, value, timeout_us);
+	default:
+		return -1;
+	}
+}
+
+static int serprog_spi_read(struct flashctx *flash, uint8_t *buf,
+			    unsigned int start, unsigned int len)
+{
+	int ret;
+
+	if (!sp_tagged_ops)
+		return spi_read_chunked(flash, buf, start, len,
+					spi_programmer_serprog.max_data_read);
+	/* The data arrives in the buffer while the next reads are already on
+	 * their way.
+	 */
+	sp_tagged_defer = 1;
+	sp_tagged_rle = sp_rle;
+	ret = spi_read_chunked(flash, buf, start, len, SP_TSPIOP_READ_CHUNK);
+	sp_tagged_defer = 0;
+	sp_tagged_rle = 0;
+	return ret | sp_tagged_drain();
+}
@@ -23,3 +23,15 @@
 #define S_CMD_O_SPIOP		0x13	/* Perform SPI operation.			*/
 #define S_CMD_S_SPI_FREQ	0x14	/* Set SPI clock frequency			*/
 #define S_CMD_S_PIN_STATE	0x15	/* Enable/disable output drivers		*/
+#define S_CMD_O_POLL		0x16	/* Wait until the flash chip is ready		*/
+#define S_CMD_O_TSPIOP		0x17	/* Perform tagged SPI operation (protocol v2)	*/
+#define S_CMD_R_NBYTES_RLE	0x18	/* Read n bytes, run-length encoded		*/
+
+/* Poll types of S_CMD_O_POLL */
+#define S_POLL_SPI_STATUS	0x00	/* SPI status register bits in mask clear	*/
+#define S_POLL_TOGGLE		0x01	/* Bits in mask stop toggling			*/
+#define S_POLL_DATA		0x02	/* Bits in mask equal value			*/
+
+/* Flags of S_CMD_O_TSPIOP */
+#define S_TSPIOP_CRC		0x01	/* Request and reply end with a CRC-16		*/
+#define S_TSPIOP_RLE		0x02	/* Reply data is run-length encoded		*/
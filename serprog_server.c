@@ -0,0 +1,818 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Device side of the serprog protocol (see Documentation/serprog-protocol.txt).
+ * "flashrom --serve serprog:port=N" exports the programmer given with -p over
+ * TCP on the loopback interface, add ",ip=A" to listen on address A instead.
+ * "--serve serprog:pty" exports it over a pseudo terminal. Requests are forwarded to
+ * the registered SPI or parallel programmer.
+ */
+
+/* For posix_openpt() and friends. */
+#define _XOPEN_SOURCE 600
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "flash.h"
+#include "programmer.h"
+#include "spi.h"
+#include "serprog.h"
+
+#define MSGHEADER "serprog server: "
+
+#define SERVE_OPBUF_SIZE	4096
+/* TCP has flow control, the pty buffer of the kernel is small. */
+#define SERVE_SERBUF_TCP	0xffff
+#define SERVE_SERBUF_PTY	4096
+/* Longer requests are refused. */
+#define SERVE_MAX_LEN		(16 * 1024 * 1024)
+/* Input bytes per run-length encoded chunk. */
+#define SERVE_RLE_CHUNK		4096
+/* Address lines of the parallel bus, a 16 MB window below 4 GB is mapped. */
+#define SERVE_ADDR_LINES	24
+
+static int serve_fd = -1;
+static uint16_t serve_serbuf_size;
+static volatile sig_atomic_t serve_stop = 0;
+
+static unsigned char serve_inbuf[4096];
+static unsigned int serve_inpos = 0, serve_inlen = 0;
+static unsigned char *serve_outbuf = NULL;
+static unsigned int serve_outlen = 0, serve_outsize = 0;
+
+static struct flashchip serve_chip = {
+	.vendor		= "serprog",
+	.name		= "client",
+	.total_size	= (1 << SERVE_ADDR_LINES) / 1024,
+};
+static struct flashctx serve_spi = { .chip = &serve_chip };
+static struct flashctx serve_par = { .chip = &serve_chip };
+static enum chipbustype serve_buses = BUS_NONE;
+static uint8_t serve_cmdmap[32];
+static const char serve_pgmname[16] = "flashrom serve";
+
+/* Operation buffer, holds the requests as they were received. */
+static unsigned char serve_opbuf[SERVE_OPBUF_SIZE];
+static unsigned int serve_opbuf_len = 0;
+
+static void serve_sigint(int sig)
+{
+	serve_stop = 1;
+}
+
+/* Send all queued replies. Returns 0 on success. */
+static int serve_flush(void)
+{
+	unsigned int done = 0;
+	ssize_t r;
+
+	while (done < serve_outlen) {
+		r = write(serve_fd, serve_outbuf + done, serve_outlen - done);
+		if (r < 0 && errno == EINTR && !serve_stop)
+			continue;
+		if (r <= 0)
+			return 1;
+		done += r;
+	}
+	serve_outlen = 0;
+	return 0;
+}
+
+/* Replies are queued and only sent when no further request is waiting, so
+ * pipelined requests are answered in one go.
+ */
+static void serve_reply(const void *buf, unsigned int len)
+{
+	if (serve_outlen + len > serve_outsize) {
+		serve_outsize = max(serve_outsize * 2, serve_outlen + len);
+		serve_outbuf = realloc(serve_outbuf, serve_outsize);
+		if (!serve_outbuf) {
+			msg_gerr("Out of memory!\n");
+			exit(1);
+		}
+	}
+	memcpy(serve_outbuf + serve_outlen, buf, len);
+	serve_outlen += len;
+}
+
+static void serve_reply_byte(uint8_t c)
+{
+	serve_reply(&c, 1);
+}
+
+/* Read @len bytes of the request. Returns 0 on success, 1 if the client is
+ * gone or flashrom is interrupted.
+ */
+static int serve_read(void *buf, unsigned int len)
+{
+	unsigned int n;
+	ssize_t r;
+
+	while (len) {
+		if (serve_inpos == serve_inlen) {
+			if (serve_flush())
+				return 1;
+			do {
+				r = read(serve_fd, serve_inbuf, sizeof(serve_inbuf));
+			} while (r < 0 && errno == EINTR && !serve_stop);
+			if (r <= 0)
+				return 1;
+			serve_inpos = 0;
+			serve_inlen = r;
+		}
+		n = min(len, serve_inlen - serve_inpos);
+		if (buf) {
+			memcpy(buf, serve_inbuf + serve_inpos, n);
+			buf += n;
+		}
+		serve_inpos += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/* Queue @len bytes run-length encoded, in chunks of up to SERVE_RLE_CHUNK
+ * input bytes. See S_CMD_R_NBYTES_RLE in serprog-protocol.txt.
+ */
+static void serve_reply_rle(const unsigned char *buf, unsigned int len)
+{
+	unsigned char out[2 + SERVE_RLE_CHUNK + SERVE_RLE_CHUNK / 128 + 1];
+	unsigned int i, j, end, run, outlen;
+
+	for (; len; buf += end, len -= end) {
+		end = min(len, SERVE_RLE_CHUNK);
+		outlen = 2;
+		for (i = 0; i < end; ) {
+			for (run = 1; i + run < end && run < 130 && buf[i + run] == buf[i]; run++)
+				;
+			if (run >= 3) {
+				out[outlen++] = 0x80 + run - 3;
+				out[outlen++] = buf[i];
+				i += run;
+				continue;
+			}
+			/* Literal bytes up to the next run of three. */
+			for (j = i + 1; j < end && j - i < 128; j++) {
+				if (j + 2 < end && buf[j] == buf[j + 1] && buf[j] == buf[j + 2])
+					break;
+			}
+			out[outlen++] = j - i - 1;
+			memcpy(out + outlen, buf + i, j - i);
+			outlen += j - i;
+			i = j;
+		}
+		out[0] = (outlen - 2) & 0xff;
+		out[1] = (outlen - 2) >> 8;
+		serve_reply(out, outlen);
+	}
+}
+
+static uint32_t get_le(const unsigned char *buf, int bytes)
+{
+	uint32_t val = 0;
+	int i;
+
+	for (i = bytes - 1; i >= 0; i--)
+		val = (val << 8) | buf[i];
+	return val;
+}
+
+static void put_le(unsigned char *buf, uint32_t val, int bytes)
+{
+	int i;
+
+	for (i = 0; i < bytes; i++)
+		buf[i] = (val >> (8 * i)) & 0xff;
+}
+
+/* Returns nonzero if @len bytes at @addr don't fit into the mapped window. */
+static int serve_check_window(uint32_t addr, uint32_t len)
+{
+	return addr + len > 1 << SERVE_ADDR_LINES;
+}
+
+static void serve_set_cmd(uint8_t cmd)
+{
+	serve_cmdmap[cmd / 8] |= 1 << (cmd % 8);
+}
+
+static int serve_cmd_supported(uint8_t cmd)
+{
+	return (serve_cmdmap[cmd / 8] >> (cmd % 8)) & 1;
+}
+
+static uint32_t serve_max_write(void)
+{
+	uint32_t max = SERVE_OPBUF_SIZE - 7;
+
+	if (serve_buses & BUS_SPI && serve_spi.pgm->spi.max_data_write != MAX_DATA_UNSPECIFIED)
+		max = min(max, serve_spi.pgm->spi.max_data_write);
+	else if (serve_buses & BUS_SPI)
+		max = min(max, 256);
+	return max;
+}
+
+static uint32_t serve_max_read(void)
+{
+	if (serve_spi.pgm->spi.max_data_read == MAX_DATA_UNSPECIFIED)
+		return 64 * 1024;
+	return serve_spi.pgm->spi.max_data_read;
+}
+
+/* Commands with 4-byte addresses, or which switch the chip to them. */
+static int serve_spi_4ba(uint8_t opcode)
+{
+	switch (opcode) {
+	case JEDEC_ENTER_4BA:
+	case JEDEC_READ_4BA:
+	case JEDEC_FAST_READ_4BA:
+	case JEDEC_DUAL_OUT_READ_4BA:
+	case JEDEC_QUAD_OUT_READ_4BA:
+	case JEDEC_BYTE_PROGRAM_4BA:
+	case JEDEC_SE_4BA:
+	case JEDEC_BE_5C_4BA:
+	case JEDEC_BE_DC_4BA:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* Forward an SPI command. Plain reads longer than the programmer can do at
+ * once are split. Commands with 4-byte addresses are refused if the
+ * programmer can't send them.
+ */
+static int serve_spi_command(unsigned int writecnt, unsigned int readcnt,
+			     const unsigned char *writearr, unsigned char *readarr)
+{
+	unsigned int addr, done, len, alen, i, max_read = serve_max_read();
+	unsigned char cmd[JEDEC_READ_4BA_OUTSIZE + 1];
+
+	if (writecnt && serve_spi_4ba(writearr[0]) &&
+	    !(serve_spi.pgm->spi.io_modes & SPI_IO_4BA)) {
+		msg_pdbg("Refusing opcode 0x%02x, the programmer can't send 4-byte addresses.\n",
+			 writearr[0]);
+		return 1;
+	}
+	switch (writecnt ? writearr[0] : 0) {
+	case JEDEC_READ:
+		alen = 3;
+		break;
+	case JEDEC_READ_4BA:
+	case JEDEC_FAST_READ_4BA:
+		alen = 4;
+		break;
+	default:
+		alen = 0;
+		break;
+	}
+	/* Anything after the address, e.g. the dummy byte of a fast read, is
+	 * sent again with each part.
+	 */
+	if (!alen || writecnt <= alen || writecnt > sizeof(cmd) || readcnt <= max_read)
+		return spi_send_command(&serve_spi, writecnt, readcnt, writearr, readarr);
+	memcpy(cmd, writearr, writecnt);
+	addr = 0;
+	for (i = 1; i <= alen; i++)
+		addr = (addr << 8) | writearr[i];
+	for (done = 0; done < readcnt; done += len) {
+		len = min(max_read, readcnt - done);
+		for (i = 1; i <= alen; i++)
+			cmd[i] = ((addr + done) >> (8 * (alen - i))) & 0xff;
+		if (spi_send_command(&serve_spi, writecnt, len, cmd, readarr + done))
+			return 1;
+	}
+	return 0;
+}
+
+static int serve_spi_status(uint8_t opcode, uint8_t *status)
+{
+	return spi_send_command(&serve_spi, 1, 1, &opcode, status);
+}
+
+/* Returns 0 when the chip is ready, 1 on timeout or error. */
+static int serve_poll(const unsigned char *parms, uint8_t *last)
+{
+	uint8_t type = parms[0], mask = parms[4], value = parms[5], prev;
+	uint32_t addr = get_le(parms + 1, 3), timeout = get_le(parms + 6, 4);
+	chipaddr dst = serve_par.virtual_memory + addr;
+	uint64_t start = timestamp_usecs();
+	int ret;
+
+	switch (type) {
+	case S_POLL_SPI_STATUS:
+		if (!(serve_buses & BUS_SPI))
+			return 1;
+		ret = spi_poll_status(&serve_spi, value, mask, timeout);
+		if (ret > 0)
+			return 1;
+		do {
+			if (serve_spi_status(value, last))
+				return 1;
+			if (!(*last & mask))
+				return 0;
+		} while (timestamp_usecs() - start < timeout);
+		return 1;
+	case S_POLL_TOGGLE:
+	case S_POLL_DATA:
+		if (!(serve_buses & BUS_NONSPI))
+			return 1;
+		ret = chip_poll(&serve_par, type == S_POLL_TOGGLE ? POLL_TOGGLE : POLL_DATA, dst,
+				mask, value, timeout);
+		if (ret > 0)
+			return 1;
+		prev = chip_readb(&serve_par, dst);
+		do {
+			*last = chip_readb(&serve_par, dst);
+			if (type == S_POLL_TOGGLE && !((*last ^ prev) & mask))
+				return 0;
+			if (type == S_POLL_DATA && !((*last ^ value) & mask))
+				return 0;
+			prev = *last;
+		} while (timestamp_usecs() - start < timeout);
+		return 1;
+	default:
+		return 1;
+	}
+}
+
+/* Run the operation buffer, see serprog_chip_writeb() and friends. */
+static void serve_exec_opbuf(void)
+{
+	unsigned int pos = 0, len;
+
+	while (pos < serve_opbuf_len) {
+		switch (serve_opbuf[pos]) {
+		case S_CMD_O_WRITEB:
+			chip_writeb(&serve_par, serve_opbuf[pos + 4],
+				    serve_par.virtual_memory + get_le(serve_opbuf + pos + 1, 3));
+			pos += 5;
+			break;
+		case S_CMD_O_WRITEN:
+			len = get_le(serve_opbuf + pos + 1, 3);
+			chip_writen(&serve_par, serve_opbuf + pos + 7,
+				    serve_par.virtual_memory + get_le(serve_opbuf + pos + 4, 3), len);
+			pos += 7 + len;
+			break;
+		case S_CMD_O_DELAY:
+			programmer_delay(get_le(serve_opbuf + pos + 1, 4));
+			pos += 5;
+			break;
+		}
+	}
+	serve_opbuf_len = 0;
+}
+
+/* Append an operation to the buffer. Writes outside of the mapped window are
+ * refused here, so serve_exec_opbuf() doesn't have to check. Returns S_ACK or
+ * S_NAK.
+ */
+static uint8_t serve_add_op(uint8_t cmd, unsigned int parmlen, unsigned int datalen)
+{
+	unsigned char *op = serve_opbuf + serve_opbuf_len;
+
+	if (serve_opbuf_len + 1 + parmlen + datalen > SERVE_OPBUF_SIZE) {
+		serve_read(NULL, parmlen + datalen);
+		return S_NAK;
+	}
+	op[0] = cmd;
+	if (serve_read(op + 1, parmlen + datalen))
+		return S_NAK;
+	if (cmd == S_CMD_O_WRITEB && serve_check_window(get_le(op + 1, 3), 1))
+		return S_NAK;
+	serve_opbuf_len += 1 + parmlen + datalen;
+	return S_ACK;
+}
+
+/* O_SPIOP and O_TSPIOP. Returns 1 if the client is gone. */
+static int serve_spiop(int tagged)
+{
+	unsigned char hdr[10], crcbuf[2], ack[2];
+	unsigned int hdrlen = tagged ? 10 : 6, lenbytes = tagged ? 4 : 3;
+	unsigned int writecnt, readcnt;
+	unsigned char *buf;
+	uint16_t crc;
+	int ok;
+
+	if (serve_read(hdr, hdrlen))
+		return 1;
+	writecnt = get_le(hdr + hdrlen - 2 * lenbytes, lenbytes);
+	readcnt = get_le(hdr + hdrlen - lenbytes, lenbytes);
+	ok = writecnt <= SERVE_MAX_LEN && readcnt <= SERVE_MAX_LEN;
+	if (tagged)
+		ok = ok && !(hdr[1] & ~(S_TSPIOP_CRC | S_TSPIOP_RLE));
+	if (!ok) {
+		/* Unknown flags may mean unknown trailing data, the stream is
+		 * lost anyway. Skip the data and the CRC so the next request
+		 * is found.
+		 */
+		if (serve_read(NULL, writecnt))
+			return 1;
+		if (tagged && hdr[1] & S_TSPIOP_CRC && serve_read(NULL, 2))
+			return 1;
+		serve_reply_byte(S_NAK);
+		if (tagged)
+			serve_reply_byte(hdr[0]);
+		return 0;
+	}
+	buf = malloc(writecnt + readcnt);
+	if (!buf) {
+		msg_gerr("Out of memory!\n");
+		exit(1);
+	}
+	if (serve_read(buf, writecnt)) {
+		free(buf);
+		return 1;
+	}
+	if (tagged && hdr[1] & S_TSPIOP_CRC) {
+		if (serve_read(crcbuf, sizeof(crcbuf))) {
+			free(buf);
+			return 1;
+		}
+		ack[0] = S_CMD_O_TSPIOP;
+		crc = serprog_crc16(0xffff, ack, 1);
+		crc = serprog_crc16(crc, hdr, hdrlen);
+		crc = serprog_crc16(crc, buf, writecnt);
+		ok = crc == get_le(crcbuf, 2);
+	}
+	ok = ok && !serve_spi_command(writecnt, readcnt, buf, buf + writecnt);
+	ack[0] = ok ? S_ACK : S_NAK;
+	ack[1] = hdr[0];
+	serve_reply(ack, tagged ? 2 : 1);
+	if (ok) {
+		if (tagged && hdr[1] & S_TSPIOP_RLE)
+			serve_reply_rle(buf + writecnt, readcnt);
+		else
+			serve_reply(buf + writecnt, readcnt);
+		if (tagged && hdr[1] & S_TSPIOP_CRC) {
+			crc = serprog_crc16(0xffff, ack, 2);
+			crc = serprog_crc16(crc, buf + writecnt, readcnt);
+			put_le(crcbuf, crc, 2);
+			serve_reply(crcbuf, sizeof(crcbuf));
+		}
+	}
+	free(buf);
+	return 0;
+}
+
+/* Handle one request. Returns 1 if the client is gone. */
+static int serve_command(void)
+{
+	unsigned char parms[10], *buf;
+	uint8_t cmd, c;
+	uint32_t len;
+
+	if (serve_read(&cmd, 1))
+		return 1;
+	msg_pspew(MSGHEADER "command 0x%02x\n", cmd);
+	if (cmd != S_CMD_SYNCNOP && !serve_cmd_supported(cmd)) {
+		serve_reply_byte(S_NAK);
+		return 0;
+	}
+	switch (cmd) {
+	case S_CMD_NOP:
+		serve_reply_byte(S_ACK);
+		break;
+	case S_CMD_O_INIT:
+		serve_opbuf_len = 0;
+		serve_reply_byte(S_ACK);
+		break;
+	case S_CMD_SYNCNOP:
+		serve_reply_byte(S_NAK);
+		serve_reply_byte(S_ACK);
+		break;
+	case S_CMD_Q_IFACE:
+		put_le(parms, 1, 2);
+		serve_reply_byte(S_ACK);
+		serve_reply(parms, 2);
+		break;
+	case S_CMD_Q_CMDMAP:
+		serve_reply_byte(S_ACK);
+		serve_reply(serve_cmdmap, sizeof(serve_cmdmap));
+		break;
+	case S_CMD_Q_PGMNAME:
+		serve_reply_byte(S_ACK);
+		serve_reply(serve_pgmname, sizeof(serve_pgmname));
+		break;
+	case S_CMD_Q_SERBUF:
+		put_le(parms, serve_serbuf_size, 2);
+		serve_reply_byte(S_ACK);
+		serve_reply(parms, 2);
+		break;
+	case S_CMD_Q_BUSTYPE:
+		serve_reply_byte(S_ACK);
+		serve_reply_byte(serve_buses & 0xff);
+		break;
+	case S_CMD_Q_CHIPSIZE:
+		serve_reply_byte(S_ACK);
+		serve_reply_byte(SERVE_ADDR_LINES);
+		break;
+	case S_CMD_Q_OPBUF:
+		put_le(parms, SERVE_OPBUF_SIZE, 2);
+		serve_reply_byte(S_ACK);
+		serve_reply(parms, 2);
+		break;
+	case S_CMD_Q_WRNMAXLEN:
+		put_le(parms, serve_max_write(), 3);
+		serve_reply_byte(S_ACK);
+		serve_reply(parms, 3);
+		break;
+	case S_CMD_Q_RDNMAXLEN:
+		put_le(parms, serve_max_read(), 3);
+		serve_reply_byte(S_ACK);
+		serve_reply(parms, 3);
+		break;
+	case S_CMD_S_BUSTYPE:
+		if (serve_read(&c, 1))
+			return 1;
+		serve_reply_byte((c & ~serve_buses) ? S_NAK : S_ACK);
+		break;
+	case S_CMD_R_BYTE:
+		if (serve_read(parms, 3))
+			return 1;
+		c = chip_readb(&serve_par, serve_par.virtual_memory + get_le(parms, 3));
+		serve_reply_byte(S_ACK);
+		serve_reply_byte(c);
+		break;
+	case S_CMD_R_NBYTES:
+	case S_CMD_R_NBYTES_RLE:
+		if (serve_read(parms, 6))
+			return 1;
+		/* R_NBYTES_RLE also stands for RLE support on SPI. */
+		if (!(serve_buses & BUS_NONSPI)) {
+			serve_reply_byte(S_NAK);
+			break;
+		}
+		len = get_le(parms + 3, 3);
+		if (!len)
+			len = 1 << 24;
+		if (serve_check_window(get_le(parms, 3), len)) {
+			serve_reply_byte(S_NAK);
+			break;
+		}
+		buf = malloc(len);
+		if (!buf) {
+			msg_gerr("Out of memory!\n");
+			exit(1);
+		}
+		chip_readn(&serve_par, buf, serve_par.virtual_memory + get_le(parms, 3), len);
+		serve_reply_byte(S_ACK);
+		if (cmd == S_CMD_R_NBYTES_RLE)
+			serve_reply_rle(buf, len);
+		else
+			serve_reply(buf, len);
+		free(buf);
+		break;
+	case S_CMD_O_WRITEB:
+		serve_reply_byte(serve_add_op(cmd, 4, 0));
+		break;
+	case S_CMD_O_WRITEN:
+		/* The length has to be known before the data is read. */
+		if (serve_read(parms, 3))
+			return 1;
+		len = get_le(parms, 3);
+		if (!len || serve_opbuf_len + 7 + len > SERVE_OPBUF_SIZE) {
+			serve_read(NULL, 3 + len);
+			serve_reply_byte(S_NAK);
+			break;
+		}
+		serve_opbuf[serve_opbuf_len] = cmd;
+		memcpy(serve_opbuf + serve_opbuf_len + 1, parms, 3);
+		if (serve_read(serve_opbuf + serve_opbuf_len + 4, 3 + len))
+			return 1;
+		if (serve_check_window(get_le(serve_opbuf + serve_opbuf_len + 4, 3), len)) {
+			serve_reply_byte(S_NAK);
+			break;
+		}
+		serve_opbuf_len += 7 + len;
+		serve_reply_byte(S_ACK);
+		break;
+	case S_CMD_O_DELAY:
+		serve_reply_byte(serve_add_op(cmd, 4, 0));
+		break;
+	case S_CMD_O_EXEC:
+		serve_exec_opbuf();
+		serve_reply_byte(S_ACK);
+		break;
+	case S_CMD_O_SPIOP:
+		return serve_spiop(0);
+	case S_CMD_O_TSPIOP:
+		return serve_spiop(1);
+	case S_CMD_O_POLL:
+		if (serve_read(parms, 10))
+			return 1;
+		c = 0;
+		if (serve_poll(parms, &c)) {
+			serve_reply_byte(S_NAK);
+		} else {
+			serve_reply_byte(S_ACK);
+			serve_reply_byte(c);
+		}
+		break;
+	default:
+		serve_reply_byte(S_NAK);
+		break;
+	}
+	return 0;
+}
+
+static void serve_session(void)
+{
+	serve_inpos = serve_inlen = 0;
+	serve_outlen = 0;
+	serve_opbuf_len = 0;
+	while (!serve_stop && !serve_command())
+		;
+	serve_flush();
+}
+
+static int serve_tcp(const char *ip, unsigned int port)
+{
+	union { struct sockaddr_in si; struct sockaddr s; } addr = {};
+	int sock, flag = 1;
+
+	addr.si.sin_family = AF_INET;
+	addr.si.sin_port = htons(port);
+	addr.si.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (ip && inet_pton(AF_INET, ip, &addr.si.sin_addr) != 1) {
+		msg_gerr("Error: invalid address \"%s\" to listen on.\n", ip);
+		return 1;
+	}
+	sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0) {
+		msg_gerr("Error: cannot open socket: %s\n", strerror(errno));
+		return 1;
+	}
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+	if (bind(sock, &addr.s, sizeof(addr.si)) || listen(sock, 1)) {
+		msg_gerr("Error: cannot listen on port %u: %s\n", port, strerror(errno));
+		close(sock);
+		return 1;
+	}
+	serve_serbuf_size = SERVE_SERBUF_TCP;
+	msg_ginfo("Serving serprog on %s port %u, press Ctrl-C to stop.\n",
+		  inet_ntoa(addr.si.sin_addr), port);
+	while (!serve_stop) {
+		serve_fd = accept(sock, NULL, NULL);
+		if (serve_fd < 0) {
+			if (errno == EINTR)
+				continue;
+			msg_gerr("Error: accept failed: %s\n", strerror(errno));
+			break;
+		}
+		/* Replies are sent once per batch of requests anyway. */
+		setsockopt(serve_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+		msg_ginfo("Client connected.\n");
+		serve_session();
+		close(serve_fd);
+		msg_ginfo("Client disconnected.\n");
+	}
+	close(sock);
+	return 0;
+}
+
+static int serve_pty(void)
+{
+	struct termios tio;
+	char *name;
+
+	serve_fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (serve_fd < 0 || grantpt(serve_fd) || unlockpt(serve_fd) || !(name = ptsname(serve_fd))) {
+		msg_gerr("Error: cannot create a pseudo terminal: %s\n", strerror(errno));
+		return 1;
+	}
+	/* Same settings as sp_openserport() uses on the other end. */
+	if (!tcgetattr(serve_fd, &tio)) {
+		tio.c_cflag &= ~(PARENB | CSTOPB | CSIZE);
+		tio.c_cflag |= (CS8 | CLOCAL | CREAD);
+		tio.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
+		tio.c_iflag &= ~(IXON | IXOFF | IXANY | ICRNL | IGNCR | INLCR);
+		tio.c_oflag &= ~OPOST;
+		tcsetattr(serve_fd, TCSANOW, &tio);
+	}
+	serve_serbuf_size = SERVE_SERBUF_PTY;
+	msg_ginfo("Serving serprog on %s, use -p serprog:dev=%s:115200 and press Ctrl-C to stop.\n",
+		  name, name);
+	/* Reads fail while no client has the terminal open. */
+	while (!serve_stop) {
+		serve_session();
+		if (!serve_stop)
+			usleep(100 * 1000);
+	}
+	close(serve_fd);
+	return 0;
+}
+
+/* Serve the registered programmers as described by @spec, until interrupted. */
+int serve_serprog(const char *spec)
+{
+	struct sigaction sa = { .sa_handler = serve_sigint };
+	struct sigaction oldint, oldterm;
+	int port = -1, pty = 0, i, ret;
+	const char *ip = NULL;
+	char *end;
+
+	if (!strncmp(spec, "serprog:port=", 13)) {
+		port = strtol(spec + 13, &end, 10);
+		if (!strncmp(end, ",ip=", 4)) {
+			ip = end + 4;
+			end += strlen(end);
+		}
+		if (*end || port <= 0 || port > 65535)
+			port = -1;
+	} else if (!strcmp(spec, "serprog:pty")) {
+		pty = 1;
+	}
+	if (port < 0 && !pty) {
+		msg_gerr("Error: invalid --serve argument \"%s\", use serprog:port=<port>[,ip=<addr>] "
+			 "or serprog:pty.\n", spec);
+		return 1;
+	}
+
+	for (i = 0; i < registered_programmer_count; i++) {
+		if (registered_programmers[i].buses_supported & BUS_SPI && !(serve_buses & BUS_SPI)) {
+			serve_spi.pgm = &registered_programmers[i];
+			serve_buses |= BUS_SPI;
+		}
+		if (registered_programmers[i].buses_supported & BUS_NONSPI &&
+		    !(serve_buses & BUS_NONSPI)) {
+			serve_par.pgm = &registered_programmers[i];
+			serve_buses |= registered_programmers[i].buses_supported & BUS_NONSPI;
+		}
+	}
+	if (serve_buses == BUS_NONE) {
+		msg_gerr("Error: this programmer can't be served, only SPI and parallel buses "
+			 "are supported.\n");
+		return 1;
+	}
+
+	serve_set_cmd(S_CMD_NOP);
+	serve_set_cmd(S_CMD_Q_IFACE);
+	serve_set_cmd(S_CMD_Q_CMDMAP);
+	serve_set_cmd(S_CMD_Q_PGMNAME);
+	serve_set_cmd(S_CMD_Q_SERBUF);
+	serve_set_cmd(S_CMD_Q_BUSTYPE);
+	serve_set_cmd(S_CMD_Q_OPBUF);
+	serve_set_cmd(S_CMD_Q_WRNMAXLEN);
+	serve_set_cmd(S_CMD_O_INIT);
+	serve_set_cmd(S_CMD_O_DELAY);
+	serve_set_cmd(S_CMD_O_EXEC);
+	serve_set_cmd(S_CMD_SYNCNOP);
+	serve_set_cmd(S_CMD_S_BUSTYPE);
+	serve_set_cmd(S_CMD_O_POLL);
+	if (serve_buses & BUS_NONSPI) {
+		serve_par.virtual_memory = (chipaddr)programmer_map_flash_region("flash chip",
+					   0xffffffff - (1 << SERVE_ADDR_LINES) + 1,
+					   1 << SERVE_ADDR_LINES);
+		serve_set_cmd(S_CMD_Q_CHIPSIZE);
+		serve_set_cmd(S_CMD_R_BYTE);
+		serve_set_cmd(S_CMD_R_NBYTES);
+		serve_set_cmd(S_CMD_R_NBYTES_RLE);
+		serve_set_cmd(S_CMD_O_WRITEB);
+		serve_set_cmd(S_CMD_O_WRITEN);
+	}
+	if (serve_buses & BUS_SPI) {
+		serve_set_cmd(S_CMD_Q_RDNMAXLEN);
+		serve_set_cmd(S_CMD_O_SPIOP);
+		serve_set_cmd(S_CMD_O_TSPIOP);
+		/* Announces the RLE flag of O_TSPIOP as well. */
+		serve_set_cmd(S_CMD_R_NBYTES_RLE);
+	}
+
+	/* No SA_RESTART, blocking calls have to return on Ctrl-C. */
+	sigaction(SIGINT, &sa, &oldint);
+	sigaction(SIGTERM, &sa, &oldterm);
+	signal(SIGPIPE, SIG_IGN);
+	ret = pty ? serve_pty() : serve_tcp(ip, port);
+	sigaction(SIGINT, &oldint, NULL);
+	sigaction(SIGTERM, &oldterm, NULL);
+
+	if (serve_buses & BUS_NONSPI)
+		programmer_unmap_flash_region((void *)serve_par.virtual_memory, 1 << SERVE_ADDR_LINES);
+	free(serve_outbuf);
+	return ret;
+}
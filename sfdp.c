@@ -17,12 +17,14 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "flash.h"
 #include "spi.h"
 #include "chipdrivers.h"
+#include "programmer.h"
 
 static int spi_sfdp_read_sfdp_chunk(struct flashctx *flash, uint32_t address, uint8_t *buf, int len)
 {
@@ -54,16 +56,40 @@ static int spi_sfdp_read_sfdp_chunk(struct flashctx *flash, uint32_t address, ui
 	return 0;
 }
 
+/* Longest SFDP read tried in one command. */
+#define SFDP_MAX_STEP	256
+
+/* Parameter headers read together with the SFDP header. Most chips have no
+ * more, reading past the last one is harmless.
+ */
+#define SFDP_FIRST_HEADERS	4
+
+/* Set once a long SFDP read failed, the rest is read in safe steps. */
+static int sfdp_short_reads = 0;
+
 static int spi_sfdp_read_sfdp(struct flashctx *flash, uint32_t address, uint8_t *buf, int len)
 {
-	/* FIXME: There are different upper bounds for the number of bytes to
-	 * read on the various programmers (even depending on the rest of the
-	 * structure of the transaction). 2 is a safe bet. */
+	/* There are different upper bounds for the number of bytes to read on
+	 * the various programmers (even depending on the rest of the structure
+	 * of the transaction). Try what the programmer claims to support (one
+	 * byte is the dummy byte), and fall back to 2, which is a safe bet.
+	 */
+	unsigned int max_data = flash->pgm->spi.max_data_read;
 	int maxstep = 2;
 	int ret = 0;
+
+	if (!sfdp_short_reads && max_data > 3)
+		maxstep = min(max_data - 1, SFDP_MAX_STEP);
 	while (len > 0) {
 		int step = min(len, maxstep);
 		ret = spi_sfdp_read_sfdp_chunk(flash, address, buf, step);
+		if (ret && step > 2) {
+			msg_cdbg2("Reading %d bytes of SFDP at once failed, "
+				  "retrying in steps of 2 bytes.\n", step);
+			sfdp_short_reads = 1;
+			maxstep = 2;
+			continue;
+		}
 		if (ret)
 			return ret;
 		address += step;
@@ -73,6 +99,11 @@ static int spi_sfdp_read_sfdp(struct flashctx *flash, uint32_t address, uint8_t
 	return ret;
 }
 
+static uint32_t sfdp_le32(const uint8_t *buf)
+{
+	return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
 struct sfdp_tbl_hdr {
 	uint8_t id;
 	uint8_t v_minor;
@@ -125,45 +156,211 @@ static int sfdp_add_uniform_eraser(struct flashchip *chip, uint8_t opcode, uint3
 	return 1;
 }
 
-static int sfdp_fill_flash(struct flashchip *chip, uint8_t *buf, uint16_t len)
+/* Double word @n (counting from 1 like JESD216) of a parameter table. */
+static uint32_t sfdp_dw(const uint8_t *buf, int n)
+{
+	return sfdp_le32(buf + 4 * (n - 1));
+}
+
+/* Fast read parameters are stored in 16 bits: dummy clocks, mode clocks and
+ * the opcode.
+ */
+static void sfdp_fast_read(struct sfdp_params *p, enum sfdp_read_mode mode, uint16_t field)
 {
-	uint8_t opcode_4k_erase = 0xFF;
+	static const char *const names[SFDP_READ_MODES] = {
+		"1-1-2", "1-2-2", "1-1-4", "1-4-4", "2-2-2", "4-4-4",
+	};
+
+	p->read[mode].dummy_cycles = field & 0x1f;
+	p->read[mode].mode_cycles = (field >> 5) & 0x7;
+	p->read[mode].opcode = field >> 8;
+	msg_cdbg2("  Fast read %s: opcode 0x%02x, %d dummy and %d mode clocks.\n",
+		  names[mode], p->read[mode].opcode, p->read[mode].dummy_cycles,
+		  p->read[mode].mode_cycles);
+}
+
+/* Typical times are stored as a count and a unit, (count + 1) * unit. */
+static unsigned int sfdp_time(uint32_t count, uint32_t unit)
+{
+	return (count + 1) * unit;
+}
+
+/* Parse the JEDEC basic flash parameter table in @buf into @p. Tables of
+ * JESD216 (9 double words), of its revisions (16 and more) and of the
+ * preliminary Intel version (4) are understood.
+ */
+static int sfdp_parse_bfpt(struct sfdp_params *p, const uint8_t *buf, unsigned int len)
+{
+	static const unsigned int erase_units_ms[] = { 1, 16, 128, 1000 };
+	static const unsigned int chip_erase_units_ms[] = { 16, 256, 4000, 64000 };
+	unsigned int dwords = len / 4, factor;
 	uint32_t tmp32;
 	uint8_t tmp8;
-	uint32_t total_size; /* in bytes */
-	uint32_t block_size;
 	int j;
 
-	msg_cdbg("Parsing JEDEC flash parameter table... ");
-	if (len != 9 * 4 && len != 4 * 4) {
-		msg_cdbg("%s: len out of spec\n", __func__);
-		return 1;
-	}
-	msg_cdbg2("\n");
-	
-	/* 1. double word */
-	tmp32 =  ((unsigned int)buf[(4 * 0) + 0]);
-	tmp32 |= ((unsigned int)buf[(4 * 0) + 1]) << 8;
-	tmp32 |= ((unsigned int)buf[(4 * 0) + 2]) << 16;
-	tmp32 |= ((unsigned int)buf[(4 * 0) + 3]) << 24;
+	memset(p, 0, sizeof(*p));
+	p->quad_enable = SFDP_QER_UNKNOWN;
 
-	tmp8 = (tmp32 >> 17) & 0x3;
-	switch (tmp8) {
-	case 0x0:
+	/* 1. double word */
+	tmp32 = sfdp_dw(buf, 1);
+	p->addr_mode = (tmp32 >> 17) & 0x3;
+	switch (p->addr_mode) {
+	case SFDP_ADDR_3:
 		msg_cdbg2("  3-Byte only addressing.\n");
 		break;
-	case 0x1:
+	case SFDP_ADDR_3_OR_4:
 		msg_cdbg2("  3-Byte (and optionally 4-Byte) addressing.\n");
 		break;
-	case 0x2:
-		msg_cdbg("  4-Byte only addressing (not supported by "
-			 "flashrom).\n");
-		return 1;
+	case SFDP_ADDR_4:
+		msg_cdbg2("  4-Byte only addressing.\n");
+		break;
 	default:
 		msg_cdbg("  Required addressing mode (0x%x) not supported.\n",
-			 tmp8);
+			 p->addr_mode);
+		return 1;
+	}
+	p->page_size = tmp32 & (1 << 2) ? 64 : 1;
+	p->opcode_4k_erase = (tmp32 & 0x3) == 0x1 ? (tmp32 >> 8) & 0xff : 0;
+
+	/* 2. double word */
+	tmp32 = sfdp_dw(buf, 2);
+	if (tmp32 & (1 << 31)) {
+		if ((tmp32 & 0x7fffffff) < 3 || (tmp32 & 0x7fffffff) >= 64 + 3) {
+			msg_cdbg("Flash chip size 2^%u bits is not supported.\n",
+				 tmp32 & 0x7fffffff);
+			return 1;
+		}
+		p->size = 1ULL << ((tmp32 & 0x7fffffff) - 3);
+	} else {
+		p->size = ((uint64_t)tmp32 + 1) / 8;
+	}
+	msg_cdbg2("  Flash chip size is %llu kB.\n", (unsigned long long)(p->size / 1024));
+
+	if (dwords < 9) {
+		msg_cdbg("  It seems like this chip supports the preliminary "
+			 "Intel version of SFDP, skipping processing of double "
+			 "words 3-9.\n");
+		return 0;
+	}
+
+	/* 3.-7. double word: fast read modes */
+	tmp32 = sfdp_dw(buf, 1);
+	if (tmp32 & (1 << 16))
+		sfdp_fast_read(p, SFDP_READ_1_1_2, sfdp_dw(buf, 4) & 0xffff);
+	if (tmp32 & (1 << 20))
+		sfdp_fast_read(p, SFDP_READ_1_2_2, sfdp_dw(buf, 4) >> 16);
+	if (tmp32 & (1 << 22))
+		sfdp_fast_read(p, SFDP_READ_1_1_4, sfdp_dw(buf, 3) >> 16);
+	if (tmp32 & (1 << 21))
+		sfdp_fast_read(p, SFDP_READ_1_4_4, sfdp_dw(buf, 3) & 0xffff);
+	tmp32 = sfdp_dw(buf, 5);
+	if (tmp32 & (1 << 0))
+		sfdp_fast_read(p, SFDP_READ_2_2_2, sfdp_dw(buf, 6) >> 16);
+	if (tmp32 & (1 << 4))
+		sfdp_fast_read(p, SFDP_READ_4_4_4, sfdp_dw(buf, 7) >> 16);
+
+	/* 8. and 9. double word: erase types */
+	for (j = 0; j < SFDP_ERASE_TYPES; j++) {
+		tmp32 = sfdp_dw(buf, 8 + j / 2) >> (16 * (j % 2));
+		tmp8 = tmp32 & 0xff;
+		if (tmp8 == 0) {
+			msg_cspew("  Erase Sector Type %d is unused.\n", j + 1);
+			continue;
+		}
+		if (tmp8 >= 31) {
+			msg_cdbg2("  Block size of erase Sector Type %d (2^%d) "
+				 "is too big for flashrom.\n", j + 1, tmp8);
+			continue;
+		}
+		p->erase[j].size = 1 << tmp8;
+		p->erase[j].opcode = (tmp32 >> 8) & 0xff;
+		msg_cspew("   Erase Sector Type %d: %d B with opcode 0x%02x\n", j + 1,
+			  p->erase[j].size, p->erase[j].opcode);
+	}
+
+	if (dwords < 11)
+		return 0;
+
+	/* 10. double word: erase times */
+	tmp32 = sfdp_dw(buf, 10);
+	factor = 2 * ((tmp32 & 0xf) + 1);
+	for (j = 0; j < SFDP_ERASE_TYPES; j++) {
+		if (!p->erase[j].size)
+			continue;
+		p->erase[j].typ_us = 1000 * sfdp_time((tmp32 >> (4 + 7 * j)) & 0x1f,
+						      erase_units_ms[(tmp32 >> (9 + 7 * j)) & 0x3]);
+		p->erase[j].max_us = factor * p->erase[j].typ_us;
+		msg_cdbg2("  Erase Sector Type %d takes %u ms, at most %u ms.\n", j + 1,
+			  p->erase[j].typ_us / 1000, p->erase[j].max_us / 1000);
+	}
+
+	/* 11. double word: page size and program times */
+	tmp32 = sfdp_dw(buf, 11);
+	factor = 2 * ((tmp32 & 0xf) + 1);
+	/* Chips with byte granularity don't have a page buffer. */
+	if (p->page_size > 1)
+		p->page_size = 1 << ((tmp32 >> 4) & 0xf);
+	p->page_program_typ_us = sfdp_time((tmp32 >> 8) & 0x1f, tmp32 & (1 << 13) ? 64 : 8);
+	p->page_program_max_us = factor * p->page_program_typ_us;
+	p->byte_program_first_us = sfdp_time((tmp32 >> 14) & 0xf, tmp32 & (1 << 18) ? 8 : 1);
+	p->byte_program_add_us = sfdp_time((tmp32 >> 19) & 0xf, tmp32 & (1 << 23) ? 8 : 1);
+	p->chip_erase_typ_ms = sfdp_time((tmp32 >> 24) & 0x1f,
+					 chip_erase_units_ms[(tmp32 >> 29) & 0x3]);
+	p->chip_erase_max_ms = factor * p->chip_erase_typ_ms;
+	msg_cdbg2("  Page size %u B, page program takes %u us, at most %u us.\n",
+		  p->page_size, p->page_program_typ_us, p->page_program_max_us);
+	msg_cdbg2("  Byte program takes %u us plus %u us per additional byte.\n",
+		  p->byte_program_first_us, p->byte_program_add_us);
+	msg_cdbg2("  Chip erase takes %u ms, at most %u ms.\n", p->chip_erase_typ_ms,
+		  p->chip_erase_max_ms);
+
+	if (dwords < 15)
+		return 0;
+
+	/* 15. double word: quad enable requirements */
+	p->quad_enable = (sfdp_dw(buf, 15) >> 20) & 0x7;
+	msg_cdbg2("  Quad enable requirements 0x%x.\n", p->quad_enable);
+
+	if (dwords < 16)
+		return 0;
+
+	/* 16. double word: entering and leaving 4-Byte addressing */
+	tmp32 = sfdp_dw(buf, 16);
+	p->enter_4b = tmp32 >> 24;
+	p->exit_4b = (tmp32 >> 14) & 0x3ff;
+	msg_cdbg2("  4-Byte addressing enter methods 0x%02x, exit methods 0x%03x.\n",
+		  p->enter_4b, p->exit_4b);
+	return 0;
+}
+
+/* Fill in the dynamic parts of the generic SFDP chip from @p and the first
+ * double word of the table in @buf.
+ */
+static int sfdp_fill_flash(struct flashchip *chip, const struct sfdp_params *p,
+			   const uint8_t *buf)
+{
+	uint32_t tmp32 = sfdp_dw(buf, 1);
+	unsigned int features_4ba = 0;
+	int j;
+
+	if (p->addr_mode == SFDP_ADDR_4) {
+		msg_cdbg("  4-Byte only addressing is not supported by flashrom.\n");
 		return 1;
 	}
+	if (p->size > (1 << 24)) {
+		/* Only entering 4-Byte address mode with 0xb7 is implemented. */
+		if (p->enter_4b & (1 << 0)) {
+			features_4ba = FEATURE_4BA_ENTER;
+		} else if (p->enter_4b & (1 << 1)) {
+			features_4ba = FEATURE_4BA_ENTER_WREN;
+		} else {
+			msg_cdbg("Flash chip size is bigger than what 3-Byte addressing "
+				 "can access and the way to enter 4-Byte addressing is "
+				 "unknown.\n");
+			return 1;
+		}
+	}
+	chip->total_size = p->size / 1024;
 
 	msg_cdbg2("  Status register is ");
 	if (tmp32 & (1 << 3)) {
@@ -180,106 +377,112 @@ static int sfdp_fill_flash(struct flashchip *chip, uint8_t *buf, uint16_t len)
 		msg_cdbg2("non-volatile and the standard does not allow "
 			  "vendors to tell us whether EWSR/WREN is needed for "
 			  "status register writes - assuming EWSR.\n");
-			chip->feature_bits = FEATURE_WRSR_EWSR;
-		}
+		chip->feature_bits = FEATURE_WRSR_EWSR;
+	}
+
+	/* SFDP doesn't describe fast read (0x0b), but all SFDP chips have it. */
+	chip->feature_bits |= FEATURE_FAST_READ | features_4ba;
+	if (p->read[SFDP_READ_1_1_2].opcode)
+		chip->feature_bits |= FEATURE_DUAL_OUT;
 
-	msg_cdbg2("  Write chunk size is ");
-	if (tmp32 & (1 << 2)) {
-		msg_cdbg2("at least 64 B.\n");
-		chip->page_size = 64;
+	/* Whatever the page buffer size, single bytes can be programmed. */
+	chip->gran = write_gran_1byte;
+	if (p->page_size > 1) {
+		chip->page_size = p->page_size;
+		chip->max_write_chunk = p->page_size;
 		chip->write = spi_chip_write_256;
 	} else {
-		msg_cdbg2("1 B only.\n");
 		chip->page_size = 256;
 		chip->write = spi_chip_write_1;
 	}
+	msg_cdbg2("  Write chunk size is %u B.\n", p->page_size);
 
-	if ((tmp32 & 0x3) == 0x1) {
-		opcode_4k_erase = (tmp32 >> 8) & 0xFF;
-		msg_cspew("  4kB erase opcode is 0x%02x.\n", opcode_4k_erase);
-		/* add the eraser later, because we don't know total_size yet */
-	} else
-		msg_cspew("  4kB erase opcode is not defined.\n");
-
-	/* 2. double word */
-	tmp32 =  ((unsigned int)buf[(4 * 1) + 0]);
-	tmp32 |= ((unsigned int)buf[(4 * 1) + 1]) << 8;
-	tmp32 |= ((unsigned int)buf[(4 * 1) + 2]) << 16;
-	tmp32 |= ((unsigned int)buf[(4 * 1) + 3]) << 24;
-
-	if (tmp32 & (1 << 31)) {
-		msg_cdbg("Flash chip size >= 4 Gb/512 MB not supported.\n");
-		return 1;
+	if (p->opcode_4k_erase)
+		sfdp_add_uniform_eraser(chip, p->opcode_4k_erase, 4 * 1024);
+	for (j = 0; j < SFDP_ERASE_TYPES; j++) {
+		if (p->erase[j].size)
+			sfdp_add_uniform_eraser(chip, p->erase[j].opcode, p->erase[j].size);
 	}
-	total_size = ((tmp32 & 0x7FFFFFFF) + 1) / 8;
-	chip->total_size = total_size / 1024;
-	msg_cdbg2("  Flash chip size is %d kB.\n", chip->total_size);
-	if (total_size > (1 << 24)) {
-		msg_cdbg("Flash chip size is bigger than what 3-Byte addressing "
-			 "can access.\n");
-		return 1;
-	}
-
-	if (opcode_4k_erase != 0xFF)
-		sfdp_add_uniform_eraser(chip, opcode_4k_erase, 4 * 1024);
+	return 0;
+}
 
-	/* FIXME: double words 3-7 contain unused fast read information */
+/* Typical duration of @opcode on @len bytes according to SFDP, 0 if unknown. */
+unsigned int sfdp_typical_us(const struct sfdp_params *p, uint8_t opcode, unsigned int len)
+{
+	int j;
 
-	if (len == 4 * 4) {
-		msg_cdbg("  It seems like this chip supports the preliminary "
-			 "Intel version of SFDP, skipping processing of double "
-			 "words 3-9.\n");
-		goto done;
+	switch (opcode) {
+	case JEDEC_BYTE_PROGRAM:
+		if (!p->page_program_typ_us || !len)
+			return 0;
+		return min(p->byte_program_first_us + (len - 1) * p->byte_program_add_us,
+			   p->page_program_typ_us);
+	case JEDEC_CE_60:
+	case JEDEC_CE_C7:
+		return p->chip_erase_typ_ms * 1000;
+	default:
+		for (j = 0; j < SFDP_ERASE_TYPES; j++) {
+			if (p->erase[j].opcode == opcode && p->erase[j].size == len)
+				return p->erase[j].typ_us;
+		}
+		return 0;
 	}
+}
 
-	/* 8. double word */
-	for (j = 0; j < 4; j++) {
-		/* 7 double words from the start + 2 bytes for every eraser */
-		tmp8 = buf[(4 * 7) + (j * 2)];
-		msg_cspew("   Erase Sector Type %d Size: 0x%02x\n", j + 1,
-			  tmp8);
-		if (tmp8 == 0) {
-			msg_cspew("  Erase Sector Type %d is unused.\n", j);
-			continue;
-		}
-		if (tmp8 >= 31) {
-			msg_cdbg2("  Block size of erase Sector Type %d (2^%d) "
-				 "is too big for flashrom.\n", j, tmp8);
-			continue;
-		}
-		block_size = 1 << (tmp8); /* block_size = 2 ^ field */
+/* Whether quad output reads work as is. QE is not touched, it is non-volatile
+ * on most chips and turns /WP or /HOLD into IO2 and IO3.
+ */
+static int sfdp_quad_enabled(struct flashctx *flash, const struct sfdp_params *p)
+{
+	unsigned char opcode, sr;
+	uint8_t mask;
 
-		tmp8 = buf[(4 * 7) + (j * 2) + 1];
-		msg_cspew("   Erase Sector Type %d Opcode: 0x%02x\n", j + 1,
-			  tmp8);
-		sfdp_add_uniform_eraser(chip, tmp8, block_size);
+	if (!p->read[SFDP_READ_1_1_4].opcode)
+		return 0;
+	switch (p->quad_enable) {
+	case 0x0:
+		/* No QE bit, IO2 and IO3 are always available. */
+		return 1;
+	case 0x2:
+		opcode = JEDEC_RDSR;
+		mask = 1 << 6;
+		break;
+	case 0x3:
+		opcode = 0x3f;
+		mask = 1 << 7;
+		break;
+	case 0x5:
+		opcode = 0x35;
+		mask = 1 << 1;
+		break;
+	default:
+		/* Unknown, or no defined way to read the QE bit. */
+		return 0;
 	}
-
-done:
-	msg_cdbg("done.\n");
-	return 0;
+	if (spi_send_command(flash, sizeof(opcode), sizeof(sr), &opcode, &sr))
+		return 0;
+	msg_cdbg2("Quad enable bit is %s.\n", sr & mask ? "set" : "clear");
+	return !!(sr & mask);
 }
 
-int probe_spi_sfdp(struct flashctx *flash)
+static int sfdp_parse_tables(struct flashctx *flash, struct sfdp_params *params)
 {
 	int ret = 0;
-	uint8_t buf[8];
+	uint8_t buf[8 + SFDP_FIRST_HEADERS * 8];
 	uint32_t tmp32;
 	uint8_t nph;
 	/* need to limit the table loop by comparing i to uint8_t nph hence: */
-	uint16_t i;
+	uint16_t i, first;
 	struct sfdp_tbl_hdr *hdrs;
 	uint8_t *hbuf;
 	uint8_t *tbuf;
 
-	if (spi_sfdp_read_sfdp(flash, 0x00, buf, 4)) {
+	/* The header and the first parameter headers in one go. */
+	if (spi_sfdp_read_sfdp(flash, 0x00, buf, sizeof(buf))) {
 		msg_cdbg("Receiving SFDP signature failed.\n");
 		return 0;
 	}
-	tmp32 = buf[0];
-	tmp32 |= ((unsigned int)buf[1]) << 8;
-	tmp32 |= ((unsigned int)buf[2]) << 16;
-	tmp32 |= ((unsigned int)buf[3]) << 24;
+	tmp32 = sfdp_le32(buf);
 
 	if (tmp32 != 0x50444653) {
 		msg_cdbg2("Signature = 0x%08x (should be 0x50444653)\n", tmp32);
@@ -287,18 +490,13 @@ int probe_spi_sfdp(struct flashctx *flash)
 		return 0;
 	}
 
-	if (spi_sfdp_read_sfdp(flash, 0x04, buf, 3)) {
-		msg_cdbg("Receiving SFDP revision and number of parameter "
-			 "headers (NPH) failed. ");
-		return 0;
-	}
-	msg_cdbg2("SFDP revision = %d.%d\n", buf[1], buf[0]);
-	if (buf[1] != 0x01) {
+	msg_cdbg2("SFDP revision = %d.%d\n", buf[5], buf[4]);
+	if (buf[5] != 0x01) {
 		msg_cdbg("The chip supports an unknown version of SFDP. "
 			  "Aborting SFDP probe!\n");
 		return 0;
 	}
-	nph = buf[2];
+	nph = buf[6];
 	msg_cdbg2("SFDP number of parameter headers is %d (NPH = %d).\n",
 		  nph + 1, nph);
 
@@ -309,7 +507,10 @@ int probe_spi_sfdp(struct flashctx *flash)
 		msg_gerr("Out of memory!\n");
 		goto cleanup_hdrs;
 	}
-	if (spi_sfdp_read_sfdp(flash, 0x08, hbuf, (nph + 1) * 8)) {
+	first = min(nph + 1, SFDP_FIRST_HEADERS);
+	memcpy(hbuf, buf + 8, first * 8);
+	if (nph + 1 > first &&
+	    spi_sfdp_read_sfdp(flash, 0x08 + first * 8, hbuf + first * 8, (nph + 1 - first) * 8)) {
 		msg_cdbg("Receiving SFDP parameter table headers failed.\n");
 		goto cleanup_hdrs;
 	}
@@ -338,6 +539,9 @@ int probe_spi_sfdp(struct flashctx *flash)
 				  "header. Skipping it.\n", i);
 			continue;
 		}
+		/* Only the mandatory JEDEC table is used, don't fetch others. */
+		if (i != 0)
+			continue;
 
 		tbuf = malloc(len);
 		if (tbuf == NULL) {
@@ -367,22 +571,27 @@ int probe_spi_sfdp(struct flashctx *flash)
 		}
 		msg_cspew("\n");
 
-		if (i == 0) { /* Mandatory JEDEC SFDP parameter table */
-			if (hdrs[i].id != 0)
-				msg_cdbg("ID of the mandatory JEDEC SFDP "
-					 "parameter table is not 0 as demanded "
-					 "by JESD216 (warning only).\n");
-
-			if (hdrs[i].v_major != 0x01) {
-				msg_cdbg("The chip contains an unknown "
-					  "version of the JEDEC flash "
-					  "parameters table, skipping it.\n");
-			} else if (len != 9 * 4 && len != 4 * 4) {
-				msg_cdbg("Length of the mandatory JEDEC SFDP "
-					 "parameter table is wrong (%d B), "
-					 "skipping it.\n", len);
-			} else if (sfdp_fill_flash(flash->chip, tbuf, len) == 0)
+		if (hdrs[i].id != 0)
+			msg_cdbg("ID of the mandatory JEDEC SFDP "
+				 "parameter table is not 0 as demanded "
+				 "by JESD216 (warning only).\n");
+
+		if (hdrs[i].v_major != 0x01) {
+			msg_cdbg("The chip contains an unknown "
+				  "version of the JEDEC flash "
+				  "parameters table, skipping it.\n");
+		} else if (len < 9 * 4 && len != 4 * 4) {
+			msg_cdbg("Length of the mandatory JEDEC SFDP "
+				 "parameter table is wrong (%d B), "
+				 "skipping it.\n", len);
+		} else {
+			msg_cdbg("Parsing JEDEC flash parameter table... ");
+			msg_cdbg2("\n");
+			if (!sfdp_parse_bfpt(params, tbuf, len) &&
+			    !sfdp_fill_flash(flash->chip, params, tbuf)) {
+				msg_cdbg("done.\n");
 				ret = 1;
+			}
 		}
 		free(tbuf);
 	}
@@ -392,3 +601,23 @@ cleanup_hdrs:
 	free(hbuf);
 	return ret;
 }
+
+int probe_spi_sfdp(struct flashctx *flash)
+{
+	struct sfdp_params *params;
+
+	params = malloc(sizeof(*params));
+	if (!params) {
+		msg_gerr("Out of memory!\n");
+		return 0;
+	}
+	sfdp_short_reads = 0;
+	if (!sfdp_parse_tables(flash, params)) {
+		free(params);
+		return 0;
+	}
+	if (sfdp_quad_enabled(flash, params))
+		flash->chip->feature_bits |= FEATURE_QUAD_OUT;
+	flash->chip->sfdp = params;
+	return 1;
+}
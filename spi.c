@@ -30,19 +30,295 @@
 #include "programmer.h"
 #include "spi.h"
 
+/* Key of an ID command in the probe cache. */
+struct spi_probe_key {
+	unsigned int writecnt;
+	unsigned int readcnt;
+	unsigned char writearr[JEDEC_SFDP_OUTSIZE];
+};
+
+/* ID commands only read from the chip, their answers can be reused while
+ * probing. Returns 1 and fills @key if this is one of them.
+ */
+static int spi_probe_key(unsigned int writecnt, unsigned int readcnt,
+			 const unsigned char *writearr, struct spi_probe_key *key)
+{
+	if (!writecnt || !readcnt || writecnt > sizeof(key->writearr))
+		return 0;
+	switch (writearr[0]) {
+	case JEDEC_RDID:
+	case JEDEC_REMS:
+	case JEDEC_RES:
+	case AT25F_RDID:
+	case JEDEC_SFDP:
+		break;
+	default:
+		return 0;
+	}
+	memset(key, 0, sizeof(*key));
+	key->writecnt = writecnt;
+	key->readcnt = readcnt;
+	memcpy(key->writearr, writearr, writecnt);
+	return 1;
+}
+
 int spi_send_command(struct flashctx *flash, unsigned int writecnt,
 		     unsigned int readcnt, const unsigned char *writearr,
 		     unsigned char *readarr)
 {
-	return flash->pgm->spi.command(flash, writecnt, readcnt, writearr,
-				       readarr);
+	struct spi_probe_key key;
+	int cacheable, ret;
+
+	cacheable = spi_probe_key(writecnt, readcnt, writearr, &key);
+	if (cacheable && probe_cache_lookup("spi", &key, sizeof(key), readarr, readcnt, &ret))
+		return ret;
+	/* Any other command than an ID command may change what the chip answers. */
+	if (!cacheable)
+		probe_cache_flush();
+	/* RES also releases the chip from deep power-down, answers to other
+	 * ID commands sent before the first RES may have been all 0xff.
+	 */
+	if (cacheable && writearr[0] == JEDEC_RES &&
+	    !probe_cache_lookup("spi res sent", NULL, 0, NULL, 0, &ret)) {
+		probe_cache_flush();
+		probe_cache_store("spi res sent", NULL, 0, NULL, 0, 0);
+	}
+
+	/* The default implementation ends up in spi_send_multicommand(). */
+	if (flash->pgm->spi.command != default_spi_send_command) {
+		bus_stats.commands++;
+		bus_stats.calls++;
+		bus_stats.bytes += writecnt + readcnt;
+	}
+	ret = flash->pgm->spi.command(flash, writecnt, readcnt, writearr,
+				      readarr);
+	if (cacheable)
+		probe_cache_store("spi", &key, sizeof(key), readarr, readcnt, ret);
+	return ret;
 }
 
 int spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds)
 {
+	struct spi_command *cmd;
+	struct spi_probe_key key;
+
+	/* Any other command than an ID command may change what the chip answers. */
+	for (cmd = cmds; cmd->writecnt || cmd->readcnt; cmd++) {
+		if (!spi_probe_key(cmd->writecnt, cmd->readcnt, cmd->writearr, &key)) {
+			probe_cache_flush();
+			break;
+		}
+	}
+	/* The default implementation ends up in spi_send_command(). */
+	if (flash->pgm->spi.multicommand != default_spi_send_multicommand) {
+		bus_stats.calls++;
+		for (cmd = cmds; cmd->writecnt || cmd->readcnt; cmd++) {
+			bus_stats.commands++;
+			bus_stats.bytes += cmd->writecnt + cmd->readcnt;
+		}
+	}
 	return flash->pgm->spi.multicommand(flash, cmds);
 }
 
+/* Let the programmer wait for the chip, see struct spi_programmer. Returns -1
+ * if it can't, the caller has to poll on its own then.
+ */
+int spi_poll_status(struct flashctx *flash, uint8_t opcode, uint8_t mask, unsigned int timeout_us)
+{
+	if (!flash->pgm->spi.poll_status)
+		return -1;
+	bus_stats.commands++;
+	bus_stats.calls++;
+	bus_stats.bytes += 2;
+	return flash->pgm->spi.poll_status(flash, opcode, mask, timeout_us);
+}
+
+/* Deferred commands, see spi_queue_command(). Write data is copied into
+ * spi_queue_data, so callers may reuse their buffers right away.
+ */
+struct spi_queue_entry {
+	unsigned int writecnt;
+	unsigned int readcnt;
+	unsigned int dataofs;
+	unsigned char *readarr;
+	int wait;		/* Wait for the chip instead of a command. */
+	uint8_t wait_opcode;
+	unsigned int wait_len;
+};
+
+#define SPI_QUEUE_ENTRIES	64
+#define SPI_QUEUE_DATA		(16 * 1024)
+
+static struct spi_queue_entry spi_queue[SPI_QUEUE_ENTRIES];
+static unsigned char spi_queue_data[SPI_QUEUE_DATA];
+static unsigned int spi_queue_count = 0;
+static unsigned int spi_queue_datalen = 0;
+/* First error of a flush forced by a full queue, reported by the next flush. */
+static int spi_queue_error = 0;
+
+/* Feed the time a batch with SPI_IO_POLL waits took into the poll timings,
+ * split between the waits by their expected durations. @cmds start at queue
+ * entry @first. A wait which still reads busy is one the programmer gave up on,
+ * the host polls for it then. Returns its index in @cmds, or the number of
+ * commands if all waits finished.
+ */
+static unsigned int spi_queue_polled(struct flashctx *flash, const struct spi_command *cmds,
+				     unsigned int first, uint64_t elapsed)
+{
+	unsigned int expected[SPI_QUEUE_ENTRIES];
+	const struct spi_queue_entry *entry;
+	uint64_t total = 0;
+	unsigned int j, k, busy_us = 0;
+
+	for (k = 0; cmds[k].writecnt; k++) {
+		if (!(cmds[k].io & SPI_IO_POLL))
+			continue;
+		if (*cmds[k].readarr & cmds[k].poll_mask)
+			break;
+		entry = &spi_queue[first + k];
+		expected[k] = spi_poll_expected(flash, entry->wait_opcode, entry->wait_len);
+		total += expected[k];
+	}
+	/* The programmer waited the whole timeout before giving up. */
+	if (cmds[k].writecnt) {
+		busy_us = elapsed < cmds[k].poll_timeout_us ? elapsed : cmds[k].poll_timeout_us;
+		elapsed -= busy_us;
+	}
+	for (j = 0; j < k; j++) {
+		if (!(cmds[j].io & SPI_IO_POLL))
+			continue;
+		entry = &spi_queue[first + j];
+		spi_poll_batched(flash, entry->wait_opcode, entry->wait_len,
+				 elapsed * expected[j] / total, 0);
+	}
+	if (cmds[k].writecnt) {
+		entry = &spi_queue[first + k];
+		spi_poll_batched(flash, entry->wait_opcode, entry->wait_len, busy_us, 1);
+	}
+	return k;
+}
+
+/* Send all queued commands. Consecutive commands go out as one multicommand,
+ * so programmers with a native multicommand implementation can pack them. A
+ * wait entry polls the status register until the chip is ready. Programmers
+ * supporting SPI_IO_POLL get it as part of the multicommand, so the whole
+ * queue is one batch. If such a programmer gives up on a wait, the host polls
+ * and the queue continues after the wait. Commands behind it may have been
+ * sent already, while the chip was busy and ignored them, so they are sent
+ * again. All other programmers get the commands between the waits, and the
+ * host polls. After the first error the rest of the queue is dropped.
+ */
+int spi_queue_flush(struct flashctx *flash)
+{
+	static const unsigned char rdsr = JEDEC_RDSR;
+	struct spi_command cmds[SPI_QUEUE_ENTRIES + 1];
+	unsigned char status[SPI_QUEUE_ENTRIES];
+	struct spi_queue_entry *entry;
+	unsigned int i = 0, first, n;
+	int poll = flash->pgm->spi.io_modes & SPI_IO_POLL;
+	int ret = spi_queue_error;
+	uint64_t start;
+
+	while (i < spi_queue_count && !ret) {
+		first = i;
+		for (n = 0; i < spi_queue_count && (poll || !spi_queue[i].wait); n++, i++) {
+			entry = &spi_queue[i];
+			memset(&cmds[n], 0, sizeof(cmds[n]));
+			if (entry->wait) {
+				/* Reads busy unless the wait finished. */
+				status[n] = SPI_SR_WIP;
+				cmds[n].writecnt = 1;
+				cmds[n].readcnt = 1;
+				cmds[n].writearr = &rdsr;
+				cmds[n].readarr = &status[n];
+				cmds[n].io = SPI_IO_POLL;
+				cmds[n].poll_mask = SPI_SR_WIP;
+				cmds[n].poll_timeout_us = spi_poll_timeout(flash, entry->wait_opcode,
+									   entry->wait_len);
+				continue;
+			}
+			cmds[n].writecnt = entry->writecnt;
+			cmds[n].readcnt = entry->readcnt;
+			cmds[n].writearr = spi_queue_data + entry->dataofs;
+			cmds[n].readarr = entry->readarr;
+		}
+		memset(&cmds[n], 0, sizeof(cmds[n]));
+		start = timestamp_usecs();
+		if (n)
+			ret = spi_send_multicommand(flash, cmds);
+		if (poll && (!ret || ret == SPI_POLL_TIMEOUT)) {
+			n = spi_queue_polled(flash, cmds, first, timestamp_usecs() - start);
+			if (cmds[n].writecnt) {
+				i = first + n + 1;
+				ret = 0;
+			}
+		}
+		if (i < spi_queue_count && !ret && !poll) {
+			spi_poll_wip(flash, spi_queue[i].wait_opcode, spi_queue[i].wait_len);
+			i++;
+		}
+	}
+	spi_queue_count = 0;
+	spi_queue_datalen = 0;
+	spi_queue_error = 0;
+	return ret;
+}
+
+/* Make room for @entries queue entries carrying @datalen bytes of write data,
+ * flushing the queue if needed. Callers reserve a whole command group (e.g.
+ * WREN + program + wait) up front, so a forced flush never splits the group.
+ * Returns nonzero if the group can never fit or the forced flush failed.
+ */
+int spi_queue_reserve(struct flashctx *flash, unsigned int entries, unsigned int datalen)
+{
+	if (entries > SPI_QUEUE_ENTRIES || datalen > SPI_QUEUE_DATA)
+		return SPI_INVALID_LENGTH;
+	if (spi_queue_count + entries > SPI_QUEUE_ENTRIES ||
+	    spi_queue_datalen + datalen > SPI_QUEUE_DATA)
+		spi_queue_error = spi_queue_flush(flash);
+	return spi_queue_error;
+}
+
+static struct spi_queue_entry *spi_queue_add(struct flashctx *flash, unsigned int datalen)
+{
+	if (spi_queue_count == SPI_QUEUE_ENTRIES || spi_queue_datalen + datalen > SPI_QUEUE_DATA)
+		spi_queue_error = spi_queue_flush(flash);
+	memset(&spi_queue[spi_queue_count], 0, sizeof(spi_queue[0]));
+	return &spi_queue[spi_queue_count++];
+}
+
+/* Queue a command for spi_queue_flush(). @readarr must stay valid until then.
+ * Returns nonzero if the command can't be queued, e.g. because it is too long.
+ */
+int spi_queue_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
+		      const unsigned char *writearr, unsigned char *readarr)
+{
+	struct spi_queue_entry *entry;
+
+	if (writecnt > SPI_QUEUE_DATA)
+		return SPI_INVALID_LENGTH;
+	entry = spi_queue_add(flash, writecnt);
+	entry->writecnt = writecnt;
+	entry->readcnt = readcnt;
+	entry->readarr = readarr;
+	entry->dataofs = spi_queue_datalen;
+	memcpy(spi_queue_data + spi_queue_datalen, writearr, writecnt);
+	spi_queue_datalen += writecnt;
+	return 0;
+}
+
+/* Queue waiting for the chip to finish the program or erase command @opcode
+ * for @len bytes, see spi_poll_wip().
+ */
+void spi_queue_wait_ready(struct flashctx *flash, uint8_t opcode, unsigned int len)
+{
+	struct spi_queue_entry *entry = spi_queue_add(flash, 0);
+
+	entry->wait = 1;
+	entry->wait_opcode = opcode;
+	entry->wait_len = len;
+}
+
 int default_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 			     unsigned int readcnt,
 			     const unsigned char *writearr,
@@ -105,17 +381,21 @@ int spi_chip_read(struct flashctx *flash, uint8_t *buf, unsigned int start,
 		  unsigned int len)
 {
 	unsigned int addrbase = 0;
+	uint64_t limit = 1 << 24;
 
 	/* Check if the chip fits between lowest valid and highest possible
-	 * address. Highest possible address with the current SPI implementation
-	 * means 0xffffff, the highest unsigned 24bit number.
+	 * address. Highest possible address with 3-byte addresses is 0xffffff,
+	 * the highest unsigned 24bit number. Chips above 16 MiB get 4-byte
+	 * addresses, see spi_prepare_4ba().
 	 */
+	if (flash->chip->total_size > 16 * 1024)
+		limit = 1ULL << 32;
 	addrbase = spi_get_valid_read_addr(flash);
-	if (addrbase + flash->chip->total_size * 1024 > (1 << 24)) {
+	if (addrbase + (uint64_t)flash->chip->total_size * 1024 > limit) {
 		msg_perr("Flash chip size exceeds the allowed access window. ");
 		msg_perr("Read will probably fail.\n");
 		/* Try to get the best alignment subject to constraints. */
-		addrbase = (1 << 24) - flash->chip->total_size * 1024;
+		addrbase = limit - flash->chip->total_size * 1024;
 	}
 	/* Check if alignment is native (at least the largest power of two which
 	 * is a factor of the mapped size of the chip).
@@ -125,6 +405,12 @@ int spi_chip_read(struct flashctx *flash, uint8_t *buf, unsigned int start,
 			 "access window.\n");
 		msg_perr("Read will probably return garbage.\n");
 	}
+	/* Native bulk reads bypass spi_send_command(), count them as one. */
+	if (flash->pgm->spi.read != default_spi_read) {
+		bus_stats.commands++;
+		bus_stats.calls++;
+		bus_stats.bytes += len;
+	}
 	return flash->pgm->spi.read(flash, buf, addrbase + start, len);
 }
 
@@ -138,6 +424,13 @@ int spi_chip_read(struct flashctx *flash, uint8_t *buf, unsigned int start,
 int spi_chip_write_256(struct flashctx *flash, uint8_t *buf, unsigned int start,
 		       unsigned int len)
 {
+	/* Same for native bulk writes. */
+	if (flash->pgm->spi.write_256 != default_spi_write_256 &&
+	    flash->pgm->spi.write_256 != spi_chip_write_1) {
+		bus_stats.commands++;
+		bus_stats.calls++;
+		bus_stats.bytes += len;
+	}
 	return flash->pgm->spi.write_256(flash, buf, start, len);
 }
 
@@ -162,6 +455,34 @@ uint32_t spi_get_valid_read_addr(struct flashctx *flash)
 	}
 }
 
+/*
+ * Estimate the fixed cost of a separate write command in bytes of payload
+ * which could be sent in the same time. Besides the write enable, command,
+ * address and status polling, USB and serial programmers pay a round trip
+ * for every command.
+ */
+unsigned int spi_get_write_overhead(struct flashctx *flash)
+{
+	switch (flash->pgm->spi.type) {
+#if CONFIG_FT2232_SPI == 1
+	case SPI_CONTROLLER_FT2232:
+#endif
+#if CONFIG_BUSPIRATE_SPI == 1
+	case SPI_CONTROLLER_BUSPIRATE:
+#endif
+#if CONFIG_DEDIPROG == 1
+	case SPI_CONTROLLER_DEDIPROG:
+#endif
+#if CONFIG_SERPROG == 1
+	case SPI_CONTROLLER_SERPROG:
+#endif
+		return 64;
+	default:
+		/* WREN, opcode, 3 address bytes and a few RDSR. */
+		return 8;
+	}
+}
+
 int spi_aai_write(struct flashctx *flash, uint8_t *buf,
 		  unsigned int start, unsigned int len)
 {
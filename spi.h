@@ -106,6 +106,16 @@
 #define JEDEC_SE_OUTSIZE	0x04
 #define JEDEC_SE_INSIZE		0x00
 
+/* Sector Erase (4k), Block Erase (32k and 64k) with a 4-byte address */
+#define JEDEC_SE_4BA		0x21
+#define JEDEC_BE_5C_4BA		0x5c
+#define JEDEC_BE_DC_4BA		0xdc
+#define JEDEC_ERASE_4BA_OUTSIZE	0x05
+
+/* Enter and exit 4-byte address mode, all address commands take 4 bytes then */
+#define JEDEC_ENTER_4BA		0xb7
+#define JEDEC_EXIT_4BA		0xe9
+
 /* Read Status Register */
 #define JEDEC_RDSR		0x05
 #define JEDEC_RDSR_OUTSIZE	0x01
@@ -131,11 +141,30 @@
 #define JEDEC_READ_OUTSIZE	0x04
 /*      JEDEC_READ_INSIZE : any length */
 
+/* Read the memory with dummy cycles after the address, usually 8 */
+#define JEDEC_FAST_READ		0x0b
+/* Dual/quad output read, only the data is shifted in on 2/4 lines */
+#define JEDEC_DUAL_OUT_READ	0x3b
+#define JEDEC_QUAD_OUT_READ	0x6b
+
+/* The same reads with a 4-byte address, see FEATURE_4BA_NATIVE */
+#define JEDEC_READ_4BA		0x13
+#define JEDEC_READ_4BA_OUTSIZE	0x05
+#define JEDEC_FAST_READ_4BA	0x0c
+#define JEDEC_DUAL_OUT_READ_4BA	0x3c
+#define JEDEC_QUAD_OUT_READ_4BA	0x6c
+/* Room in writearr for the address and the dummy bytes of any read above */
+#define JEDEC_READ_MAX_OUTSIZE	0x09
+
 /* Write memory byte */
 #define JEDEC_BYTE_PROGRAM		0x02
 #define JEDEC_BYTE_PROGRAM_OUTSIZE	0x05
 #define JEDEC_BYTE_PROGRAM_INSIZE	0x00
 
+/* Write memory byte with a 4-byte address */
+#define JEDEC_BYTE_PROGRAM_4BA		0x12
+#define JEDEC_BYTE_PROGRAM_4BA_OUTSIZE	0x06
+
 /* Write AAI word (SST25VF080B) */
 #define JEDEC_AAI_WORD_PROGRAM			0xad
 #define JEDEC_AAI_WORD_PROGRAM_OUTSIZE		0x06
@@ -149,5 +178,6 @@
 #define SPI_INVALID_LENGTH	-4
 #define SPI_FLASHROM_BUG	-5
 #define SPI_PROGRAMMER_ERROR	-6
+#define SPI_POLL_TIMEOUT	-7	/* A SPI_IO_POLL wait gave up */
 
 #endif		/* !__SPI_H__ */
@@ -23,6 +23,7 @@
  */
 
 #include <string.h>
+#include <limits.h>
 #include "flash.h"
 #include "flashchips.h"
 #include "chipdrivers.h"
@@ -115,15 +116,292 @@ int spi_write_disable(struct flashctx *flash)
 	return spi_send_command(flash, sizeof(cmd), 0, cmd, NULL);
 }
 
-static int probe_spi_rdid_generic(struct flashctx *flash, int bytes)
+/* Chips above 16 MiB need 4-byte addresses. */
+static int spi_chip_4ba(const struct flashctx *flash)
+{
+	return flash->chip->total_size > 16 * 1024;
+}
+
+/* Whether to use the opcodes with a 4-byte address instead of the usual ones. */
+static int spi_native_4ba(const struct flashctx *flash)
+{
+	return spi_chip_4ba(flash) && (flash->chip->feature_bits & FEATURE_4BA_NATIVE);
+}
+
+/* Put @addr behind the opcode in @cmd. Opcodes with a 4-byte address
+ * (@native_4ba) and all opcodes in 4-byte address mode take 4 bytes, the rest
+ * 3 bytes. Returns the address length, or -1 if @addr doesn't fit.
+ */
+static int spi_prepare_address(struct flashctx *flash, uint8_t *cmd, int native_4ba,
+			       unsigned int addr)
+{
+	if (native_4ba || flash->in_4ba_mode) {
+		cmd[1] = (addr >> 24) & 0xff;
+		cmd[2] = (addr >> 16) & 0xff;
+		cmd[3] = (addr >> 8) & 0xff;
+		cmd[4] = (addr >> 0) & 0xff;
+		return 4;
+	}
+	if (addr > 0xffffff) {
+		msg_cerr("%s: Address 0x%x needs 4-byte addressing.\n", __func__, addr);
+		return -1;
+	}
+	cmd[1] = (addr >> 16) & 0xff;
+	cmd[2] = (addr >> 8) & 0xff;
+	cmd[3] = (addr >> 0) & 0xff;
+	return 3;
+}
+
+/*
+ * Get a chip above 16 MiB ready for 4-byte addresses before any command with
+ * an address. Chips with FEATURE_4BA_NATIVE keep their 3-byte address mode,
+ * the others are switched to 4-byte address mode until spi_finish_4ba().
+ */
+int spi_prepare_4ba(struct flashctx *flash)
+{
+	static const unsigned char cmd[] = { JEDEC_ENTER_4BA };
+	unsigned int features = flash->chip->feature_bits;
+
+	if (!spi_chip_4ba(flash))
+		return 0;
+	if (!(flash->pgm->spi.io_modes & SPI_IO_4BA)) {
+		msg_cerr("This programmer can't send 4-byte addresses, which the "
+			 "chip needs above 16 MB.\n");
+		return 1;
+	}
+	if (features & FEATURE_4BA_NATIVE)
+		return 0;
+	if (!(features & (FEATURE_4BA_ENTER | FEATURE_4BA_ENTER_WREN))) {
+		msg_cerr("Don't know how to use 4-byte addresses with this chip.\n");
+		return 1;
+	}
+	if ((features & FEATURE_4BA_ENTER_WREN) && spi_write_enable(flash))
+		return 1;
+	if (spi_send_command(flash, sizeof(cmd), 0, cmd, NULL)) {
+		msg_cerr("Entering 4-byte address mode failed.\n");
+		return 1;
+	}
+	msg_cdbg("Entered 4-byte address mode.\n");
+	flash->in_4ba_mode = 1;
+	return 0;
+}
+
+/* Return to 3-byte address mode, which firmware booting from the chip expects. */
+int spi_finish_4ba(struct flashctx *flash)
+{
+	static const unsigned char cmd[] = { JEDEC_EXIT_4BA };
+
+	if (!flash->in_4ba_mode)
+		return 0;
+	flash->in_4ba_mode = 0;
+	if ((flash->chip->feature_bits & FEATURE_4BA_ENTER_WREN) && spi_write_enable(flash))
+		return 1;
+	if (spi_send_command(flash, sizeof(cmd), 0, cmd, NULL)) {
+		msg_cerr("Leaving 4-byte address mode failed.\n");
+		return 1;
+	}
+	msg_cdbg("Left 4-byte address mode.\n");
+	return 0;
+}
+
+/* Status polling after program and erase commands.
+ *
+ * Every kind of operation, identified by its opcode and length, starts with an
+ * expected duration. The first status read happens after a quarter of it, then
+ * the delay between reads starts at 1/16 and doubles up to a quarter of the
+ * expected duration. Observed durations are averaged into the expectation, so
+ * repeated operations converge to few status reads with little idle time.
+ */
+struct spi_poll_timing {
+	uint8_t opcode;
+	unsigned int len;
+	unsigned int expected_us;
+	unsigned long waits;
+	unsigned long polls;
+	uint64_t total_us;
+	unsigned int max_us;
+};
+
+#define SPI_POLL_TIMINGS	32
+/* Never sleep longer than this between status reads. */
+#define SPI_POLL_MAX_DELAY_US	(1000 * 1000)
+/* Programmers polling on their own give up after this or 8 times the expected
+ * duration, whichever is longer.
+ */
+#define SPI_POLL_OFFLOAD_MIN_US	(100 * 1000)
+
+static struct spi_poll_timing spi_poll_timings[SPI_POLL_TIMINGS];
+static int spi_poll_timing_count = 0;
+
+/* Erase times of big chips multiplied up must not wrap around. */
+static unsigned int spi_poll_clamp_us(uint64_t us)
+{
+	return us > UINT_MAX ? UINT_MAX : us;
+}
+
+/* Typical times from SFDP if the chip has them, otherwise typical datasheet
+ * values: programming takes a few us per byte, erasing about 30 ms plus 3 ms
+ * per kB.
+ */
+static unsigned int spi_poll_default_us(const struct flashctx *flash, uint8_t opcode,
+					unsigned int len)
+{
+	unsigned int us;
+
+	if (flash->chip->sfdp) {
+		us = sfdp_typical_us(flash->chip->sfdp, opcode, len);
+		if (us)
+			return us;
+	}
+	switch (opcode) {
+	case JEDEC_BYTE_PROGRAM:
+		return 8 + 3 * len;
+	case JEDEC_AAI_WORD_PROGRAM:
+		return 10;
+	default:
+		return spi_poll_clamp_us(30000 + 3000ULL * (len / 1024));
+	}
+}
+
+static struct spi_poll_timing *spi_poll_get_timing(const struct flashctx *flash, uint8_t opcode,
+						   unsigned int len)
+{
+	struct spi_poll_timing *timing;
+	int i;
+
+	for (i = 0; i < spi_poll_timing_count; i++) {
+		timing = &spi_poll_timings[i];
+		if (timing->opcode == opcode && timing->len == len)
+			return timing;
+	}
+	/* Once the table is full, new opcode/length pairs use the default timing
+	 * and are not learned.
+	 */
+	if (spi_poll_timing_count == SPI_POLL_TIMINGS)
+		return NULL;
+	timing = &spi_poll_timings[spi_poll_timing_count++];
+	timing->opcode = opcode;
+	timing->len = len;
+	timing->expected_us = spi_poll_default_us(flash, opcode, len);
+	return timing;
+}
+
+static void spi_poll_update(struct spi_poll_timing *timing, uint64_t elapsed, unsigned long polls)
+{
+	timing->waits++;
+	timing->polls += polls;
+	timing->total_us += elapsed;
+	if (elapsed > timing->max_us)
+		timing->max_us = spi_poll_clamp_us(elapsed);
+	timing->expected_us = spi_poll_clamp_us((3ULL * timing->expected_us + elapsed) / 4);
+	if (!timing->expected_us)
+		timing->expected_us = 1;
+}
+
+/* How long @opcode on @len bytes is expected to take. */
+unsigned int spi_poll_expected(struct flashctx *flash, uint8_t opcode, unsigned int len)
+{
+	struct spi_poll_timing *timing = spi_poll_get_timing(flash, opcode, len);
+
+	return timing ? timing->expected_us : spi_poll_default_us(flash, opcode, len);
+}
+
+/* Read the status register from the host until the chip is ready. Returns the
+ * number of status reads.
+ */
+static unsigned long spi_poll_host(struct flashctx *flash, unsigned int expected)
+{
+	unsigned int delay, maxdelay;
+	unsigned long polls = 1;
+
+	maxdelay = expected / 4 > SPI_POLL_MAX_DELAY_US ? SPI_POLL_MAX_DELAY_US : max(expected / 4, 1);
+	delay = min(max(expected / 16, 1), maxdelay);
+	programmer_delay(maxdelay);
+	while (spi_read_status_register(flash) & SPI_SR_WIP) {
+		programmer_delay(delay);
+		delay = min(delay * 2, maxdelay);
+		polls++;
+	}
+	return polls;
+}
+
+/* Wait until the Write-In-Progress bit is cleared after a program or erase
+ * command @opcode for @len bytes.
+ * FIXME: We assume spi_read_status_register will never fail.
+ */
+void spi_poll_wip(struct flashctx *flash, uint8_t opcode, unsigned int len)
+{
+	struct spi_poll_timing *timing = spi_poll_get_timing(flash, opcode, len);
+	uint64_t start = timestamp_usecs();
+	unsigned long polls = 1;
+
+	/* A programmer which waits on its own saves a round trip per poll. If
+	 * it gives up, keep polling here.
+	 */
+	if (spi_poll_status(flash, JEDEC_RDSR, SPI_SR_WIP, spi_poll_timeout(flash, opcode, len)))
+		polls = spi_poll_host(flash, spi_poll_expected(flash, opcode, len));
+	if (timing)
+		spi_poll_update(timing, timestamp_usecs() - start, polls);
+}
+
+/* Account a wait for @opcode on @len bytes which a programmer did on its own
+ * as part of a batch (SPI_IO_POLL) and which took @us. If the programmer gave
+ * up, keep polling here like spi_poll_wip() does.
+ */
+void spi_poll_batched(struct flashctx *flash, uint8_t opcode, unsigned int len, unsigned int us,
+		      int gave_up)
+{
+	struct spi_poll_timing *timing = spi_poll_get_timing(flash, opcode, len);
+	uint64_t start = timestamp_usecs();
+	unsigned long polls = 1;
+
+	if (gave_up)
+		polls += spi_poll_host(flash, spi_poll_expected(flash, opcode, len));
+	if (timing)
+		spi_poll_update(timing, us + timestamp_usecs() - start, polls);
+}
+
+/* How long a programmer waiting on its own for @opcode on @len bytes should
+ * try before giving up.
+ */
+unsigned int spi_poll_timeout(struct flashctx *flash, uint8_t opcode, unsigned int len)
+{
+	unsigned int expected = spi_poll_expected(flash, opcode, len);
+
+	if (expected < SPI_POLL_OFFLOAD_MIN_US / 8)
+		return SPI_POLL_OFFLOAD_MIN_US;
+	return spi_poll_clamp_us(expected * 8ULL);
+}
+
+/* Print what spi_poll_wip() observed, to tune the expected durations. */
+void spi_poll_print_stats(void)
+{
+	const struct spi_poll_timing *timing;
+	int i;
+
+	for (i = 0; i < spi_poll_timing_count; i++) {
+		timing = &spi_poll_timings[i];
+		if (!timing->waits)
+			continue;
+		msg_gdbg("Opcode 0x%02x, %u bytes: %lu waits, %lu status reads, %llu us average, "
+			 "%u us max, %u us expected.\n", timing->opcode, timing->len, timing->waits,
+			 timing->polls, (unsigned long long)(timing->total_us / timing->waits),
+			 timing->max_us, timing->expected_us);
+	}
+}
+
+/* Read the IDs probe_spi_rdid() and probe_spi_rdid4() compare. Returns 0 on
+ * success.
+ */
+static int spi_rdid_ids(struct flashctx *flash, int bytes, uint32_t *id1_out,
+			uint32_t *id2_out)
 {
-	const struct flashchip *chip = flash->chip;
 	unsigned char readarr[4];
 	uint32_t id1;
 	uint32_t id2;
 
 	if (spi_rdid(flash, readarr, bytes)) {
-		return 0;
+		return 1;
 	}
 
 	if (!oddparity(readarr[0]))
@@ -147,7 +425,14 @@ static int probe_spi_rdid_generic(struct flashctx *flash, int bytes)
 	}
 
 	msg_cdbg("%s: id1 0x%02x, id2 0x%02x\n", __func__, id1, id2);
+	*id1_out = id1;
+	*id2_out = id2;
+	return 0;
+}
 
+/* Whether the IDs of an ID probe match @chip, generic chips included. */
+static int spi_ids_match(const struct flashchip *chip, uint32_t id1, uint32_t id2)
+{
 	if (id1 == chip->manufacture_id && id2 == chip->model_id)
 		return 1;
 
@@ -162,12 +447,21 @@ static int probe_spi_rdid_generic(struct flashctx *flash, int bytes)
 	return 0;
 }
 
+int probe_spi_rdid_ids(struct flashctx *flash, uint32_t *id1, uint32_t *id2)
+{
+	return spi_rdid_ids(flash, 3, id1, id2);
+}
+
 int probe_spi_rdid(struct flashctx *flash)
 {
-	return probe_spi_rdid_generic(flash, 3);
+	uint32_t id1, id2;
+
+	if (probe_spi_rdid_ids(flash, &id1, &id2))
+		return 0;
+	return spi_ids_match(flash->chip, id1, id2);
 }
 
-int probe_spi_rdid4(struct flashctx *flash)
+int probe_spi_rdid4_ids(struct flashctx *flash, uint32_t *id1, uint32_t *id2)
 {
 	/* Some SPI controllers do not support commands with writecnt=1 and
 	 * readcnt=4.
@@ -178,46 +472,50 @@ int probe_spi_rdid4(struct flashctx *flash)
 	case SPI_CONTROLLER_IT87XX:
 	case SPI_CONTROLLER_WBSIO:
 		msg_cinfo("4 byte RDID not supported on this SPI controller\n");
-		return 0;
+		return 1;
 		break;
 #endif
 #endif
 	default:
-		return probe_spi_rdid_generic(flash, 4);
+		return spi_rdid_ids(flash, 4, id1, id2);
 	}
 
-	return 0;
+	return 1;
 }
 
-int probe_spi_rems(struct flashctx *flash)
+int probe_spi_rdid4(struct flashctx *flash)
 {
-	const struct flashchip *chip = flash->chip;
-	unsigned char readarr[JEDEC_REMS_INSIZE];
 	uint32_t id1, id2;
 
-	if (spi_rems(flash, readarr)) {
+	if (probe_spi_rdid4_ids(flash, &id1, &id2))
 		return 0;
-	}
-
-	id1 = readarr[0];
-	id2 = readarr[1];
-
-	msg_cdbg("%s: id1 0x%x, id2 0x%x\n", __func__, id1, id2);
+	return spi_ids_match(flash->chip, id1, id2);
+}
 
-	if (id1 == chip->manufacture_id && id2 == chip->model_id)
-		return 1;
+int probe_spi_rems_ids(struct flashctx *flash, uint32_t *id1, uint32_t *id2)
+{
+	unsigned char readarr[JEDEC_REMS_INSIZE];
 
-	/* Test if this is a pure vendor match. */
-	if (id1 == chip->manufacture_id && GENERIC_DEVICE_ID == chip->model_id)
+	if (spi_rems(flash, readarr)) {
 		return 1;
+	}
 
-	/* Test if there is any vendor ID. */
-	if (GENERIC_MANUF_ID == chip->manufacture_id && id1 != 0xff)
-		return 1;
+	*id1 = readarr[0];
+	*id2 = readarr[1];
 
+	msg_cdbg("%s: id1 0x%x, id2 0x%x\n", __func__, *id1, *id2);
 	return 0;
 }
 
+int probe_spi_rems(struct flashctx *flash)
+{
+	uint32_t id1, id2;
+
+	if (probe_spi_rems_ids(flash, &id1, &id2))
+		return 0;
+	return spi_ids_match(flash->chip, id1, id2);
+}
+
 int probe_spi_res1(struct flashctx *flash)
 {
 	static const unsigned char allff[] = {0xff, 0xff, 0xff};
@@ -328,12 +626,7 @@ int spi_chip_erase_60(struct flashctx *flash)
 			__func__);
 		return result;
 	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 1-85 s, so wait in 1 s steps.
-	 */
-	/* FIXME: We assume spi_read_status_register will never fail. */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(1000 * 1000);
+	spi_poll_wip(flash, JEDEC_CE_60, flash->chip->total_size * 1024);
 	/* FIXME: Check the status register for errors. */
 	return 0;
 }
@@ -365,12 +658,7 @@ int spi_chip_erase_62(struct flashctx *flash)
 			__func__);
 		return result;
 	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 2-5 s, so wait in 100 ms steps.
-	 */
-	/* FIXME: We assume spi_read_status_register will never fail. */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(100 * 1000);
+	spi_poll_wip(flash, JEDEC_CE_62, flash->chip->total_size * 1024);
 	/* FIXME: Check the status register for errors. */
 	return 0;
 }
@@ -401,20 +689,20 @@ int spi_chip_erase_c7(struct flashctx *flash)
 		msg_cerr("%s failed during command execution\n", __func__);
 		return result;
 	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 1-85 s, so wait in 1 s steps.
-	 */
-	/* FIXME: We assume spi_read_status_register will never fail. */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(1000 * 1000);
+	spi_poll_wip(flash, JEDEC_CE_C7, flash->chip->total_size * 1024);
 	/* FIXME: Check the status register for errors. */
 	return 0;
 }
 
-int spi_block_erase_52(struct flashctx *flash, unsigned int addr,
-		       unsigned int blocklen)
+/* Erase the block of @blocklen bytes at @addr with @opcode, after WREN unless
+ * the chip doesn't want one. @func is the caller for error messages.
+ */
+static int spi_block_erase_addr(struct flashctx *flash, uint8_t opcode, int native_4ba,
+				int wren, unsigned int addr, unsigned int blocklen,
+				const char *func)
 {
-	int result;
+	unsigned char cmd[JEDEC_ERASE_4BA_OUTSIZE] = { opcode };
+	int result, addrlen;
 	struct spi_command cmds[] = {
 	{
 		.writecnt	= JEDEC_WREN_OUTSIZE,
@@ -422,13 +710,7 @@ int spi_block_erase_52(struct flashctx *flash, unsigned int addr,
 		.readcnt	= 0,
 		.readarr	= NULL,
 	}, {
-		.writecnt	= JEDEC_BE_52_OUTSIZE,
-		.writearr	= (const unsigned char[]){
-					JEDEC_BE_52,
-					(addr >> 16) & 0xff,
-					(addr >> 8) & 0xff,
-					(addr & 0xff)
-				},
+		.writearr	= cmd,
 		.readcnt	= 0,
 		.readarr	= NULL,
 	}, {
@@ -438,21 +720,28 @@ int spi_block_erase_52(struct flashctx *flash, unsigned int addr,
 		.readarr	= NULL,
 	}};
 
-	result = spi_send_multicommand(flash, cmds);
+	addrlen = spi_prepare_address(flash, cmd, native_4ba, addr);
+	if (addrlen < 0)
+		return SPI_INVALID_ADDRESS;
+	cmds[1].writecnt = 1 + addrlen;
+
+	result = spi_send_multicommand(flash, wren ? cmds : cmds + 1);
 	if (result) {
 		msg_cerr("%s failed during command execution at address 0x%x\n",
-			__func__, addr);
+			func, addr);
 		return result;
 	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 100-4000 ms, so wait in 100 ms steps.
-	 */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(100 * 1000);
+	spi_poll_wip(flash, opcode, blocklen);
 	/* FIXME: Check the status register for errors. */
 	return 0;
 }
 
+int spi_block_erase_52(struct flashctx *flash, unsigned int addr,
+		       unsigned int blocklen)
+{
+	return spi_block_erase_addr(flash, JEDEC_BE_52, 0, 1, addr, blocklen, __func__);
+}
+
 /* Block size is usually
  * 64k for Macronix
  * 32k for SST
@@ -461,43 +750,7 @@ int spi_block_erase_52(struct flashctx *flash, unsigned int addr,
 int spi_block_erase_d8(struct flashctx *flash, unsigned int addr,
 		       unsigned int blocklen)
 {
-	int result;
-	struct spi_command cmds[] = {
-	{
-		.writecnt	= JEDEC_WREN_OUTSIZE,
-		.writearr	= (const unsigned char[]){ JEDEC_WREN },
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= JEDEC_BE_D8_OUTSIZE,
-		.writearr	= (const unsigned char[]){
-					JEDEC_BE_D8,
-					(addr >> 16) & 0xff,
-					(addr >> 8) & 0xff,
-					(addr & 0xff)
-				},
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= 0,
-		.writearr	= NULL,
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}};
-
-	result = spi_send_multicommand(flash, cmds);
-	if (result) {
-		msg_cerr("%s failed during command execution at address 0x%x\n",
-			__func__, addr);
-		return result;
-	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 100-4000 ms, so wait in 100 ms steps.
-	 */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(100 * 1000);
-	/* FIXME: Check the status register for errors. */
-	return 0;
+	return spi_block_erase_addr(flash, JEDEC_BE_D8, 0, 1, addr, blocklen, __func__);
 }
 
 /* Block size is usually
@@ -506,166 +759,42 @@ int spi_block_erase_d8(struct flashctx *flash, unsigned int addr,
 int spi_block_erase_d7(struct flashctx *flash, unsigned int addr,
 		       unsigned int blocklen)
 {
-	int result;
-	struct spi_command cmds[] = {
-	{
-		.writecnt	= JEDEC_WREN_OUTSIZE,
-		.writearr	= (const unsigned char[]){ JEDEC_WREN },
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= JEDEC_BE_D7_OUTSIZE,
-		.writearr	= (const unsigned char[]){
-					JEDEC_BE_D7,
-					(addr >> 16) & 0xff,
-					(addr >> 8) & 0xff,
-					(addr & 0xff)
-				},
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= 0,
-		.writearr	= NULL,
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}};
-
-	result = spi_send_multicommand(flash, cmds);
-	if (result) {
-		msg_cerr("%s failed during command execution at address 0x%x\n",
-			__func__, addr);
-		return result;
-	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 100-4000 ms, so wait in 100 ms steps.
-	 */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(100 * 1000);
-	/* FIXME: Check the status register for errors. */
-	return 0;
+	return spi_block_erase_addr(flash, JEDEC_BE_D7, 0, 1, addr, blocklen, __func__);
 }
 
 /* Sector size is usually 4k, though Macronix eliteflash has 64k */
 int spi_block_erase_20(struct flashctx *flash, unsigned int addr,
 		       unsigned int blocklen)
 {
-	int result;
-	struct spi_command cmds[] = {
-	{
-		.writecnt	= JEDEC_WREN_OUTSIZE,
-		.writearr	= (const unsigned char[]){ JEDEC_WREN },
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= JEDEC_SE_OUTSIZE,
-		.writearr	= (const unsigned char[]){
-					JEDEC_SE,
-					(addr >> 16) & 0xff,
-					(addr >> 8) & 0xff,
-					(addr & 0xff)
-				},
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= 0,
-		.writearr	= NULL,
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}};
-
-	result = spi_send_multicommand(flash, cmds);
-	if (result) {
-		msg_cerr("%s failed during command execution at address 0x%x\n",
-			__func__, addr);
-		return result;
-	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 15-800 ms, so wait in 10 ms steps.
-	 */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(10 * 1000);
-	/* FIXME: Check the status register for errors. */
-	return 0;
+	return spi_block_erase_addr(flash, JEDEC_SE, 0, 1, addr, blocklen, __func__);
 }
 
 int spi_block_erase_50(struct flashctx *flash, unsigned int addr, unsigned int blocklen)
 {
-	int result;
-	struct spi_command cmds[] = {
-	{
-/*		.writecnt	= JEDEC_WREN_OUTSIZE,
-		.writearr	= (const unsigned char[]){ JEDEC_WREN },
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, { */
-		.writecnt	= JEDEC_BE_50_OUTSIZE,
-		.writearr	= (const unsigned char[]){
-					JEDEC_BE_50,
-					(addr >> 16) & 0xff,
-					(addr >> 8) & 0xff,
-					(addr & 0xff)
-				},
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= 0,
-		.writearr	= NULL,
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}};
-
-	result = spi_send_multicommand(flash, cmds);
-	if (result) {
-		msg_cerr("%s failed during command execution at address 0x%x\n", __func__, addr);
-		return result;
-	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 10 ms, so wait in 1 ms steps.
-	 */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(1 * 1000);
-	/* FIXME: Check the status register for errors. */
-	return 0;
+	return spi_block_erase_addr(flash, JEDEC_BE_50, 0, 0, addr, blocklen, __func__);
 }
 
 int spi_block_erase_81(struct flashctx *flash, unsigned int addr, unsigned int blocklen)
 {
-	int result;
-	struct spi_command cmds[] = {
-	{
-/*		.writecnt	= JEDEC_WREN_OUTSIZE,
-		.writearr	= (const unsigned char[]){ JEDEC_WREN },
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, { */
-		.writecnt	= JEDEC_BE_81_OUTSIZE,
-		.writearr	= (const unsigned char[]){
-					JEDEC_BE_81,
-					(addr >> 16) & 0xff,
-					(addr >> 8) & 0xff,
-					(addr & 0xff)
-				},
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}, {
-		.writecnt	= 0,
-		.writearr	= NULL,
-		.readcnt	= 0,
-		.readarr	= NULL,
-	}};
+	return spi_block_erase_addr(flash, JEDEC_BE_81, 0, 0, addr, blocklen, __func__);
+}
 
-	result = spi_send_multicommand(flash, cmds);
-	if (result) {
-		msg_cerr("%s failed during command execution at address 0x%x\n", __func__, addr);
-		return result;
-	}
-	/* Wait until the Write-In-Progress bit is cleared.
-	 * This usually takes 8 ms, so wait in 1 ms steps.
-	 */
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(1 * 1000);
-	/* FIXME: Check the status register for errors. */
-	return 0;
+/* 4k sector erase with a 4-byte address */
+int spi_block_erase_21(struct flashctx *flash, unsigned int addr, unsigned int blocklen)
+{
+	return spi_block_erase_addr(flash, JEDEC_SE_4BA, 1, 1, addr, blocklen, __func__);
+}
+
+/* 32k block erase with a 4-byte address */
+int spi_block_erase_5c(struct flashctx *flash, unsigned int addr, unsigned int blocklen)
+{
+	return spi_block_erase_addr(flash, JEDEC_BE_5C_4BA, 1, 1, addr, blocklen, __func__);
+}
+
+/* 64k block erase with a 4-byte address */
+int spi_block_erase_dc(struct flashctx *flash, unsigned int addr, unsigned int blocklen)
+{
+	return spi_block_erase_addr(flash, JEDEC_BE_DC_4BA, 1, 1, addr, blocklen, __func__);
 }
 
 int spi_block_erase_60(struct flashctx *flash, unsigned int addr,
@@ -700,6 +829,67 @@ int spi_block_erase_c7(struct flashctx *flash, unsigned int addr,
 	return spi_chip_erase_c7(flash);
 }
 
+/* Rough typical durations used by the erase/write planner to rank erase
+ * functions against each other. Datasheets of common SPI chips quote 40-60 ms
+ * for a 4 kB sector erase, 100-200 ms for a 32 kB block and 150-700 ms for a
+ * 64 kB block. Chip erase takes about as long as erasing all 64 kB blocks one
+ * after another. Erase functions without an entry are estimated with the
+ * generic last entry.
+ */
+static const struct spi_erase_timing {
+	erasefunc_t *block_erase;
+	unsigned int fixed_us;	/* Cost per erase command. */
+	unsigned int per_kb_us;	/* Additional cost per erased kB. */
+} spi_erase_timings[] = {
+	{spi_block_erase_20,	 50000,	   0},
+	{spi_block_erase_21,	 50000,	   0},
+	{spi_block_erase_52,	150000,	   0},
+	{spi_block_erase_5c,	150000,	   0},
+	{spi_block_erase_d8,	300000,	   0},
+	{spi_block_erase_dc,	300000,	   0},
+	{spi_block_erase_60,	     0,	4000},
+	{spi_block_erase_62,	     0,	4000},
+	{spi_block_erase_c7,	     0,	4000},
+	{NULL,			 20000,	3000},
+};
+
+/* Typical programming time of a page and of a single byte on chips which
+ * can't do page programming.
+ */
+#define SPI_PAGE_PROGRAM_US	700
+#define SPI_BYTE_PROGRAM_US	20
+
+uint64_t spi_erase_cost(const struct flashctx *flash, erasefunc_t *block_erase, unsigned int len)
+{
+	const struct spi_erase_timing *t = spi_erase_timings;
+
+	while (t->block_erase && t->block_erase != block_erase)
+		t++;
+	return t->fixed_us + (uint64_t)t->per_kb_us * len / 1024;
+}
+
+/* Page programming writes all changed bytes of a page with one command. */
+uint64_t spi_write_cost(const struct flashctx *flash, const uint8_t *have, const uint8_t *want,
+			unsigned int start, unsigned int len)
+{
+	unsigned int page = flash->chip->max_write_chunk;
+	unsigned int i;
+	uint64_t cost = 0;
+
+	for (i = 0; i < len; i++) {
+		if ((have ? have[i] : 0xff) == want[i])
+			continue;
+		if (flash->chip->write != spi_chip_write_256 || !page) {
+			cost += SPI_BYTE_PROGRAM_US;
+			continue;
+		}
+		cost += SPI_PAGE_PROGRAM_US;
+		/* The rest of this page is written by the same command. */
+		i = ((start + i) / page + 1) * page - 1 - start;
+	}
+	return cost;
+}
+
 erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode)
 {
 	switch(opcode){
@@ -709,8 +899,12 @@ erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode)
 		return NULL;
 	case 0x20:
 		return &spi_block_erase_20;
+	case 0x21:
+		return &spi_block_erase_21;
 	case 0x52:
 		return &spi_block_erase_52;
+	case 0x5c:
+		return &spi_block_erase_5c;
 	case 0x60:
 		return &spi_block_erase_60;
 	case 0xc7:
@@ -719,6 +913,8 @@ erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode)
 		return &spi_block_erase_d7;
 	case 0xd8:
 		return &spi_block_erase_d8;
+	case 0xdc:
+		return &spi_block_erase_dc;
 	default:
 		msg_cinfo("%s: unknown erase opcode (0x%02x). Please report "
 			  "this at flashrom@flashrom.org\n", __func__, opcode);
@@ -726,10 +922,28 @@ erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode)
 	}
 }
 
+/* Fill @cmd with the program command for @len bytes at @addr. Returns the
+ * command length, or -1 if the address doesn't fit.
+ */
+static int spi_prepare_program(struct flashctx *flash, uint8_t *cmd, unsigned int addr,
+			       const uint8_t *bytes, unsigned int len)
+{
+	int native_4ba = spi_native_4ba(flash);
+	int addrlen;
+
+	cmd[0] = native_4ba ? JEDEC_BYTE_PROGRAM_4BA : JEDEC_BYTE_PROGRAM;
+	addrlen = spi_prepare_address(flash, cmd, native_4ba, addr);
+	if (addrlen < 0)
+		return -1;
+	memcpy(cmd + 1 + addrlen, bytes, len);
+	return 1 + addrlen + len;
+}
+
 int spi_byte_program(struct flashctx *flash, unsigned int addr,
 		     uint8_t databyte)
 {
 	int result;
+	unsigned char cmd[JEDEC_BYTE_PROGRAM_4BA_OUTSIZE];
 	struct spi_command cmds[] = {
 	{
 		.writecnt	= JEDEC_WREN_OUTSIZE,
@@ -737,14 +951,7 @@ int spi_byte_program(struct flashctx *flash, unsigned int addr,
 		.readcnt	= 0,
 		.readarr	= NULL,
 	}, {
-		.writecnt	= JEDEC_BYTE_PROGRAM_OUTSIZE,
-		.writearr	= (const unsigned char[]){
-					JEDEC_BYTE_PROGRAM,
-					(addr >> 16) & 0xff,
-					(addr >> 8) & 0xff,
-					(addr & 0xff),
-					databyte
-				},
+		.writearr	= cmd,
 		.readcnt	= 0,
 		.readarr	= NULL,
 	}, {
@@ -753,6 +960,11 @@ int spi_byte_program(struct flashctx *flash, unsigned int addr,
 		.readcnt	= 0,
 		.readarr	= NULL,
 	}};
+	int cmdlen = spi_prepare_program(flash, cmd, addr, &databyte, 1);
+
+	if (cmdlen < 0)
+		return SPI_INVALID_ADDRESS;
+	cmds[1].writecnt = cmdlen;
 
 	result = spi_send_multicommand(flash, cmds);
 	if (result) {
@@ -766,13 +978,9 @@ int spi_nbyte_program(struct flashctx *flash, unsigned int addr, uint8_t *bytes,
 		      unsigned int len)
 {
 	int result;
+	int cmdlen;
 	/* FIXME: Switch to malloc based on len unless that kills speed. */
-	unsigned char cmd[JEDEC_BYTE_PROGRAM_OUTSIZE - 1 + 256] = {
-		JEDEC_BYTE_PROGRAM,
-		(addr >> 16) & 0xff,
-		(addr >> 8) & 0xff,
-		(addr >> 0) & 0xff,
-	};
+	unsigned char cmd[JEDEC_BYTE_PROGRAM_4BA_OUTSIZE - 1 + 256];
 	struct spi_command cmds[] = {
 	{
 		.writecnt	= JEDEC_WREN_OUTSIZE,
@@ -780,7 +988,6 @@ int spi_nbyte_program(struct flashctx *flash, unsigned int addr, uint8_t *bytes,
 		.readcnt	= 0,
 		.readarr	= NULL,
 	}, {
-		.writecnt	= JEDEC_BYTE_PROGRAM_OUTSIZE - 1 + len,
 		.writearr	= cmd,
 		.readcnt	= 0,
 		.readarr	= NULL,
@@ -800,7 +1007,10 @@ int spi_nbyte_program(struct flashctx *flash, unsigned int addr, uint8_t *bytes,
 		return 1;
 	}
 
-	memcpy(&cmd[4], bytes, len);
+	cmdlen = spi_prepare_program(flash, cmd, addr, bytes, len);
+	if (cmdlen < 0)
+		return SPI_INVALID_ADDRESS;
+	cmds[1].writecnt = cmdlen;
 
 	result = spi_send_multicommand(flash, cmds);
 	if (result) {
@@ -810,24 +1020,138 @@ int spi_nbyte_program(struct flashctx *flash, unsigned int addr, uint8_t *bytes,
 	return result;
 }
 
+/* Like spi_nbyte_program(), but only queue the commands and waiting for the
+ * chip. The caller has to call spi_queue_flush().
+ */
+static int spi_queue_nbyte_program(struct flashctx *flash, unsigned int addr, uint8_t *bytes,
+				   unsigned int len)
+{
+	static const unsigned char wren[JEDEC_WREN_OUTSIZE] = { JEDEC_WREN };
+	unsigned char cmd[JEDEC_BYTE_PROGRAM_4BA_OUTSIZE - 1 + 256];
+	int cmdlen;
+
+	if (!len || len > 256) {
+		msg_cerr("%s called for a write of %u bytes\n", __func__, len);
+		return 1;
+	}
+	cmdlen = spi_prepare_program(flash, cmd, addr, bytes, len);
+	if (cmdlen < 0 ||
+	    spi_queue_reserve(flash, 3, sizeof(wren) + cmdlen) ||
+	    spi_queue_command(flash, sizeof(wren), 0, wren, NULL) ||
+	    spi_queue_command(flash, cmdlen, 0, cmd, NULL))
+		return 1;
+	spi_queue_wait_ready(flash, JEDEC_BYTE_PROGRAM, len);
+	return 0;
+}
+
+/* Pick the fastest read both the chip and the programmer support. SFDP may
+ * override opcode and dummy cycles, which have to come in whole bytes.
+ */
+static uint8_t spi_read_opcode(struct flashctx *flash, unsigned int *io,
+			       unsigned int *dummy_cycles)
+{
+	static const struct {
+		unsigned int feature;
+		unsigned int io;
+		enum sfdp_read_mode sfdp;
+		uint8_t opcode;
+	} modes[] = {
+		{ FEATURE_QUAD_OUT, SPI_IO_FAST_READ | SPI_IO_QUAD_OUT, SFDP_READ_1_1_4,
+		  JEDEC_QUAD_OUT_READ },
+		{ FEATURE_DUAL_OUT, SPI_IO_FAST_READ | SPI_IO_DUAL_OUT, SFDP_READ_1_1_2,
+		  JEDEC_DUAL_OUT_READ },
+		{ FEATURE_FAST_READ, SPI_IO_FAST_READ, SFDP_READ_MODES, JEDEC_FAST_READ },
+	};
+	const struct sfdp_params *sfdp = flash->chip->sfdp;
+	unsigned int j, cycles;
+	uint8_t opcode;
+
+	for (j = 0; j < ARRAY_SIZE(modes); j++) {
+		if (!(flash->chip->feature_bits & modes[j].feature) ||
+		    (flash->pgm->spi.io_modes & modes[j].io) != modes[j].io)
+			continue;
+		opcode = modes[j].opcode;
+		cycles = 8;
+		if (sfdp && modes[j].sfdp != SFDP_READ_MODES && sfdp->read[modes[j].sfdp].opcode) {
+			opcode = sfdp->read[modes[j].sfdp].opcode;
+			cycles = sfdp->read[modes[j].sfdp].dummy_cycles +
+				 sfdp->read[modes[j].sfdp].mode_cycles;
+		}
+		if (cycles % 8 || cycles / 8 > JEDEC_READ_MAX_OUTSIZE - JEDEC_READ_4BA_OUTSIZE)
+			continue;
+		*io = modes[j].io;
+		*dummy_cycles = cycles;
+		return opcode;
+	}
+	*io = 0;
+	*dummy_cycles = 0;
+	return JEDEC_READ;
+}
+
+/* The variant of the read @opcode with a 4-byte address, 0 if unknown. */
+static uint8_t spi_read_opcode_4ba(uint8_t opcode)
+{
+	switch (opcode) {
+	case JEDEC_READ:
+		return JEDEC_READ_4BA;
+	case JEDEC_FAST_READ:
+		return JEDEC_FAST_READ_4BA;
+	case JEDEC_DUAL_OUT_READ:
+		return JEDEC_DUAL_OUT_READ_4BA;
+	case JEDEC_QUAD_OUT_READ:
+		return JEDEC_QUAD_OUT_READ_4BA;
+	default:
+		return 0;
+	}
+}
+
 int spi_nbyte_read(struct flashctx *flash, unsigned int address, uint8_t *bytes,
 		   unsigned int len)
 {
-	const unsigned char cmd[JEDEC_READ_OUTSIZE] = {
-		JEDEC_READ,
-		(address >> 16) & 0xff,
-		(address >> 8) & 0xff,
-		(address >> 0) & 0xff,
-	};
+	static uint8_t last_opcode = JEDEC_READ;
+	unsigned char cmd[JEDEC_READ_MAX_OUTSIZE] = { 0 };
+	int native_4ba = spi_native_4ba(flash);
+	int addrlen;
+	struct spi_command cmds[] = {
+	{
+		.readcnt	= len,
+		.writearr	= cmd,
+		.readarr	= bytes,
+	}, {
+		.writecnt	= 0,
+		.writearr	= NULL,
+		.readcnt	= 0,
+		.readarr	= NULL,
+	}};
 
-	/* Send Read */
-	return spi_send_command(flash, sizeof(cmd), len, cmd, bytes);
+	cmd[0] = spi_read_opcode(flash, &cmds[0].io, &cmds[0].dummy_cycles);
+	if (native_4ba) {
+		cmd[0] = spi_read_opcode_4ba(cmd[0]);
+		if (!cmd[0]) {
+			cmd[0] = JEDEC_READ_4BA;
+			cmds[0].io = 0;
+			cmds[0].dummy_cycles = 0;
+		}
+	}
+	addrlen = spi_prepare_address(flash, cmd, native_4ba, address);
+	if (addrlen < 0)
+		return SPI_INVALID_ADDRESS;
+	cmds[0].writecnt = 1 + addrlen + cmds[0].dummy_cycles / 8;
+	if (cmd[0] != last_opcode)
+		msg_cdbg2("Reading with opcode 0x%02x and %u dummy cycles.\n",
+			  cmd[0], cmds[0].dummy_cycles);
+	last_opcode = cmd[0];
+
+	/* Single line reads work with every programmer. */
+	if (!(cmds[0].io & (SPI_IO_DUAL_OUT | SPI_IO_QUAD_OUT)))
+		return spi_send_command(flash, cmds[0].writecnt, len, cmd, bytes);
+	return spi_send_multicommand(flash, cmds);
 }
 
 /*
- * Read a part of the flash chip.
- * FIXME: Use the chunk code from Michael Karcher instead.
- * Each page is read separately in chunks with a maximum size of chunksize.
+ * Read a part of the flash chip in chunks with a maximum size of chunksize.
+ * The address space of most chips is contiguous and a read continues into the
+ * next page. Chips with FEATURE_PAGED_READ have each page read separately.
  */
 int spi_read_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start,
 		     unsigned int len, unsigned int chunksize)
@@ -836,6 +1160,16 @@ int spi_read_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start,
 	unsigned int i, j, starthere, lenhere, toread;
 	unsigned int page_size = flash->chip->page_size;
 
+	if (!(flash->chip->feature_bits & FEATURE_PAGED_READ)) {
+		for (i = 0; i < len; i += toread) {
+			toread = min(chunksize, len - i);
+			rc = spi_nbyte_read(flash, start + i, buf + i, toread);
+			if (rc)
+				break;
+		}
+		return rc;
+	}
+
 	/* Warning: This loop has a very unusual condition and body.
 	 * The loop needs to go through each page with at least one affected
 	 * byte. The lowest page number is (start / page_size) since that
@@ -874,12 +1208,7 @@ int spi_write_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start,
 {
 	int rc = 0;
 	unsigned int i, j, starthere, lenhere, towrite;
-	/* FIXME: page_size is the wrong variable. We need max_writechunk_size
-	 * in struct flashctx to do this properly. All chips using
-	 * spi_chip_write_256 have page_size set to max_writechunk_size, so
-	 * we're OK for now.
-	 */
-	unsigned int page_size = flash->chip->page_size;
+	unsigned int page_size = flash->chip->max_write_chunk;
 
 	/* Warning: This loop has a very unusual condition and body.
 	 * The loop needs to go through each page with at least one affected
@@ -898,15 +1227,19 @@ int spi_write_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start,
 		lenhere = min(start + len, (i + 1) * page_size) - starthere;
 		for (j = 0; j < lenhere; j += chunksize) {
 			towrite = min(chunksize, lenhere - j);
-			rc = spi_nbyte_program(flash, starthere + j, buf + starthere - start + j, towrite);
+			rc = spi_queue_nbyte_program(flash, starthere + j, buf + starthere - start + j,
+						     towrite);
 			if (rc)
 				break;
-			while (spi_read_status_register(flash) & SPI_SR_WIP)
-				programmer_delay(10);
 		}
 		if (rc)
 			break;
 	}
+	/* Pages are programmed in batches, a failure shows up here. */
+	if (spi_queue_flush(flash)) {
+		msg_cerr("%s failed during command execution\n", __func__);
+		rc = 1;
+	}
 
 	return rc;
 }
@@ -928,14 +1261,15 @@ int spi_chip_write_1(struct flashctx *flash, uint8_t *buf, unsigned int start,
 		result = spi_byte_program(flash, i, buf[i - start]);
 		if (result)
 			return 1;
-		while (spi_read_status_register(flash) & SPI_SR_WIP)
-			programmer_delay(10);
+		spi_poll_wip(flash, JEDEC_BYTE_PROGRAM, 1);
 	}
 
 	return 0;
 }
 
-int default_spi_write_aai(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len)
+/* AAI programming of @len bytes at @start, both have to be even. */
+static int spi_aai_write_words(struct flashctx *flash, uint8_t *buf, unsigned int start,
+			       unsigned int len)
 {
 	uint32_t pos = start;
 	int result;
@@ -967,52 +1301,6 @@ int default_spi_write_aai(struct flashctx *flash, uint8_t *buf, unsigned int sta
 		.readarr	= NULL,
 	}};
 
-	switch (flash->pgm->spi.type) {
-#if CONFIG_INTERNAL == 1
-#if defined(__i386__) || defined(__x86_64__)
-	case SPI_CONTROLLER_IT87XX:
-	case SPI_CONTROLLER_WBSIO:
-		msg_perr("%s: impossible with this SPI controller,"
-				" degrading to byte program\n", __func__);
-		return spi_chip_write_1(flash, buf, start, len);
-#endif
-#endif
-	default:
-		break;
-	}
-
-	/* The even start address and even length requirements can be either
-	 * honored outside this function, or we can call spi_byte_program
-	 * for the first and/or last byte and use AAI for the rest.
-	 * FIXME: Move this to generic code.
-	 */
-	/* The data sheet requires a start address with the low bit cleared. */
-	if (start % 2) {
-		msg_cerr("%s: start address not even! Please report a bug at "
-			 "flashrom@flashrom.org\n", __func__);
-		if (spi_chip_write_1(flash, buf, start, start % 2))
-			return SPI_GENERIC_ERROR;
-		pos += start % 2;
-		cmds[1].writearr = (const unsigned char[]){
-					JEDEC_AAI_WORD_PROGRAM,
-					(pos >> 16) & 0xff,
-					(pos >> 8) & 0xff,
-					(pos & 0xff),
-					buf[pos - start],
-					buf[pos - start + 1]
-				};
-		/* Do not return an error for now. */
-		//return SPI_GENERIC_ERROR;
-	}
-	/* The data sheet requires total AAI write length to be even. */
-	if (len % 2) {
-		msg_cerr("%s: total write length not even! Please report a "
-			 "bug at flashrom@flashrom.org\n", __func__);
-		/* Do not return an error for now. */
-		//return SPI_GENERIC_ERROR;
-	}
-
-
 	result = spi_send_multicommand(flash, cmds);
 	if (result) {
 		msg_cerr("%s failed during start command execution\n",
@@ -1022,20 +1310,17 @@ int default_spi_write_aai(struct flashctx *flash, uint8_t *buf, unsigned int sta
 		 */
 		return result;
 	}
-	while (spi_read_status_register(flash) & SPI_SR_WIP)
-		programmer_delay(10);
+	spi_poll_wip(flash, JEDEC_AAI_WORD_PROGRAM, 2);
 
 	/* We already wrote 2 bytes in the multicommand step. */
 	pos += 2;
 
-	/* Are there at least two more bytes to write? */
-	while (pos < start + len - 1) {
+	while (pos < start + len) {
 		cmd[1] = buf[pos++ - start];
 		cmd[2] = buf[pos++ - start];
 		spi_send_command(flash, JEDEC_AAI_WORD_PROGRAM_CONT_OUTSIZE, 0,
 				 cmd, NULL);
-		while (spi_read_status_register(flash) & SPI_SR_WIP)
-			programmer_delay(10);
+		spi_poll_wip(flash, JEDEC_AAI_WORD_PROGRAM, 2);
 	}
 
 	/* Use WRDI to exit AAI mode. This needs to be done before issuing any
@@ -1043,12 +1328,43 @@ int default_spi_write_aai(struct flashctx *flash, uint8_t *buf, unsigned int sta
 	 */
 	spi_write_disable(flash);
 
-	/* Write remaining byte (if any). */
-	if (pos < start + len) {
-		if (spi_chip_write_1(flash, buf + pos - start, pos, pos % 2))
+	return 0;
+}
+
+int default_spi_write_aai(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len)
+{
+	switch (flash->pgm->spi.type) {
+#if CONFIG_INTERNAL == 1
+#if defined(__i386__) || defined(__x86_64__)
+	case SPI_CONTROLLER_IT87XX:
+	case SPI_CONTROLLER_WBSIO:
+		msg_perr("%s: impossible with this SPI controller,"
+				" degrading to byte program\n", __func__);
+		return spi_chip_write_1(flash, buf, start, len);
+#endif
+#endif
+	default:
+		break;
+	}
+
+	/* The data sheet requires an even start address and an even length.
+	 * Writes with byte granularity can start and end anywhere, the odd
+	 * bytes at either end are written with byte program.
+	 */
+	if (start % 2) {
+		if (spi_chip_write_1(flash, buf, start, 1))
+			return SPI_GENERIC_ERROR;
+		start++;
+		buf++;
+		len--;
+	}
+	if (len % 2) {
+		if (spi_chip_write_1(flash, buf + len - 1, start + len - 1, 1))
 			return SPI_GENERIC_ERROR;
-		pos += pos % 2;
+		len--;
 	}
+	if (!len)
+		return 0;
 
-	return 0;
+	return spi_aai_write_words(flash, buf, start, len);
 }
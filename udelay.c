@@ -84,6 +84,17 @@ static unsigned long measure_delay(int usecs)
 	return timeusec;
 }
 
+/* Returns a timestamp in microseconds. Only the difference between two
+ * timestamps is meaningful.
+ */
+uint64_t timestamp_usecs(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 void myusec_calibrate_delay(void)
 {
 	unsigned long count = 1000;
@@ -189,6 +200,11 @@ void myusec_calibrate_delay(void)
 	get_cpu_speed();
 }
 
+uint64_t timestamp_usecs(void)
+{
+	return timer_us(0);
+}
+
 void internal_delay(int usecs)
 {
 	udelay(usecs);
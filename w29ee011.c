@@ -37,6 +37,9 @@ int probe_w29ee011(struct flashctx *flash)
 		return 0;
 	}
 
+	/* Not a sequence the probe cache knows. */
+	probe_cache_flush();
+
 	/* Issue JEDEC Product ID Entry command */
 	chip_writeb(flash, 0xAA, bios + 0x5555);
 	programmer_delay(10);